@@ -0,0 +1,954 @@
+#pragma once
+
+// Audio input analysis, produces shadertoy compatible audio texture
+// Texture is 512x2 single channel: row 0 contains spectrum, row 1 contains waveform.
+// Analysis follows WebAudio AnalyserNode used by shadertoy (fftSize 2048, Blackman window,
+//  0.8 smoothing, -100..-30 dB range), so shaders written for shadertoy look the same.
+// Samples come from WAV file (FileStream) or from capture source through lock-free ring (CaptureStream).
+// Does not touch OpenGL, frames are published through LockFree::TripleBuffer and uploaded by render thread.
+namespace AudioTexture {
+
+	const int TextureWidth  = 512;
+	const int TextureHeight = 2;
+	const int FFTSize       = 2048;
+
+	const float SmoothingTimeConstant = 0.8f;
+	const float MinDecibels           = -100.0f;
+	const float MaxDecibels           = -30.0f;
+
+	// Interval between published frames of the stream thread (ms)
+	const int UpdateInterval = 8;
+
+	// Capture format, both capture device and replay deliver samples by blocks of CaptureBlockSize frames
+	const int CaptureSampleRate = 44100;
+	const int CaptureBlockSize  = 512;
+	const int CaptureBlockCount = 4;
+
+	// Capacity of the ring between capture and analysis (in samples), about 1.5 seconds
+	const int CaptureRingSize = 65536;
+
+	// Single frame of audio texture
+	struct Frame {
+
+		// Texels of the texture, TextureWidth * TextureHeight
+		unsigned char texels[TextureWidth * TextureHeight];
+
+		// Stream position (in seconds) of the newest sample in the frame
+		double time = 0.0;
+
+		// Sample rate of the stream
+		int sampleRate = 0;
+	};
+
+	/*
+	 * Streaming WAV file reader, converts samples to mono float
+	 * Supports PCM 8 / 16 / 24 / 32 bit, IEEE float 32 / 64 bit and WAVE_FORMAT_EXTENSIBLE of them
+	 */
+	class WavReader {
+
+		std::ifstream file;
+
+		// Format
+		int format = 0;
+		int channels = 0;
+		int sampleRate = 0;
+		int bitsPerSample = 0;
+		int blockAlign = 0;
+
+		// Location of sample data
+		std::streamoff dataOffset = 0;
+		size_t dataFrames = 0;
+
+		// Current frame index
+		size_t position = 0;
+
+		// Raw frames read from file
+		std::vector<char> raw;
+
+		static unsigned readU16(const char* p) {
+			return (unsigned char) p[0] | ((unsigned char) p[1] << 8);
+		}
+
+		static unsigned readU32(const char* p) {
+			return readU16(p) | (readU16(p + 2) << 16);
+		}
+
+		// Converts single sample to float in [-1, 1]
+		float convertSample(const char* p) const {
+			if (format == 3) {
+				if (bitsPerSample == 32) {
+					float value;
+					memcpy(&value, p, sizeof(value));
+					return value;
+				}
+
+				double value;
+				memcpy(&value, p, sizeof(value));
+				return (float) value;
+			}
+
+			switch (bitsPerSample) {
+				case 8:  return ((unsigned char) p[0] - 128) / 128.0f;
+				case 16: return (int16_t) readU16(p) / 32768.0f;
+				case 24: return ((int32_t) ((uint32_t) readU16(p) << 8 | (uint32_t) (unsigned char) p[2] << 24) >> 8) / 8388608.0f;
+				case 32: return (int32_t) readU32(p) / 2147483648.0f;
+			}
+
+			return 0.0f;
+		}
+
+	public:
+
+		// Opens file and parses header
+		// Returns 0 on success, 1 else
+		BOOL open(const std::wstring& path, std::string& error) {
+			file.close();
+			file.clear();
+			file.open(path, std::ios::binary);
+
+			if (!file) {
+				error = "Failed to open file";
+				return 1;
+			}
+
+			char header[12];
+			if (!file.read(header, 12) || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) {
+				error = "File is not RIFF WAVE";
+				return 1;
+			}
+
+			BOOL formatFound = FALSE;
+			BOOL dataFound = FALSE;
+
+			// Walk chunks until both format and data are found
+			char chunk[8];
+			while (!dataFound && file.read(chunk, 8)) {
+				unsigned size = readU32(chunk + 4);
+
+				if (!memcmp(chunk, "fmt ", 4)) {
+					if (size < 16) {
+						error = "Broken fmt chunk";
+						return 1;
+					}
+
+					std::vector<char> fmt(size);
+					if (!file.read(fmt.data(), size)) {
+						error = "Broken fmt chunk";
+						return 1;
+					}
+
+					format = readU16(&fmt[0]);
+					channels = readU16(&fmt[2]);
+					sampleRate = readU32(&fmt[4]);
+					blockAlign = readU16(&fmt[12]);
+					bitsPerSample = readU16(&fmt[14]);
+
+					// WAVE_FORMAT_EXTENSIBLE stores actual format in first bytes of SubFormat GUID
+					if (format == 0xFFFE && size >= 40)
+						format = readU16(&fmt[24]);
+
+					formatFound = TRUE;
+				} else if (!memcmp(chunk, "data", 4)) {
+					dataOffset = file.tellg();
+					dataFound = TRUE;
+
+					if (formatFound && blockAlign > 0)
+						dataFrames = size / blockAlign;
+				} else
+					file.seekg(size, std::ios::cur);
+
+				// Chunks are word aligned
+				if (!dataFound && (size & 1))
+					file.seekg(1, std::ios::cur);
+			}
+
+			if (!formatFound || !dataFound) {
+				error = "Missing fmt or data chunk";
+				return 1;
+			}
+
+			BOOL supported = (format == 1 && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32))
+			              || (format == 3 && (bitsPerSample == 32 || bitsPerSample == 64));
+
+			if (!supported) {
+				error = "Unsupported sample format " + std::to_string(format) + " (" + std::to_string(bitsPerSample) + " bit)";
+				return 1;
+			}
+
+			if (channels <= 0 || sampleRate <= 0 || blockAlign < channels * bitsPerSample / 8) {
+				error = "Broken fmt chunk";
+				return 1;
+			}
+
+			if (dataFrames == 0) {
+				error = "File contains no samples";
+				return 1;
+			}
+
+			position = 0;
+			return 0;
+		}
+
+		int getSampleRate() const {
+			return sampleRate;
+		}
+
+		size_t getFrames() const {
+			return dataFrames;
+		}
+
+		size_t getPosition() const {
+			return position;
+		}
+
+		// Moves to the given frame
+		void seek(size_t frame) {
+			if (dataFrames == 0)
+				return;
+
+			position = frame % dataFrames;
+
+			file.clear();
+			file.seekg(dataOffset + (std::streamoff) position * blockAlign, std::ios::beg);
+		}
+
+		// Reads up to count frames, stops at the end of data
+		// Returns number of frames read
+		size_t read(float* out, size_t count) {
+			count = std::min(count, dataFrames - position);
+			if (count == 0)
+				return 0;
+
+			raw.resize(count * blockAlign);
+			file.read(raw.data(), raw.size());
+
+			// Truncated file
+			count = (size_t) file.gcount() / blockAlign;
+			if (count == 0) {
+				dataFrames = position;
+				return 0;
+			}
+
+			int sampleSize = bitsPerSample / 8;
+			float scale = 1.0f / channels;
+
+			for (size_t i = 0; i < count; ++i) {
+				const char* frame = raw.data() + i * blockAlign;
+
+				float value = 0.0f;
+				for (int c = 0; c < channels; ++c)
+					value += convertSample(frame + c * sampleSize);
+
+				out[i] = value * scale;
+			}
+
+			position += count;
+			return count;
+		}
+
+		// Reads exactly count frames, wraps to the beginning at the end of data
+		void readLooped(float* out, size_t count) {
+			while (count) {
+				size_t n = read(out, count);
+
+				if (n == 0) {
+					if (dataFrames == 0) {
+						std::fill(out, out + count, 0.0f);
+						return;
+					}
+
+					seek(0);
+					continue;
+				}
+
+				out += n;
+				count -= n;
+			}
+		}
+	};
+
+	/*
+	 * Computes audio texture from the last FFTSize samples
+	 * FFT is radix-2 over split real / imaginary arrays, butterflies are processed by 4 with SSE.
+	 */
+	class Analyzer {
+
+		// Blackman window
+		std::vector<float> window;
+
+		// Twiddle factors of all stages, stage with half size h uses [h, 2h)
+		std::vector<float> twiddleRe;
+		std::vector<float> twiddleIm;
+
+		// Bit reversal permutation
+		std::vector<int> reversed;
+
+		// Work arrays
+		std::vector<float> re;
+		std::vector<float> im;
+		std::vector<float> windowed;
+
+		// Smoothed magnitudes of the texture bins
+		std::vector<float> smoothed;
+
+	public:
+
+		Analyzer() : window(FFTSize), twiddleRe(FFTSize), twiddleIm(FFTSize), reversed(FFTSize), re(FFTSize), im(FFTSize), windowed(FFTSize), smoothed(TextureWidth, 0.0f) {
+			const double pi = 3.14159265358979323846;
+
+			for (int i = 0; i < FFTSize; ++i) {
+				double x = (double) i / FFTSize;
+				window[i] = (float) (0.42 - 0.5 * cos(2.0 * pi * x) + 0.08 * cos(4.0 * pi * x));
+			}
+
+			for (int h = 1; h < FFTSize; h *= 2)
+				for (int k = 0; k < h; ++k) {
+					twiddleRe[h + k] = (float) cos(-pi * k / h);
+					twiddleIm[h + k] = (float) sin(-pi * k / h);
+				}
+
+			int bits = 0;
+			while ((1 << bits) < FFTSize)
+				++bits;
+
+			for (int i = 0; i < FFTSize; ++i) {
+				int r = 0;
+				for (int b = 0; b < bits; ++b)
+					if (i & (1 << b))
+						r |= 1 << (bits - 1 - b);
+				reversed[i] = r;
+			}
+		}
+
+		// Drops smoothing state (used on seek / restart)
+		void reset() {
+			std::fill(smoothed.begin(), smoothed.end(), 0.0f);
+		}
+
+		// Computes texture texels from FFTSize samples
+		void analyze(const float* samples, unsigned char* texels) {
+
+			// Apply window
+			for (int i = 0; i < FFTSize; i += 4)
+				_mm_storeu_ps(&windowed[i], _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(&window[i])));
+
+			for (int i = 0; i < FFTSize; ++i) {
+				re[i] = windowed[reversed[i]];
+				im[i] = 0.0f;
+			}
+
+			// First two stages have less than 4 butterflies per group
+			for (int h = 1; h < 4 && h < FFTSize; h *= 2)
+				for (int j = 0; j < FFTSize; j += 2 * h)
+					for (int k = 0; k < h; ++k) {
+						float wr = twiddleRe[h + k];
+						float wi = twiddleIm[h + k];
+
+						int a = j + k;
+						int b = a + h;
+
+						float tr = re[b] * wr - im[b] * wi;
+						float ti = re[b] * wi + im[b] * wr;
+
+						re[b] = re[a] - tr;
+						im[b] = im[a] - ti;
+						re[a] += tr;
+						im[a] += ti;
+					}
+
+			for (int h = 4; h < FFTSize; h *= 2)
+				for (int j = 0; j < FFTSize; j += 2 * h)
+					for (int k = 0; k < h; k += 4) {
+						__m128 wr = _mm_loadu_ps(&twiddleRe[h + k]);
+						__m128 wi = _mm_loadu_ps(&twiddleIm[h + k]);
+
+						float* ar = &re[j + k];
+						float* ai = &im[j + k];
+						float* br = ar + h;
+						float* bi = ai + h;
+
+						__m128 xr = _mm_loadu_ps(br);
+						__m128 xi = _mm_loadu_ps(bi);
+
+						__m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+						__m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+
+						__m128 yr = _mm_loadu_ps(ar);
+						__m128 yi = _mm_loadu_ps(ai);
+
+						_mm_storeu_ps(br, _mm_sub_ps(yr, tr));
+						_mm_storeu_ps(bi, _mm_sub_ps(yi, ti));
+						_mm_storeu_ps(ar, _mm_add_ps(yr, tr));
+						_mm_storeu_ps(ai, _mm_add_ps(yi, ti));
+					}
+
+			// Magnitudes with smoothing over time
+			const __m128 scale = _mm_set1_ps(1.0f / FFTSize);
+			const __m128 keep = _mm_set1_ps(SmoothingTimeConstant);
+			const __m128 take = _mm_set1_ps(1.0f - SmoothingTimeConstant);
+
+			for (int i = 0; i < TextureWidth; i += 4) {
+				__m128 r = _mm_loadu_ps(&re[i]);
+				__m128 m = _mm_loadu_ps(&im[i]);
+				__m128 magnitude = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m))), scale);
+
+				_mm_storeu_ps(&smoothed[i], _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&smoothed[i]), keep), _mm_mul_ps(magnitude, take)));
+			}
+
+			// Row 0: spectrum in decibels
+			const float range = 255.0f / (MaxDecibels - MinDecibels);
+			for (int i = 0; i < TextureWidth; ++i) {
+				float db = smoothed[i] > 0.0f ? 20.0f * log10f(smoothed[i]) : MinDecibels;
+				texels[i] = (unsigned char) std::clamp((db - MinDecibels) * range, 0.0f, 255.0f);
+			}
+
+			// Row 1: the newest samples as waveform
+			const float* wave = samples + FFTSize - TextureWidth;
+			const __m128 half = _mm_set1_ps(128.0f);
+			const __m128 low = _mm_setzero_ps();
+			const __m128 high = _mm_set1_ps(255.0f);
+
+			for (int i = 0; i < TextureWidth; i += 4) {
+				__m128 value = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(wave + i), _mm_set1_ps(1.0f)), half), low), high);
+				__m128i packed = _mm_cvttps_epi32(value);
+
+				packed = _mm_packs_epi32(packed, packed);
+				packed = _mm_packus_epi16(packed, packed);
+
+				int bytes = _mm_cvtsi128_si32(packed);
+				memcpy(texels + TextureWidth + i, &bytes, 4);
+			}
+		}
+	};
+
+	// Shifts count (<= FFTSize) new samples into the history of the newest FFTSize samples
+	inline void appendHistory(std::vector<float>& history, const float* samples, size_t count) {
+		std::memmove(history.data(), history.data() + count, (FFTSize - count) * sizeof(float));
+		std::memcpy(history.data() + FFTSize - count, samples, count * sizeof(float));
+	}
+
+	/*
+	 * Stream of audio texture frames
+	 * Frames are produced by stream own thread, render thread only uploads the newest frame.
+	 */
+	class Stream {
+	public:
+
+		// Frames produced by stream thread
+		LockFree::TripleBuffer<Frame> frames;
+
+		virtual ~Stream() {}
+
+		virtual int getSampleRate() const = 0;
+
+		virtual void start() = 0;
+
+		virtual void stop() = 0;
+
+		// Freezes published frames
+		virtual void setPaused(bool value) = 0;
+	};
+
+	/*
+	 * Audio file stream
+	 * Own thread decodes the file in real time (looping), analyzes the newest samples and publishes
+	 *  frames with UpdateInterval.
+	 */
+	class FileStream : public Stream {
+
+		WavReader reader;
+		Analyzer analyzer;
+
+		// The newest FFTSize samples
+		std::vector<float> history;
+
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+		std::atomic<bool> paused { false };
+
+		void run() {
+			std::vector<float> incoming(FFTSize);
+
+			auto last = std::chrono::steady_clock::now();
+			double pending = 0.0;
+
+			while (running) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(UpdateInterval));
+
+				auto now = std::chrono::steady_clock::now();
+				double delta = std::chrono::duration<double>(now - last).count();
+				last = now;
+
+				if (paused)
+					continue;
+
+				pending += delta * reader.getSampleRate();
+				size_t count = (size_t) pending;
+				pending -= count;
+
+				if (count == 0)
+					continue;
+
+				// Thread was late, only the newest samples matter
+				if (count > (size_t) FFTSize) {
+					reader.seek(reader.getPosition() + count - FFTSize);
+					count = FFTSize;
+				}
+
+				reader.readLooped(incoming.data(), count);
+				appendHistory(history, incoming.data(), count);
+
+				Frame& frame = frames.writeSlot();
+				analyzer.analyze(history.data(), frame.texels);
+				frame.time = (double) reader.getPosition() / reader.getSampleRate();
+				frame.sampleRate = reader.getSampleRate();
+				frames.publish();
+			}
+		}
+
+	public:
+
+		~FileStream() {
+			stop();
+		}
+
+		// Opens the file, stream is not started
+		// Returns 0 on success, 1 else
+		BOOL open(const std::wstring& path, std::string& error) {
+			stop();
+
+			if (reader.open(path, error))
+				return 1;
+
+			history.assign(FFTSize, 0.0f);
+			analyzer.reset();
+
+			return 0;
+		}
+
+		int getSampleRate() const override {
+			return reader.getSampleRate();
+		}
+
+		void start() override {
+			if (thread)
+				return;
+
+			running = true;
+			thread = new std::thread(&FileStream::run, this);
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			running = false;
+			thread->join();
+			delete thread;
+			thread = nullptr;
+		}
+
+		// Freezes stream position
+		void setPaused(bool value) override {
+			paused = value;
+		}
+	};
+
+	typedef LockFree::SPSCRing<float> SampleRing;
+
+	/*
+	 * Source of captured samples (mono float)
+	 * Source writes samples into ring from it's own thread and never waits for consumer,
+	 *  samples that do not fit into ring are dropped.
+	 */
+	class CaptureSource {
+	protected:
+
+		SampleRing* ring = nullptr;
+
+		std::atomic<unsigned> dropped { 0 };
+
+		void deliver(const float* samples, size_t count) {
+			size_t written = ring->write(samples, count);
+			if (written < count)
+				dropped += (unsigned) (count - written);
+		}
+
+	public:
+
+		virtual ~CaptureSource() {}
+
+		// Opens the source, samples are written into ring once started
+		// Returns 0 on success, 1 else
+		virtual BOOL open(SampleRing* target, std::string& error) = 0;
+
+		virtual int getSampleRate() const = 0;
+
+		virtual void start() = 0;
+
+		virtual void stop() = 0;
+
+		// Amount of samples dropped because consumer was behind
+		unsigned getDropped() const {
+			return dropped;
+		}
+	};
+
+	/*
+	 * Default capture device (microphone) through waveIn
+	 * Device fills CaptureBlockCount buffers in turn, capture thread wakes up on each filled buffer,
+	 *  converts it and gives it back to device.
+	 */
+	class WaveInSource : public CaptureSource {
+
+		HWAVEIN device = NULL;
+		HANDLE event = NULL;
+
+		WAVEHDR headers[CaptureBlockCount] = {};
+		std::vector<short> memory;
+
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+
+		void run() {
+			std::vector<float> block(CaptureBlockSize);
+
+			// Buffers are filled in order they were queued
+			int next = 0;
+
+			while (running) {
+				WaitForSingleObject(event, 100);
+
+				while (running && (headers[next].dwFlags & WHDR_DONE)) {
+					WAVEHDR& header = headers[next];
+
+					size_t count = header.dwBytesRecorded / sizeof(short);
+					const short* pcm = (const short*) header.lpData;
+
+					for (size_t i = 0; i < count; ++i)
+						block[i] = pcm[i] * (1.0f / 32768.0f);
+
+					deliver(block.data(), count);
+
+					waveInAddBuffer(device, &header, sizeof(WAVEHDR));
+					next = (next + 1) % CaptureBlockCount;
+				}
+			}
+		}
+
+		void close() {
+			if (!device)
+				return;
+
+			waveInReset(device);
+
+			for (auto& header : headers)
+				waveInUnprepareHeader(device, &header, sizeof(WAVEHDR));
+
+			waveInClose(device);
+			device = NULL;
+
+			CloseHandle(event);
+			event = NULL;
+		}
+
+	public:
+
+		~WaveInSource() {
+			stop();
+			close();
+		}
+
+		BOOL open(SampleRing* target, std::string& error) override {
+			stop();
+			close();
+
+			ring = target;
+
+			WAVEFORMATEX format = {};
+			format.wFormatTag = WAVE_FORMAT_PCM;
+			format.nChannels = 1;
+			format.nSamplesPerSec = CaptureSampleRate;
+			format.wBitsPerSample = 16;
+			format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+			format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+			event = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+			if (waveInOpen(&device, WAVE_MAPPER, &format, (DWORD_PTR) event, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+				CloseHandle(event);
+				event = NULL;
+				device = NULL;
+
+				error = "No audio capture device available";
+				return 1;
+			}
+
+			memory.assign(CaptureBlockSize * CaptureBlockCount, 0);
+
+			for (int i = 0; i < CaptureBlockCount; ++i) {
+				headers[i] = {};
+				headers[i].lpData = (char*) &memory[CaptureBlockSize * i];
+				headers[i].dwBufferLength = CaptureBlockSize * sizeof(short);
+				waveInPrepareHeader(device, &headers[i], sizeof(WAVEHDR));
+			}
+
+			return 0;
+		}
+
+		int getSampleRate() const override {
+			return CaptureSampleRate;
+		}
+
+		void start() override {
+			if (thread || !device)
+				return;
+
+			for (auto& header : headers)
+				waveInAddBuffer(device, &header, sizeof(WAVEHDR));
+
+			running = true;
+			thread = new std::thread(&WaveInSource::run, this);
+
+			waveInStart(device);
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			running = false;
+			SetEvent(event);
+
+			thread->join();
+			delete thread;
+			thread = nullptr;
+
+			// Takes all buffers back from device
+			waveInReset(device);
+		}
+	};
+
+	/*
+	 * Replays WAV file as capture device, in loop
+	 * Delivers blocks of the same size with the same cadence as capture device, so whole capture path
+	 *  can be run and measured on machine without sound hardware.
+	 */
+	class ReplaySource : public CaptureSource {
+
+		WavReader reader;
+		std::wstring path;
+
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+
+		void run() {
+			std::vector<float> block(CaptureBlockSize);
+
+			auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((double) CaptureBlockSize / reader.getSampleRate()));
+			auto due = std::chrono::steady_clock::now();
+
+			while (running) {
+
+				// Block is ready when it's last sample is recorded, late blocks are delivered in burst as device does
+				due += period;
+				std::this_thread::sleep_until(due);
+
+				reader.readLooped(block.data(), block.size());
+				deliver(block.data(), block.size());
+			}
+		}
+
+	public:
+
+		ReplaySource(const std::wstring& path) : path(path) {}
+
+		~ReplaySource() {
+			stop();
+		}
+
+		BOOL open(SampleRing* target, std::string& error) override {
+			stop();
+
+			ring = target;
+
+			return reader.open(path, error);
+		}
+
+		int getSampleRate() const override {
+			return reader.getSampleRate();
+		}
+
+		void start() override {
+			if (thread)
+				return;
+
+			running = true;
+			thread = new std::thread(&ReplaySource::run, this);
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			running = false;
+			thread->join();
+			delete thread;
+			thread = nullptr;
+		}
+	};
+
+	/*
+	 * Captured audio stream
+	 * Source writes samples into lock-free ring, own thread drains it with UpdateInterval, analyzes the newest samples
+	 *  and publishes frames. Ring is drained even when paused, so capture never finds it full because of render.
+	 */
+	class CaptureStream : public Stream {
+
+		CaptureSource* source;
+		SampleRing ring { CaptureRingSize };
+
+		Analyzer analyzer;
+
+		// The newest FFTSize samples
+		std::vector<float> history;
+
+		// Amount of samples consumed since start
+		unsigned long long position = 0;
+
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+		std::atomic<bool> paused { false };
+
+		void run() {
+			std::vector<float> incoming(CaptureRingSize);
+
+			while (running) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(UpdateInterval));
+
+				size_t count = ring.read(incoming.data(), incoming.size());
+				position += count;
+
+				if (count == 0 || paused)
+					continue;
+
+				// Only the newest samples matter
+				const float* newest = incoming.data();
+				if (count > (size_t) FFTSize) {
+					newest += count - FFTSize;
+					count = FFTSize;
+				}
+
+				appendHistory(history, newest, count);
+
+				Frame& frame = frames.writeSlot();
+				analyzer.analyze(history.data(), frame.texels);
+				frame.time = (double) position / source->getSampleRate();
+				frame.sampleRate = source->getSampleRate();
+				frames.publish();
+			}
+		}
+
+	public:
+
+		// Takes ownership of source
+		CaptureStream(CaptureSource* source) : source(source) {}
+
+		~CaptureStream() {
+			stop();
+			delete source;
+		}
+
+		// Opens the source, stream is not started
+		// Returns 0 on success, 1 else
+		BOOL open(std::string& error) {
+			stop();
+
+			if (source->open(&ring, error))
+				return 1;
+
+			// Drop samples of the previous run
+			std::vector<float> stale(CaptureRingSize);
+			ring.read(stale.data(), stale.size());
+
+			history.assign(FFTSize, 0.0f);
+			analyzer.reset();
+			position = 0;
+
+			return 0;
+		}
+
+		int getSampleRate() const override {
+			return source->getSampleRate();
+		}
+
+		unsigned getDropped() const {
+			return source->getDropped();
+		}
+
+		void start() override {
+			if (thread)
+				return;
+
+			running = true;
+			thread = new std::thread(&CaptureStream::run, this);
+
+			source->start();
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			source->stop();
+
+			running = false;
+			thread->join();
+			delete thread;
+			thread = nullptr;
+		}
+
+		// Freezes published frames, capture keeps running
+		void setPaused(bool value) override {
+			paused = value;
+		}
+	};
+
+	// Analyzes whole file as if it was played with given fps and writes frames one after another
+	//  into image (TextureWidth x 2 * frames, single channel), used to check analysis without render context
+	// Returns 0 on success, 1 else
+	inline BOOL analyzeFile(const std::wstring& path, int fps, std::vector<unsigned char>& image, unsigned& height, std::string& error) {
+		WavReader reader;
+		if (reader.open(path, error))
+			return 1;
+
+		Analyzer analyzer;
+		std::vector<float> history(FFTSize, 0.0f);
+		std::vector<float> incoming(FFTSize);
+
+		size_t frames = (size_t) ((double) reader.getFrames() * fps / reader.getSampleRate());
+		image.assign(frames * TextureWidth * TextureHeight, 0);
+		height = (unsigned) (frames * TextureHeight);
+
+		double pending = 0.0;
+		for (size_t f = 0; f < frames; ++f) {
+			pending += (double) reader.getSampleRate() / fps;
+			size_t count = (size_t) pending;
+			pending -= count;
+
+			if (count > (size_t) FFTSize) {
+				reader.seek(reader.getPosition() + count - FFTSize);
+				count = FFTSize;
+			}
+
+			if (count > 0) {
+				count = reader.read(incoming.data(), count);
+				appendHistory(history, incoming.data(), count);
+			}
+
+			analyzer.analyze(history.data(), &image[f * TextureWidth * TextureHeight]);
+		}
+
+		return 0;
+	}
+}
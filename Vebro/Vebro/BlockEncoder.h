@@ -0,0 +1,477 @@
+#pragma once
+
+// Block compression of decoded RGB and RGBA images (BC1 and BC7), used to fill texture cache
+// Endpoints are fitted along principal axis of block texels, indices are picked by projection on the endpoint
+//  line and endpoints are refined once with least squares. BC7 uses only mode 6 (single subset RGBA with 16
+//  levels), it is far from the best BC7 encoder, but holds photos and gradients well and is fast enough to run
+//  in background. BC1 is only used for opaque images.
+// Image is encoded by block rows, so rows can be spread between threads.
+// Does not touch OpenGL.
+namespace BlockEncoder {
+
+	// BC7 interpolation weights of 4 bit indices (out of 64)
+	static const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// BC1 index of each point on the line from color0 to color1
+	static const int BC1Order[4] = { 0, 2, 3, 1 };
+
+	// Returns true if all pixels are opaque, pixels are RGB or RGBA
+	inline bool isOpaque(const unsigned char* pixels, size_t count, int channels) {
+		if (channels == 3)
+			return true;
+
+		for (size_t i = 0; i < count; ++i)
+			if (pixels[i * 4 + 3] != 255)
+				return false;
+
+		return true;
+	}
+
+	// Texels of block, edges of the image are repeated for partial blocks
+	inline void fetchBlock(const unsigned char* pixels, int width, int height, int channels, int bx, int by, float block[16][4]) {
+		for (int y = 0; y < 4; ++y) {
+			const unsigned char* row = pixels + (size_t) std::min(by * 4 + y, height - 1) * width * channels;
+
+			for (int x = 0; x < 4; ++x) {
+				const unsigned char* texel = row + (size_t) std::min(bx * 4 + x, width - 1) * channels;
+
+				for (int c = 0; c < 4; ++c)
+					block[y * 4 + x][c] = c < channels ? texel[c] : 255.0f;
+			}
+		}
+	}
+
+	// Finds line through block texels with the largest spread
+	// Returns false if all texels are equal, mean is valid anyway
+	inline bool fitLine(const float block[16][4], int channels, float mean[4], float axis[4]) {
+		float covariance[4][4] = {};
+
+		for (int c = 0; c < 4; ++c) {
+			mean[c] = 0.0f;
+			for (int i = 0; i < 16; ++i)
+				mean[c] += block[i][c];
+			mean[c] /= 16.0f;
+		}
+
+		for (int i = 0; i < 16; ++i)
+			for (int a = 0; a < channels; ++a)
+				for (int b = 0; b < channels; ++b)
+					covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+
+		// Start from the channel with the widest spread
+		int widest = 0;
+		for (int c = 1; c < channels; ++c)
+			if (covariance[c][c] > covariance[widest][widest])
+				widest = c;
+
+		if (covariance[widest][widest] < 1e-3f)
+			return false;
+
+		for (int c = 0; c < 4; ++c)
+			axis[c] = c < channels ? covariance[widest][c] : 0.0f;
+
+		// Power iteration, converges fast for 4x4 matrix
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float next[4] = {};
+			float largest = 0.0f;
+
+			for (int a = 0; a < channels; ++a) {
+				for (int b = 0; b < channels; ++b)
+					next[a] += covariance[a][b] * axis[b];
+
+				largest = std::max(largest, std::fabs(next[a]));
+			}
+
+			if (largest < 1e-6f)
+				return false;
+
+			for (int c = 0; c < channels; ++c)
+				axis[c] = next[c] / largest;
+		}
+
+		float length = 0.0f;
+		for (int c = 0; c < channels; ++c)
+			length += axis[c] * axis[c];
+
+		length = std::sqrt(length);
+		for (int c = 0; c < channels; ++c)
+			axis[c] /= length;
+
+		return true;
+	}
+
+	// Endpoints at the extreme projections of texels on the line
+	inline void getEndpoints(const float block[16][4], int channels, const float mean[4], const float axis[4], float start[4], float end[4]) {
+		float low = 0.0f;
+		float high = 0.0f;
+
+		for (int i = 0; i < 16; ++i) {
+			float t = 0.0f;
+			for (int c = 0; c < channels; ++c)
+				t += (block[i][c] - mean[c]) * axis[c];
+
+			low = std::min(low, t);
+			high = std::max(high, t);
+		}
+
+		for (int c = 0; c < 4; ++c) {
+			start[c] = std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+			end[c] = std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+		}
+	}
+
+	// Least squares endpoints for given texel positions on the line (0 - start, 1 - end)
+	// Returns false if positions do not define the line
+	inline bool refineEndpoints(const float block[16][4], const float weights[16], float start[4], float end[4]) {
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float sa[4] = {}, sb[4] = {};
+
+		for (int i = 0; i < 16; ++i) {
+			float b = weights[i];
+			float a = 1.0f - b;
+
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+
+			for (int c = 0; c < 4; ++c) {
+				sa[c] += a * block[i][c];
+				sb[c] += b * block[i][c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f)
+			return false;
+
+		for (int c = 0; c < 4; ++c) {
+			start[c] = std::clamp((bb * sa[c] - ab * sb[c]) / determinant, 0.0f, 255.0f);
+			end[c] = std::clamp((aa * sb[c] - ab * sa[c]) / determinant, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	// Position of texel projected on the line between decoded endpoints, in [0, 1]
+	inline float project(const float texel[4], const int start[4], const int end[4], int channels) {
+		float dot = 0.0f;
+		float length = 0.0f;
+
+		for (int c = 0; c < channels; ++c) {
+			float d = (float) (end[c] - start[c]);
+			dot += (texel[c] - start[c]) * d;
+			length += d * d;
+		}
+
+		return length > 0.0f ? std::clamp(dot / length, 0.0f, 1.0f) : 0.0f;
+	}
+
+	// Bits of block, written from the lowest
+	struct BitWriter {
+		unsigned char* out;
+		int position = 0;
+
+		void put(unsigned value, int count) {
+			for (int i = 0; i < count; ++i, ++position)
+				if (value & (1u << i))
+					out[position >> 3] |= 1 << (position & 7);
+		}
+	};
+
+	/*
+	 * BC1
+	 */
+
+	inline unsigned packRGB565(const float color[4]) {
+		unsigned r = (unsigned) std::lround(color[0] * 31.0f / 255.0f);
+		unsigned g = (unsigned) std::lround(color[1] * 63.0f / 255.0f);
+		unsigned b = (unsigned) std::lround(color[2] * 31.0f / 255.0f);
+
+		return (r << 11) | (g << 5) | b;
+	}
+
+	inline void unpackRGB565(unsigned packed, int color[4]) {
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+		color[3] = 255;
+	}
+
+	// Picks indices for packed endpoints, returns squared error, positions are line positions of picked points
+	inline float indexBC1(const float block[16][4], unsigned color0, unsigned color1, int indices[16], float positions[16]) {
+		int start[4], end[4];
+		unpackRGB565(color0, start);
+		unpackRGB565(color1, end);
+
+		int palette[4][3];
+		for (int c = 0; c < 3; ++c) {
+			palette[0][c] = start[c];
+			palette[1][c] = end[c];
+			palette[2][c] = (2 * start[c] + end[c]) / 3;
+			palette[3][c] = (start[c] + 2 * end[c]) / 3;
+		}
+
+		float error = 0.0f;
+
+		for (int i = 0; i < 16; ++i) {
+			int step = (int) std::lround(project(block[i], start, end, 3) * 3.0f);
+
+			indices[i] = BC1Order[step];
+			positions[i] = step / 3.0f;
+
+			for (int c = 0; c < 3; ++c) {
+				float d = block[i][c] - palette[indices[i]][c];
+				error += d * d;
+			}
+		}
+
+		return error;
+	}
+
+	inline void writeBC1(unsigned color0, unsigned color1, const int indices[16], unsigned char* out) {
+		int remap = 0;
+
+		// color0 > color1 selects 4 color mode
+		if (color0 < color1) {
+			std::swap(color0, color1);
+			remap = 1;
+		}
+
+		unsigned bits = 0;
+		if (color0 != color1)
+			for (int i = 0; i < 16; ++i)
+				bits |= (unsigned) (indices[i] ^ remap) << (i * 2);
+
+		out[0] = color0 & 255;
+		out[1] = color0 >> 8;
+		out[2] = color1 & 255;
+		out[3] = color1 >> 8;
+		out[4] = bits & 255;
+		out[5] = (bits >> 8) & 255;
+		out[6] = (bits >> 16) & 255;
+		out[7] = bits >> 24;
+	}
+
+	// Encodes opaque block into 8 bytes
+	inline void encodeBC1(const float block[16][4], unsigned char* out) {
+		float mean[4], axis[4], start[4], end[4];
+		int indices[16];
+		float positions[16];
+
+		if (!fitLine(block, 3, mean, axis)) {
+			unsigned color = packRGB565(mean);
+			memset(indices, 0, sizeof(indices));
+			writeBC1(color, color, indices, out);
+			return;
+		}
+
+		getEndpoints(block, 3, mean, axis, start, end);
+
+		unsigned color0 = packRGB565(start);
+		unsigned color1 = packRGB565(end);
+		float error = indexBC1(block, color0, color1, indices, positions);
+
+		if (refineEndpoints(block, positions, start, end)) {
+			int refinedIndices[16];
+			unsigned refined0 = packRGB565(start);
+			unsigned refined1 = packRGB565(end);
+
+			if (indexBC1(block, refined0, refined1, refinedIndices, positions) < error) {
+				color0 = refined0;
+				color1 = refined1;
+				memcpy(indices, refinedIndices, sizeof(indices));
+			}
+		}
+
+		writeBC1(color0, color1, indices, out);
+	}
+
+	/*
+	 * BC7 mode 6
+	 */
+
+	// 7 bit endpoint with shared lowest bit
+	struct BC7Endpoint {
+		int values[4];
+		int pbit;
+	};
+
+	// Quantizes endpoint with the better lowest bit, bit can be forced to keep alpha exact
+	inline BC7Endpoint quantizeBC7(const float color[4], int forcedBit) {
+		BC7Endpoint best = {};
+		float bestError = -1.0f;
+
+		for (int pbit = 0; pbit < 2; ++pbit) {
+			if (forcedBit >= 0 && pbit != forcedBit)
+				continue;
+
+			BC7Endpoint candidate;
+			candidate.pbit = pbit;
+			float error = 0.0f;
+
+			for (int c = 0; c < 4; ++c) {
+				candidate.values[c] = std::clamp((int) std::lround((color[c] - pbit) / 2.0f), 0, 127);
+
+				float d = color[c] - ((candidate.values[c] << 1) | pbit);
+				error += d * d;
+			}
+
+			if (bestError < 0.0f || error < bestError) {
+				best = candidate;
+				bestError = error;
+			}
+		}
+
+		return best;
+	}
+
+	// Picks indices for quantized endpoints, returns squared error, positions are line positions of picked points
+	inline float indexBC7(const float block[16][4], const BC7Endpoint& endpoint0, const BC7Endpoint& endpoint1, int indices[16], float positions[16]) {
+		int start[4], end[4];
+		for (int c = 0; c < 4; ++c) {
+			start[c] = (endpoint0.values[c] << 1) | endpoint0.pbit;
+			end[c] = (endpoint1.values[c] << 1) | endpoint1.pbit;
+		}
+
+		float error = 0.0f;
+
+		for (int i = 0; i < 16; ++i) {
+			int guess = (int) std::lround(project(block[i], start, end, 4) * 15.0f);
+
+			// Weights are not uniform, check neighbours of the guess
+			float bestError = -1.0f;
+			for (int index = std::max(guess - 1, 0); index <= std::min(guess + 1, 15); ++index) {
+				int weight = BC7Weights[index];
+				float texelError = 0.0f;
+
+				for (int c = 0; c < 4; ++c) {
+					float d = block[i][c] - (((64 - weight) * start[c] + weight * end[c] + 32) >> 6);
+					texelError += d * d;
+				}
+
+				if (bestError < 0.0f || texelError < bestError) {
+					bestError = texelError;
+					indices[i] = index;
+				}
+			}
+
+			positions[i] = BC7Weights[indices[i]] / 64.0f;
+			error += bestError;
+		}
+
+		return error;
+	}
+
+	inline void writeBC7(BC7Endpoint endpoint0, BC7Endpoint endpoint1, int indices[16], unsigned char* out) {
+
+		// Highest bit of the first index is implied zero
+		if (indices[0] & 8) {
+			std::swap(endpoint0, endpoint1);
+			for (int i = 0; i < 16; ++i)
+				indices[i] = 15 - indices[i];
+		}
+
+		memset(out, 0, 16);
+		BitWriter writer { out };
+
+		writer.put(1 << 6, 7);
+
+		for (int c = 0; c < 4; ++c) {
+			writer.put(endpoint0.values[c], 7);
+			writer.put(endpoint1.values[c], 7);
+		}
+
+		writer.put(endpoint0.pbit, 1);
+		writer.put(endpoint1.pbit, 1);
+
+		writer.put(indices[0], 3);
+		for (int i = 1; i < 16; ++i)
+			writer.put(indices[i], 4);
+	}
+
+	// Encodes block into 16 bytes
+	inline void encodeBC7(const float block[16][4], unsigned char* out) {
+		float mean[4], axis[4], start[4], end[4];
+		int indices[16];
+		float positions[16];
+
+		// Keep fully opaque and fully transparent blocks exact in alpha
+		bool opaque = true;
+		bool transparent = true;
+		for (int i = 0; i < 16; ++i) {
+			opaque = opaque && block[i][3] == 255.0f;
+			transparent = transparent && block[i][3] == 0.0f;
+		}
+
+		int forcedBit = opaque ? 1 : transparent ? 0 : -1;
+
+		if (!fitLine(block, 4, mean, axis)) {
+			BC7Endpoint endpoint = quantizeBC7(mean, forcedBit);
+			memset(indices, 0, sizeof(indices));
+			writeBC7(endpoint, endpoint, indices, out);
+			return;
+		}
+
+		getEndpoints(block, 4, mean, axis, start, end);
+
+		BC7Endpoint endpoint0 = quantizeBC7(start, forcedBit);
+		BC7Endpoint endpoint1 = quantizeBC7(end, forcedBit);
+		float error = indexBC7(block, endpoint0, endpoint1, indices, positions);
+
+		if (refineEndpoints(block, positions, start, end)) {
+			int refinedIndices[16];
+			BC7Endpoint refined0 = quantizeBC7(start, forcedBit);
+			BC7Endpoint refined1 = quantizeBC7(end, forcedBit);
+
+			if (indexBC7(block, refined0, refined1, refinedIndices, positions) < error) {
+				endpoint0 = refined0;
+				endpoint1 = refined1;
+				memcpy(indices, refinedIndices, sizeof(indices));
+			}
+		}
+
+		writeBC7(endpoint0, endpoint1, indices, out);
+	}
+
+	// Halves image with box filter for the next mip level, the last row or column of odd size is dropped
+	inline std::vector<unsigned char> downsample(const std::vector<unsigned char>& pixels, int width, int height, int channels) {
+		int halfWidth = std::max(width / 2, 1);
+		int halfHeight = std::max(height / 2, 1);
+		std::vector<unsigned char> half((size_t) halfWidth * halfHeight * channels);
+
+		for (int y = 0; y < halfHeight; ++y) {
+			const unsigned char* row0 = &pixels[(size_t) std::min(y * 2, height - 1) * width * channels];
+			const unsigned char* row1 = &pixels[(size_t) std::min(y * 2 + 1, height - 1) * width * channels];
+
+			for (int x = 0; x < halfWidth; ++x) {
+				size_t x0 = (size_t) std::min(x * 2, width - 1) * channels;
+				size_t x1 = (size_t) std::min(x * 2 + 1, width - 1) * channels;
+
+				for (int c = 0; c < channels; ++c)
+					half[((size_t) y * halfWidth + x) * channels + c] = (unsigned char) ((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+		}
+
+		return half;
+	}
+
+	// Encodes row of blocks starting at pixel row by * 4, pixels are RGB or RGBA
+	// Output receives getLevelSize(format, width, 4) bytes, format must be BC1_RGBA or BC7
+	inline void encodeRow(CompressedTexture::BlockFormat format, const unsigned char* pixels, int width, int height, int channels, int by, unsigned char* out) {
+		float block[16][4];
+		size_t blockSize = CompressedTexture::getBlockSize(format);
+
+		for (int bx = 0; bx < (width + 3) / 4; ++bx) {
+			fetchBlock(pixels, width, height, channels, bx, by, block);
+
+			if (format == CompressedTexture::BC7)
+				encodeBC7(block, out + bx * blockSize);
+			else
+				encodeBC1(block, out + bx * blockSize);
+		}
+	}
+}
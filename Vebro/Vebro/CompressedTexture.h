@@ -0,0 +1,414 @@
+#pragma once
+
+// Pre-compressed image input (DDS and KTX2 containers with BC1-BC5, BC7 or ETC2 / EAC blocks)
+// File is memory mapped and only headers are parsed, levels point right into mapping and are uploaded by
+//  render thread as stored, there is no CPU decode or transcoding. Supercompressed KTX2 (BasisLZ, zstd) is rejected.
+// Blocks are uploaded as stored, so files should be exported with lower left origin to match PNG inputs.
+// Does not touch OpenGL.
+namespace CompressedTexture {
+
+	enum BlockFormat {
+		UNKNOWN_BLOCKS,
+		BC1_RGB,
+		BC1_RGBA,
+		BC2,
+		BC3,
+		BC4,
+		BC4_SIGNED,
+		BC5,
+		BC5_SIGNED,
+		BC7,
+		ETC2_RGB,
+		ETC2_RGB_A1,
+		ETC2_RGBA,
+		EAC_R,
+		EAC_RG
+	};
+
+	// Size of 4x4 block (in bytes)
+	inline size_t getBlockSize(BlockFormat format) {
+		switch (format) {
+			case BC1_RGB:
+			case BC1_RGBA:
+			case BC4:
+			case BC4_SIGNED:
+			case ETC2_RGB:
+			case ETC2_RGB_A1:
+			case EAC_R:
+				return 8;
+
+			default:
+				return 16;
+		}
+	}
+
+	// Size of mip level (in bytes)
+	inline size_t getLevelSize(BlockFormat format, int width, int height) {
+		return (size_t) ((std::max(width, 1) + 3) / 4) * ((std::max(height, 1) + 3) / 4) * getBlockSize(format);
+	}
+
+	/*
+	 * Read-only file mapping
+	 */
+	class MappedFile {
+
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+		const unsigned char* view = nullptr;
+		size_t length = 0;
+
+	public:
+
+		MappedFile() {}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile() {
+			close();
+		}
+
+		// Returns 0 on success, 1 else
+		BOOL open(const std::wstring& path) {
+			close();
+
+			file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+				return 1;
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+				close();
+				return 1;
+			}
+
+			mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (!mapping) {
+				close();
+				return 1;
+			}
+
+			view = (const unsigned char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (!view) {
+				close();
+				return 1;
+			}
+
+			length = (size_t) fileSize.QuadPart;
+			return 0;
+		}
+
+		void close() {
+			if (view)
+				UnmapViewOfFile(view);
+			if (mapping)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+
+			view = nullptr;
+			mapping = NULL;
+			file = INVALID_HANDLE_VALUE;
+			length = 0;
+		}
+
+		const unsigned char* data() const {
+			return view;
+		}
+
+		size_t size() const {
+			return length;
+		}
+	};
+
+	// Mip level, data points into mapped file
+	struct Level {
+		int width = 0;
+		int height = 0;
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Parsed texture, levels are valid while file stays mapped
+	struct Texture {
+		MappedFile file;
+		BlockFormat format = UNKNOWN_BLOCKS;
+		int width = 0;
+		int height = 0;
+
+		// Levels from the largest one
+		std::vector<Level> levels;
+
+		// Set when KTX2 file says rows are stored from the top
+		bool topDown = false;
+
+		// Unmaps file once levels are uploaded
+		void release() {
+			levels.clear();
+			file.close();
+		}
+	};
+
+	inline unsigned readLE32(const unsigned char* p) {
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned) p[3] << 24);
+	}
+
+	inline unsigned long long readLE64(const unsigned char* p) {
+		return readLE32(p) | ((unsigned long long) readLE32(p + 4) << 32);
+	}
+
+	inline bool isDDS(const unsigned char* data, size_t size) {
+		return size >= 4 && !memcmp(data, "DDS ", 4);
+	}
+
+	inline bool isKTX2(const unsigned char* data, size_t size) {
+		static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+		return size >= 12 && !memcmp(data, identifier, 12);
+	}
+
+	// Format of DDS DX10 header
+	inline BlockFormat fromDXGI(unsigned format) {
+		switch (format) {
+			case 71: case 72: return BC1_RGBA;
+			case 74: case 75: return BC2;
+			case 77: case 78: return BC3;
+			case 80: return BC4;
+			case 81: return BC4_SIGNED;
+			case 83: return BC5;
+			case 84: return BC5_SIGNED;
+			case 98: case 99: return BC7;
+			default: return UNKNOWN_BLOCKS;
+		}
+	}
+
+	// Format of KTX2 header, sRGB variants are treated as linear (shaders see stored values, as with PNG)
+	inline BlockFormat fromVulkan(unsigned format) {
+		switch (format) {
+			case 131: case 132: return BC1_RGB;
+			case 133: case 134: return BC1_RGBA;
+			case 135: case 136: return BC2;
+			case 137: case 138: return BC3;
+			case 139: return BC4;
+			case 140: return BC4_SIGNED;
+			case 141: return BC5;
+			case 142: return BC5_SIGNED;
+			case 145: case 146: return BC7;
+			case 147: case 148: return ETC2_RGB;
+			case 149: case 150: return ETC2_RGB_A1;
+			case 151: case 152: return ETC2_RGBA;
+			case 153: return EAC_R;
+			case 155: return EAC_RG;
+			default: return UNKNOWN_BLOCKS;
+		}
+	}
+
+	// Fills levels of texture from chain stored one after another starting at offset
+	// Returns empty string on success, error description else
+	inline std::string addChain(Texture& texture, size_t offset, int count) {
+		const unsigned char* data = texture.file.data();
+		size_t size = texture.file.size();
+
+		int width = texture.width;
+		int height = texture.height;
+
+		for (int i = 0; i < count; ++i) {
+			Level level;
+			level.width = width;
+			level.height = height;
+			level.size = getLevelSize(texture.format, width, height);
+			level.data = data + offset;
+
+			if (offset + level.size > size) {
+
+				// Truncated chain, keep complete levels
+				if (i > 0)
+					break;
+
+				return "Compressed texture is truncated";
+			}
+
+			texture.levels.push_back(level);
+			offset += level.size;
+
+			if (width == 1 && height == 1)
+				break;
+
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+
+		return "";
+	}
+
+	inline std::string parseDDS(Texture& texture) {
+		const unsigned char* data = texture.file.data();
+		size_t size = texture.file.size();
+
+		if (size < 128 || readLE32(data + 4) != 124)
+			return "Invalid DDS header";
+
+		const unsigned DDSD_MIPMAPCOUNT = 0x20000;
+		const unsigned DDPF_FOURCC = 0x4;
+		const unsigned DDSCAPS2_CUBEMAP = 0x200;
+		const unsigned DDSCAPS2_VOLUME = 0x200000;
+
+		unsigned flags = readLE32(data + 8);
+		texture.height = (int) readLE32(data + 12);
+		texture.width = (int) readLE32(data + 16);
+		int mips = (flags & DDSD_MIPMAPCOUNT) ? (int) readLE32(data + 28) : 1;
+
+		const unsigned char* pixelFormat = data + 76;
+		unsigned caps2 = readLE32(data + 112);
+
+		if (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
+			return "Only 2D DDS textures are supported";
+
+		if (!(readLE32(pixelFormat + 4) & DDPF_FOURCC))
+			return "Uncompressed DDS is not supported";
+
+		size_t offset = 128;
+		const unsigned char* fourCC = pixelFormat + 8;
+
+		if (!memcmp(fourCC, "DXT1", 4))
+			texture.format = BC1_RGBA;
+		else if (!memcmp(fourCC, "DXT2", 4) || !memcmp(fourCC, "DXT3", 4))
+			texture.format = BC2;
+		else if (!memcmp(fourCC, "DXT4", 4) || !memcmp(fourCC, "DXT5", 4))
+			texture.format = BC3;
+		else if (!memcmp(fourCC, "ATI1", 4) || !memcmp(fourCC, "BC4U", 4))
+			texture.format = BC4;
+		else if (!memcmp(fourCC, "BC4S", 4))
+			texture.format = BC4_SIGNED;
+		else if (!memcmp(fourCC, "ATI2", 4) || !memcmp(fourCC, "BC5U", 4))
+			texture.format = BC5;
+		else if (!memcmp(fourCC, "BC5S", 4))
+			texture.format = BC5_SIGNED;
+		else if (!memcmp(fourCC, "DX10", 4)) {
+			if (size < 148)
+				return "Invalid DDS header";
+
+			const unsigned char* extended = data + 128;
+			offset = 148;
+
+			// Texture2D, single element
+			if (readLE32(extended + 4) != 3 || readLE32(extended + 12) > 1 || (readLE32(extended + 8) & 0x4))
+				return "Only 2D DDS textures are supported";
+
+			texture.format = fromDXGI(readLE32(extended));
+		}
+
+		if (texture.format == UNKNOWN_BLOCKS)
+			return "DDS block format is not supported";
+
+		if (texture.width <= 0 || texture.height <= 0)
+			return "Image has no pixels";
+
+		return addChain(texture, offset, std::max(mips, 1));
+	}
+
+	inline std::string parseKTX2(Texture& texture) {
+		const unsigned char* data = texture.file.data();
+		size_t size = texture.file.size();
+
+		if (size < 80)
+			return "Invalid KTX2 header";
+
+		texture.format = fromVulkan(readLE32(data + 12));
+		texture.width = (int) readLE32(data + 20);
+		texture.height = (int) readLE32(data + 24);
+		unsigned depth = readLE32(data + 28);
+		unsigned layers = readLE32(data + 32);
+		unsigned faces = readLE32(data + 36);
+		unsigned levels = std::max(readLE32(data + 40), 1u);
+		unsigned supercompression = readLE32(data + 44);
+
+		if (supercompression)
+			return "Supercompressed KTX2 is not supported";
+
+		if (depth > 1 || layers > 1 || faces != 1)
+			return "Only 2D KTX2 textures are supported";
+
+		if (texture.format == UNKNOWN_BLOCKS)
+			return "KTX2 block format is not supported";
+
+		if (texture.width <= 0 || texture.height <= 0)
+			return "Image has no pixels";
+
+		if (80 + (size_t) levels * 24 > size)
+			return "Invalid KTX2 header";
+
+		// Key / value data may declare orientation, default is rows from the top
+		unsigned kvdOffset = readLE32(data + 56);
+		unsigned kvdLength = readLE32(data + 60);
+		texture.topDown = true;
+
+		if ((size_t) kvdOffset + kvdLength <= size) {
+			size_t position = kvdOffset;
+			size_t end = (size_t) kvdOffset + kvdLength;
+
+			while (position + 4 <= end) {
+				unsigned length = readLE32(data + position);
+				const char* entry = (const char*) data + position + 4;
+
+				if (position + 4 + length > end)
+					break;
+
+				static const char key[] = "KTXorientation";
+				if (length > sizeof(key) + 1 && !memcmp(entry, key, sizeof(key)))
+					texture.topDown = entry[sizeof(key) + 1] != 'u';
+
+				position += (4 + length + 3) & ~(size_t) 3;
+			}
+		}
+
+		// Level index, level 0 is the largest
+		int width = texture.width;
+		int height = texture.height;
+
+		for (unsigned i = 0; i < levels; ++i) {
+			const unsigned char* entry = data + 80 + i * 24;
+			unsigned long long offset = readLE64(entry);
+			unsigned long long length = readLE64(entry + 8);
+
+			Level level;
+			level.width = width;
+			level.height = height;
+			level.size = getLevelSize(texture.format, width, height);
+			level.data = data + offset;
+
+			if (length < level.size || offset + length > size) {
+				if (i > 0)
+					break;
+
+				return "Compressed texture is truncated";
+			}
+
+			texture.levels.push_back(level);
+
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+
+		return "";
+	}
+
+	// Maps file and parses levels
+	// Returns empty string on success, error description else
+	inline std::string load(const std::wstring& path, Texture& texture) {
+		if (texture.file.open(path))
+			return "Failed to open image file";
+
+		std::string error;
+
+		if (isDDS(texture.file.data(), texture.file.size()))
+			error = parseDDS(texture);
+		else if (isKTX2(texture.file.data(), texture.file.size()))
+			error = parseKTX2(texture);
+		else
+			error = "Not a DDS or KTX2 file";
+
+		if (!error.empty())
+			texture.release();
+
+		return error;
+	}
+}
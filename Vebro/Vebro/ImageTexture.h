@@ -0,0 +1,942 @@
+#pragma once
+
+// Image input (PNG, JPEG, animated PNG, GIF, and pre-compressed DDS / KTX2)
+// File is decoded once on worker thread, so loading pack never waits for decoding. Frames of animated images
+//  are decoded in parallel, then composed in order into full canvas frames. Render thread uploads all frames into
+//  single texture array once and during playback only copies the displayed layer on GPU, there is no per-frame
+//  decode or upload. Still images are single frame and are uploaded straight into channel texture.
+// Pre-compressed files are only mapped and parsed on worker thread, see CompressedTexture. Still PNG and JPEG
+//  images are block compressed in background after the first load and are mapped from TextureCache later.
+// Does not touch OpenGL.
+namespace ImageTexture {
+
+	enum Format {
+		UNKNOWN_FORMAT,
+		PNG_FORMAT,
+		APNG_FORMAT,
+		GIF_FORMAT,
+		JPEG_FORMAT,
+		DDS_FORMAT,
+		KTX2_FORMAT
+	};
+
+	// Frames with shorter delay are shown with DefaultDelay, as browsers do
+	const double MinDelay     = 0.011;
+	const double DefaultDelay = 0.1;
+
+	// Limit of decoded pixels memory (in bytes), larger animations are rejected
+	const size_t MaxMemory = (size_t) 1024 * 1024 * 1024;
+
+	// Decoded image, still image has single frame
+	struct Animation {
+		int width = 0;
+		int height = 0;
+
+		// Canvas of each frame, width * height * getPixelSize() bytes each (bottom row first)
+		std::vector<unsigned char> pixels;
+
+		// Gray, gray with alpha, RGB or RGBA with 8 or 16 bits per channel (native byte order)
+		// Only still PNG can have other than 4 channels of 8 bits
+		int channels = 4;
+		int bitDepth = 8;
+
+		// Rows are stored from the top as decoded (still PNG), else from the bottom as OpenGL expects
+		bool topDown = false;
+
+		// Display duration of each frame and start time of each frame (in seconds)
+		std::vector<double> delays;
+		std::vector<double> starts;
+
+		double duration = 0.0;
+
+		int getPixelSize() const {
+			return channels * bitDepth / 8;
+		}
+
+		int getFrames() const {
+			return (int) delays.size();
+		}
+
+		// Index of the frame shown at given time, animation loops
+		int frameAt(double time) const {
+			if (delays.size() <= 1 || duration <= 0.0)
+				return 0;
+
+			time = fmod(time, duration);
+			if (time < 0.0)
+				time += duration;
+
+			return (int) (std::upper_bound(starts.begin(), starts.end(), time) - starts.begin()) - 1;
+		}
+	};
+
+	// Frame before composition
+	struct RawFrame {
+
+		// Rectangle on canvas
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+
+		double delay = DefaultDelay;
+
+		// 0 - keep, 1 - clear rectangle to transparent, 2 - restore canvas from before the frame
+		int dispose = 0;
+
+		// Alpha blend over canvas instead of replacing rectangle
+		bool blend = true;
+
+		// Encoded data: LZW stream (GIF) or complete single frame PNG (APNG)
+		std::vector<unsigned char> data;
+
+		// GIF only
+		std::vector<unsigned char> palette;
+		int minCodeSize = 0;
+		int transparent = -1;
+		bool interlaced = false;
+
+		// Decoded pixels, width * height * 4 bytes (RGBA, top row first)
+		std::vector<unsigned char> rgba;
+	};
+
+	inline unsigned readLE16(const unsigned char* p) {
+		return p[0] | (p[1] << 8);
+	}
+
+	inline unsigned readBE32(const unsigned char* p) {
+		return ((unsigned) p[0] << 24) | ((unsigned) p[1] << 16) | ((unsigned) p[2] << 8) | p[3];
+	}
+
+	inline unsigned readBE16(const unsigned char* p) {
+		return (p[0] << 8) | p[1];
+	}
+
+	// Decodes GIF LZW stream into palette indices, missing pixels of truncated stream stay 0
+	// Returns empty string on success, error description else
+	inline std::string decodeLZW(const std::vector<unsigned char>& data, int minCodeSize, std::vector<unsigned char>& indices) {
+		if (minCodeSize < 2 || minCodeSize > 11)
+			return "Invalid GIF LZW code size";
+
+		const int MaxCodes = 4096;
+
+		unsigned short prefix[MaxCodes];
+		unsigned char suffix[MaxCodes];
+		unsigned char stack[MaxCodes + 1];
+
+		const int clear = 1 << minCodeSize;
+		const int end = clear + 1;
+
+		for (int i = 0; i < clear; ++i) {
+			prefix[i] = 0;
+			suffix[i] = (unsigned char) i;
+		}
+
+		int codeSize = minCodeSize + 1;
+		int next = clear + 2;
+		int previous = -1;
+		unsigned char first = 0;
+
+		size_t out = 0;
+		unsigned bits = 0;
+		int bitCount = 0;
+
+		for (size_t i = 0; i < data.size() && out < indices.size(); ) {
+
+			// Fill bit buffer
+			while (bitCount < codeSize && i < data.size()) {
+				bits |= (unsigned) data[i++] << bitCount;
+				bitCount += 8;
+			}
+
+			if (bitCount < codeSize)
+				break;
+
+			int code = bits & ((1 << codeSize) - 1);
+			bits >>= codeSize;
+			bitCount -= codeSize;
+
+			if (code == clear) {
+				codeSize = minCodeSize + 1;
+				next = clear + 2;
+				previous = -1;
+				continue;
+			}
+
+			if (code == end)
+				break;
+
+			if (previous == -1) {
+				if (code >= clear)
+					return "Invalid GIF LZW stream";
+
+				indices[out++] = (unsigned char) code;
+				previous = code;
+				first = (unsigned char) code;
+				continue;
+			}
+
+			int current = code;
+			int top = 0;
+
+			// Code is not yet in the table (KwKwK case)
+			if (code >= next) {
+				if (code > next)
+					return "Invalid GIF LZW stream";
+
+				stack[top++] = first;
+				code = previous;
+			}
+
+			while (code >= clear) {
+				stack[top++] = suffix[code];
+				code = prefix[code];
+			}
+
+			first = suffix[code];
+			stack[top++] = first;
+
+			while (top && out < indices.size())
+				indices[out++] = stack[--top];
+
+			if (next < MaxCodes) {
+				prefix[next] = (unsigned short) previous;
+				suffix[next] = first;
+				++next;
+
+				if (next == (1 << codeSize) && codeSize < 12)
+					++codeSize;
+			}
+
+			previous = current;
+		}
+
+		return "";
+	}
+
+	// Decodes GIF frame into RGBA
+	// Returns empty string on success, error description else
+	inline std::string decodeGIFFrame(RawFrame& frame) {
+		std::vector<unsigned char> indices((size_t) frame.width * frame.height, 0);
+
+		std::string error = decodeLZW(frame.data, frame.minCodeSize, indices);
+		if (!error.empty())
+			return error;
+
+		frame.rgba.assign((size_t) frame.width * frame.height * 4, 0);
+
+		int colors = (int) frame.palette.size() / 3;
+
+		// Interlaced rows are stored by passes: every 8th from 0, every 8th from 4, every 4th from 2, every 2nd from 1
+		const int passStart[4] = { 0, 4, 2, 1 };
+		const int passStep[4] = { 8, 8, 4, 2 };
+
+		int pass = 0;
+		int row = 0;
+
+		for (int y = 0; y < frame.height; ++y) {
+			int target = y;
+
+			if (frame.interlaced) {
+				while (pass < 4 && row >= frame.height) {
+					++pass;
+					if (pass < 4)
+						row = passStart[pass];
+				}
+
+				target = row;
+				row += passStep[pass];
+			}
+
+			const unsigned char* source = &indices[(size_t) y * frame.width];
+			unsigned char* pixel = &frame.rgba[(size_t) target * frame.width * 4];
+
+			for (int x = 0; x < frame.width; ++x, pixel += 4) {
+				int index = source[x];
+
+				if (index == frame.transparent || index >= colors)
+					continue;
+
+				pixel[0] = frame.palette[index * 3 + 0];
+				pixel[1] = frame.palette[index * 3 + 1];
+				pixel[2] = frame.palette[index * 3 + 2];
+				pixel[3] = 255;
+			}
+		}
+
+		frame.data.clear();
+		frame.data.shrink_to_fit();
+
+		return "";
+	}
+
+	// Splits GIF into frames
+	// Returns empty string on success, error description else
+	inline std::string parseGIF(const std::vector<unsigned char>& file, int& width, int& height, std::vector<RawFrame>& frames) {
+		if (file.size() < 13)
+			return "Invalid GIF file";
+
+		width = readLE16(&file[6]);
+		height = readLE16(&file[8]);
+
+		size_t position = 13;
+		std::vector<unsigned char> globalPalette;
+
+		if (file[10] & 0x80) {
+			size_t size = (size_t) 3 << ((file[10] & 7) + 1);
+			if (position + size > file.size())
+				return "Invalid GIF file";
+
+			globalPalette.assign(file.begin() + position, file.begin() + position + size);
+			position += size;
+		}
+
+		// Graphic control of the next frame
+		RawFrame control;
+
+		// Concatenates data sub-blocks starting at position
+		auto readBlocks = [&](std::vector<unsigned char>* out) -> bool {
+			while (position < file.size()) {
+				size_t size = file[position++];
+				if (size == 0)
+					return true;
+
+				if (position + size > file.size())
+					return false;
+
+				if (out)
+					out->insert(out->end(), file.begin() + position, file.begin() + position + size);
+
+				position += size;
+			}
+
+			return false;
+		};
+
+		while (position < file.size()) {
+			unsigned char block = file[position++];
+
+			// Trailer
+			if (block == 0x3B)
+				break;
+
+			// Extension
+			if (block == 0x21) {
+				if (position >= file.size())
+					break;
+
+				unsigned char label = file[position++];
+
+				// Graphic control extension
+				if (label == 0xF9 && position + 5 <= file.size() && file[position] >= 4) {
+					unsigned char packed = file[position + 1];
+					unsigned delay = readLE16(&file[position + 2]);
+
+					int disposal = (packed >> 2) & 7;
+					control.dispose = disposal == 2 ? 1 : disposal == 3 ? 2 : 0;
+					control.delay = delay * 0.01;
+					control.transparent = (packed & 1) ? file[position + 4] : -1;
+				}
+
+				if (!readBlocks(nullptr))
+					break;
+
+				continue;
+			}
+
+			// Image descriptor
+			if (block == 0x2C) {
+				if (position + 9 > file.size())
+					return "Invalid GIF file";
+
+				RawFrame frame = control;
+				frame.x = readLE16(&file[position + 0]);
+				frame.y = readLE16(&file[position + 2]);
+				frame.width = readLE16(&file[position + 4]);
+				frame.height = readLE16(&file[position + 6]);
+
+				// Frame is drawn onto canvas of logical screen size, part outside of it is clipped by drawFrame()
+				if (frame.width == 0 || frame.height == 0 || frame.x >= width || frame.y >= height)
+					return "Invalid GIF frame rectangle";
+
+				unsigned char packed = file[position + 8];
+				frame.interlaced = (packed & 0x40) != 0;
+				position += 9;
+
+				if (packed & 0x80) {
+					size_t size = (size_t) 3 << ((packed & 7) + 1);
+					if (position + size > file.size())
+						return "Invalid GIF file";
+
+					frame.palette.assign(file.begin() + position, file.begin() + position + size);
+					position += size;
+				} else
+					frame.palette = globalPalette;
+
+				if (position >= file.size())
+					return "Invalid GIF file";
+
+				frame.minCodeSize = file[position++];
+
+				// Truncated last frame is still shown
+				bool complete = readBlocks(&frame.data);
+
+				frames.push_back(std::move(frame));
+				control = RawFrame();
+
+				if (!complete)
+					break;
+
+				continue;
+			}
+
+			return "Invalid GIF block";
+		}
+
+		if (frames.size() == 0)
+			return "GIF contains no frames";
+
+		return "";
+	}
+
+	// Appends PNG chunk
+	inline void appendChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t size) {
+		size_t start = out.size();
+
+		out.push_back((unsigned char) (size >> 24));
+		out.push_back((unsigned char) (size >> 16));
+		out.push_back((unsigned char) (size >> 8));
+		out.push_back((unsigned char) size);
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data, data + size);
+
+		unsigned crc = lodepng_crc32(&out[start + 4], size + 4);
+		out.push_back((unsigned char) (crc >> 24));
+		out.push_back((unsigned char) (crc >> 16));
+		out.push_back((unsigned char) (crc >> 8));
+		out.push_back((unsigned char) crc);
+	}
+
+	// Decodes APNG frame into RGBA
+	// Returns empty string on success, error description else
+	inline std::string decodeAPNGFrame(RawFrame& frame) {
+		unsigned width, height;
+		unsigned error = lodepng::decode(frame.rgba, width, height, frame.data);
+
+		if (error)
+			return lodepng_error_text(error);
+
+		if ((int) width != frame.width || (int) height != frame.height)
+			return "APNG frame size mismatch";
+
+		frame.data.clear();
+		frame.data.shrink_to_fit();
+
+		return "";
+	}
+
+	// Splits APNG into frames, each frame is rebuilt into standalone PNG
+	// Returns empty string on success, error description else
+	inline std::string parseAPNG(const std::vector<unsigned char>& file, int& width, int& height, std::vector<RawFrame>& frames) {
+		static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+		std::vector<unsigned char> header;
+
+		// Chunks shared by all frames (palette, transparency, color space)
+		std::vector<unsigned char> shared;
+
+		// Frame data (IDAT / fdAT payloads)
+		std::vector<std::vector<unsigned char>> data;
+
+		bool animated = false;
+
+		for (size_t position = 8; position + 12 <= file.size(); ) {
+			size_t size = readBE32(&file[position]);
+			const char* type = (const char*) &file[position + 4];
+			const unsigned char* chunk = &file[position + 8];
+
+			if (position + 12 + size > file.size())
+				return "Invalid PNG file";
+
+			position += 12 + size;
+
+			if (!memcmp(type, "IHDR", 4)) {
+				if (size < 13)
+					return "Invalid PNG file";
+
+				header.assign(chunk, chunk + size);
+				width = readBE32(chunk);
+				height = readBE32(chunk + 4);
+			} else if (!memcmp(type, "acTL", 4))
+				animated = true;
+			else if (!memcmp(type, "fcTL", 4)) {
+				if (size < 26)
+					return "Invalid APNG frame control";
+
+				RawFrame frame;
+				frame.width = readBE32(chunk + 4);
+				frame.height = readBE32(chunk + 8);
+				frame.x = readBE32(chunk + 12);
+				frame.y = readBE32(chunk + 16);
+
+				unsigned numerator = readBE16(chunk + 20);
+				unsigned denominator = readBE16(chunk + 22);
+				frame.delay = (double) numerator / (denominator ? denominator : 100);
+
+				frame.dispose = chunk[24] <= 2 ? chunk[24] : 0;
+				frame.blend = chunk[25] == 1;
+
+				if (frame.width <= 0 || frame.height <= 0 || frame.x + frame.width > width || frame.y + frame.height > height)
+					return "Invalid APNG frame rectangle";
+
+				frames.push_back(std::move(frame));
+				data.emplace_back();
+			} else if (!memcmp(type, "IDAT", 4)) {
+
+				// Default image is the first frame only if it has frame control
+				if (frames.size())
+					data.back().insert(data.back().end(), chunk, chunk + size);
+			} else if (!memcmp(type, "fdAT", 4)) {
+				if (size < 4 || frames.size() == 0)
+					return "Invalid APNG frame data";
+
+				data.back().insert(data.back().end(), chunk + 4, chunk + size);
+			} else if (!memcmp(type, "IEND", 4))
+				break;
+			else if (data.size() == 0)
+				shared.insert(shared.end(), &file[position - 12 - size], &file[position]);
+		}
+
+		if (!animated || header.empty())
+			return "PNG is not animated";
+
+		if (frames.size() == 0)
+			return "APNG contains no frames";
+
+		// Previous canvas does not exist for the first frame
+		if (frames[0].dispose == 2)
+			frames[0].dispose = 1;
+
+		for (size_t i = 0; i < frames.size(); ++i) {
+			RawFrame& frame = frames[i];
+
+			std::vector<unsigned char> frameHeader = header;
+			for (int b = 0; b < 4; ++b) {
+				frameHeader[b] = (unsigned char) (frame.width >> (24 - b * 8));
+				frameHeader[4 + b] = (unsigned char) (frame.height >> (24 - b * 8));
+			}
+
+			frame.data.assign(signature, signature + 8);
+			appendChunk(frame.data, "IHDR", frameHeader.data(), frameHeader.size());
+			frame.data.insert(frame.data.end(), shared.begin(), shared.end());
+			appendChunk(frame.data, "IDAT", data[i].data(), data[i].size());
+			appendChunk(frame.data, "IEND", nullptr, 0);
+
+			std::vector<unsigned char>().swap(data[i]);
+		}
+
+		return "";
+	}
+
+	// Draws decoded frame over canvas
+	inline void drawFrame(const RawFrame& frame, int width, int height, std::vector<unsigned char>& canvas) {
+		for (int y = 0; y < frame.height; ++y) {
+			int cy = frame.y + y;
+			if (cy >= height)
+				break;
+
+			for (int x = 0; x < frame.width; ++x) {
+				int cx = frame.x + x;
+				if (cx >= width)
+					break;
+
+				const unsigned char* source = &frame.rgba[((size_t) y * frame.width + x) * 4];
+				unsigned char* target = &canvas[((size_t) cy * width + cx) * 4];
+
+				if (!frame.blend || source[3] == 255) {
+					memcpy(target, source, 4);
+					continue;
+				}
+
+				if (source[3] == 0)
+					continue;
+
+				// Non-premultiplied source over destination
+				unsigned sa = source[3];
+				unsigned da = target[3] * (255 - sa) / 255;
+				unsigned a = sa + da;
+
+				for (int c = 0; c < 3; ++c)
+					target[c] = (unsigned char) ((source[c] * sa + target[c] * da) / a);
+
+				target[3] = (unsigned char) a;
+			}
+		}
+	}
+
+	// Runs jobs on all hardware threads
+	inline void parallelFor(size_t count, const std::function<void(size_t)>& job) {
+		size_t workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+		std::atomic<size_t> next { 0 };
+
+		auto work = [&]() {
+			for (size_t i = next++; i < count; i = next++)
+				job(i);
+		};
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < workers; ++i)
+			threads.emplace_back(work);
+
+		work();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	// Detects format by file signature, UNKNOWN_FORMAT if file can not be read or is not supported
+	inline Format detectFormat(const std::wstring& path) {
+		std::ifstream file(path, std::ios::binary);
+		unsigned char head[12] = {};
+
+		if (!file.read((char*) head, 12))
+			return UNKNOWN_FORMAT;
+
+		if (CompressedTexture::isDDS(head, 12))
+			return DDS_FORMAT;
+
+		if (CompressedTexture::isKTX2(head, 12))
+			return KTX2_FORMAT;
+
+		if (!memcmp(head, "GIF87a", 6) || !memcmp(head, "GIF89a", 6))
+			return GIF_FORMAT;
+
+		if (Jpeg::isJPEG(head, 8))
+			return JPEG_FORMAT;
+
+		static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+		if (memcmp(head, signature, 8))
+			return UNKNOWN_FORMAT;
+
+		// Animation control chunk must be placed before image data
+		unsigned char chunk[8];
+		file.seekg(8);
+		while (file.read((char*) chunk, 8)) {
+			if (!memcmp(chunk + 4, "acTL", 4))
+				return APNG_FORMAT;
+
+			if (!memcmp(chunk + 4, "IDAT", 4) || !memcmp(chunk + 4, "IEND", 4))
+				return PNG_FORMAT;
+
+			file.seekg((std::streamoff) readBE32(chunk) + 4, std::ios::cur);
+		}
+
+		return PNG_FORMAT;
+	}
+
+	// Stores still image as single frame, pixels are bottom row first
+	inline void setStill(Animation& animation, int width, int height, std::vector<unsigned char>& pixels, int channels = 4, int bitDepth = 8) {
+		animation.width = width;
+		animation.height = height;
+		animation.channels = channels;
+		animation.bitDepth = bitDepth;
+		animation.topDown = false;
+		animation.pixels.swap(pixels);
+		animation.delays.assign(1, 0.0);
+		animation.starts.assign(1, 0.0);
+		animation.duration = 0.0;
+	}
+
+	// Returns 0 on success, 1 else
+	inline BOOL readFile(const std::wstring& path, std::vector<unsigned char>& file) {
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream)
+			return 1;
+
+		file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return 0;
+	}
+
+	// Decodes still PNG keeping channels and bit depth of the file, so gray images stay single channel and
+	//  16 bit images keep precision. Palette and low bit depth images are expanded to 8 bits.
+	// Rows are kept from the top as decoded, texture is flipped during upload.
+	// Returns empty string on success, error description else
+	inline std::string decodePNG(const std::vector<unsigned char>& file, Animation& animation) {
+		static const LodePNGColorType colorTypes[4] = { LCT_GREY, LCT_GREY_ALPHA, LCT_RGB, LCT_RGBA };
+
+		lodepng::State state;
+		unsigned width = 0;
+		unsigned height = 0;
+
+		unsigned error = lodepng_inspect(&width, &height, &state, file.data(), file.size());
+		if (error)
+			return lodepng_error_text(error);
+
+		const LodePNGColorMode& color = state.info_png.color;
+		int bitDepth = color.bitdepth == 16 ? 16 : 8;
+		int channels = 4;
+
+		if (color.colortype == LCT_GREY)
+			channels = 1;
+		else if (color.colortype == LCT_GREY_ALPHA)
+			channels = 2;
+		else if (color.colortype == LCT_RGB)
+			channels = 3;
+
+		std::vector<unsigned char> decoded;
+
+		while (true) {
+			state.info_raw.colortype = colorTypes[channels - 1];
+			state.info_raw.bitdepth = bitDepth;
+
+			// Decoder appends to output
+			decoded.clear();
+
+			error = lodepng::decode(decoded, width, height, state, file);
+			if (error)
+				return lodepng_error_text(error);
+
+			// Transparent color key is known only after decoding and needs alpha channel
+			if (!state.info_png.color.key_defined || channels == 2 || channels == 4)
+				break;
+
+			++channels;
+		}
+
+		// PNG channels are big endian
+		if (bitDepth == 16)
+			for (size_t i = 0; i + 1 < decoded.size(); i += 2)
+				std::swap(decoded[i], decoded[i + 1]);
+
+		setStill(animation, width, height, decoded, channels, bitDepth);
+		animation.topDown = true;
+		return "";
+	}
+
+	// Decodes all frames of the file contents, contents are released once not needed
+	// Returns empty string on success, error description else
+	inline std::string load(std::vector<unsigned char>& file, Format format, Animation& animation) {
+		int width = 0;
+		int height = 0;
+		std::string error;
+
+		if (format == JPEG_FORMAT) {
+			std::vector<unsigned char> pixels;
+
+			error = Jpeg::decode(file, width, height, pixels);
+			if (error.empty())
+				setStill(animation, width, height, pixels);
+
+			return error;
+		}
+
+		if (format == PNG_FORMAT)
+			return decodePNG(file, animation);
+
+		std::vector<RawFrame> frames;
+		bool gif = format == GIF_FORMAT;
+
+		if (gif)
+			error = parseGIF(file, width, height, frames);
+		else
+			error = parseAPNG(file, width, height, frames);
+
+		if (!error.empty())
+			return error;
+
+		std::vector<unsigned char>().swap(file);
+
+		if (width <= 0 || height <= 0)
+			return "Image has no pixels";
+
+		size_t frameSize = (size_t) width * height * 4;
+		if (frameSize * frames.size() > MaxMemory)
+			return "Animation is too large";
+
+		// Frames are independent until composition
+		std::vector<std::string> errors(frames.size());
+		parallelFor(frames.size(), [&](size_t i) {
+			errors[i] = gif ? decodeGIFFrame(frames[i]) : decodeAPNGFrame(frames[i]);
+		});
+
+		for (auto& frameError : errors)
+			if (!frameError.empty())
+				return frameError;
+
+		animation.width = width;
+		animation.height = height;
+		animation.pixels.assign(frameSize * frames.size(), 0);
+		animation.delays.clear();
+		animation.starts.clear();
+		animation.duration = 0.0;
+
+		std::vector<unsigned char> canvas(frameSize, 0);
+		std::vector<unsigned char> previous;
+
+		for (size_t i = 0; i < frames.size(); ++i) {
+			RawFrame& frame = frames[i];
+
+			if (frame.dispose == 2)
+				previous = canvas;
+
+			drawFrame(frame, width, height, canvas);
+
+			// Store bottom row first
+			unsigned char* target = &animation.pixels[frameSize * i];
+			for (int y = 0; y < height; ++y)
+				memcpy(target + (size_t) (height - 1 - y) * width * 4, &canvas[(size_t) y * width * 4], (size_t) width * 4);
+
+			if (frame.dispose == 1) {
+				for (int y = frame.y; y < std::min(frame.y + frame.height, height); ++y) {
+					int right = std::min(frame.x + frame.width, width);
+					if (right > frame.x)
+						memset(&canvas[((size_t) y * width + frame.x) * 4], 0, (size_t) (right - frame.x) * 4);
+				}
+			} else if (frame.dispose == 2)
+				canvas.swap(previous);
+
+			std::vector<unsigned char>().swap(frame.rgba);
+
+			double delay = frame.delay < MinDelay ? DefaultDelay : frame.delay;
+			animation.starts.push_back(animation.duration);
+			animation.delays.push_back(delay);
+			animation.duration += delay;
+		}
+
+		return "";
+	}
+
+	/*
+	 * Loads image on worker thread
+	 * Render thread polls ready() and takes the result once.
+	 * Still PNG and JPEG images are looked up in texture cache first, on miss render thread passes
+	 *  uploaded pixels back with cache() to compress them in background.
+	 */
+	class Loader {
+
+		std::future<std::string> result;
+		std::future<void> caching;
+
+		// Set when loader is destroyed, stops compression early
+		std::atomic<bool> aborted { false };
+
+		TextureCache::Settings cacheSettings;
+
+		// Cache entry of the file, empty if file is not cacheable
+		std::wstring cacheEntry;
+
+	public:
+
+		Animation animation;
+
+		// Result for pre-compressed formats and cached images, animation stays empty
+		CompressedTexture::Texture compressed;
+
+		// Set when compressed result comes from texture cache
+		bool cached = false;
+
+		~Loader() {
+			aborted = true;
+
+			if (result.valid())
+				result.wait();
+			if (caching.valid())
+				caching.wait();
+		}
+
+		void start(const std::wstring& path, Format format, const TextureCache::Settings& settings) {
+			cacheSettings = settings;
+
+			result = std::async(std::launch::async, [this, path, format]() {
+				if (format == DDS_FORMAT || format == KTX2_FORMAT)
+					return CompressedTexture::load(path, compressed);
+
+				std::vector<unsigned char> file;
+				if (readFile(path, file))
+					return std::string("Failed to open image file");
+
+				if (format == PNG_FORMAT || format == JPEG_FORMAT) {
+					cacheEntry = TextureCache::getEntry(file, cacheSettings);
+
+					if (!TextureCache::find(cacheEntry, compressed)) {
+						cacheEntry.clear();
+						cached = true;
+						return std::string();
+					}
+				}
+
+				return load(file, format, animation);
+			});
+		}
+
+		bool ready() const {
+			return result.valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		// Returns empty string on success, error description else
+		// Can be called once after ready() returned true
+		std::string get() {
+			return result.get();
+		}
+
+		// Compresses uploaded still image on worker threads and stores it into cache, flip tells if rows go in reverse texture order
+		// Only large 8 bit RGB and RGBA images are cached, gray images are already small and 16 bit images would lose precision
+		void cache(int width, int height, int channels, int bitDepth, bool flip, std::vector<unsigned char>& pixels) {
+			if (cacheEntry.empty() || caching.valid() || (size_t) width * height < TextureCache::MinPixels || channels < 3 || bitDepth != 8)
+				return;
+
+			CompressedTexture::BlockFormat format = cacheSettings.format;
+
+			// BC1 has no smooth alpha
+			if (format != CompressedTexture::BC7 && !BlockEncoder::isOpaque(pixels.data(), (size_t) width * height, channels))
+				return;
+
+			caching = std::async(std::launch::async, [this, width, height, channels, flip, format, image = std::move(pixels)]() mutable {
+				size_t row = (size_t) width * channels;
+
+				// Encoding also runs on this pooled thread, it's priority is restored for the next tasks of the pool
+				HANDLE thread = GetCurrentThread();
+				int priority = GetThreadPriority(thread);
+
+				// Entries hold rows in texture order
+				if (flip)
+					for (int y = 0; y < height / 2; ++y)
+						std::swap_ranges(image.begin() + row * y, image.begin() + row * (y + 1), image.begin() + row * (height - 1 - y));
+
+				std::vector<TextureCache::EncodedLevel> levels;
+				int levelWidth = width;
+				int levelHeight = height;
+
+				while (!aborted) {
+					size_t rowSize = CompressedTexture::getLevelSize(format, levelWidth, 4);
+					size_t rows = (levelHeight + 3) / 4;
+
+					TextureCache::EncodedLevel level { levelWidth, levelHeight, std::vector<unsigned char>(rowSize * rows) };
+
+					parallelFor(rows, [&](size_t y) {
+						if (aborted)
+							return;
+
+						// Never compete with rendering
+						SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+						BlockEncoder::encodeRow(format, image.data(), levelWidth, levelHeight, channels, (int) y, &level.blocks[rowSize * y]);
+					});
+
+					levels.push_back(std::move(level));
+
+					if (!cacheSettings.mipmaps || (levelWidth == 1 && levelHeight == 1))
+						break;
+
+					image = BlockEncoder::downsample(image, levelWidth, levelHeight, channels);
+					levelWidth = std::max(levelWidth / 2, 1);
+					levelHeight = std::max(levelHeight / 2, 1);
+				}
+
+				if (!aborted)
+					TextureCache::store(cacheEntry, format, levels);
+
+				SetThreadPriority(thread, priority);
+			});
+		}
+	};
+}
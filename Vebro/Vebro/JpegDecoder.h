@@ -0,0 +1,997 @@
+#pragma once
+
+// JPEG decoder for image input (baseline and progressive, 8 bit, grayscale or YCbCr with any chroma subsampling)
+// All scans are entropy decoded into coefficients first, then each 8x8 block is dequantized and transformed with SSE
+//  (separable IDCT as two float matrix products), chroma is upsampled and converted to RGB with SSE too.
+// Arithmetic coded, lossless, 12 bit and CMYK files are not supported.
+// Does not touch OpenGL.
+namespace Jpeg {
+
+	// Limit of decoded pixels, larger images are rejected
+	const size_t MaxPixels = (size_t) 1 << 28;
+
+	// Natural (row major) index of the coefficient at zigzag position
+	const unsigned char ZigZag[64] = {
+		 0,  1,  8, 16,  9,  2,  3, 10,
+		17, 24, 32, 25, 18, 11,  4,  5,
+		12, 19, 26, 33, 40, 48, 41, 34,
+		27, 20, 13,  6,  7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36,
+		29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46,
+		53, 60, 61, 54, 47, 55, 62, 63
+	};
+
+	inline int readBE16(const unsigned char* data) {
+		return (data[0] << 8) | data[1];
+	}
+
+	// Returns true if data starts with JPEG signature
+	inline bool isJPEG(const unsigned char* data, size_t size) {
+		return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+	}
+
+	/*
+	 * Canonical Huffman table
+	 * Codes up to FastBits long are resolved with single lookup, longer codes are searched by length
+	 */
+	struct Huffman {
+		static const int FastBits = 9;
+		static const unsigned short Slow = 0xFFFF;
+
+		bool defined = false;
+
+		// Symbol index for each FastBits prefix, Slow if code is longer
+		unsigned short fast[1 << FastBits];
+
+		unsigned char sizes[257];
+		unsigned short codes[256];
+		unsigned char values[256];
+
+		// Code following the last code of each length (left aligned to 16 bits) and offset from code to symbol index
+		unsigned maxcode[18];
+		int delta[17];
+
+		// Returns false if table is malformed
+		bool build(const unsigned char* counts, const unsigned char* symbols) {
+			int k = 0;
+			for (int i = 0; i < 16; ++i)
+				for (int j = 0; j < counts[i]; ++j)
+					sizes[k++] = (unsigned char) (i + 1);
+
+			sizes[k] = 0;
+			memcpy(values, symbols, k);
+
+			unsigned code = 0;
+			k = 0;
+			for (int j = 1; j <= 16; ++j) {
+				delta[j] = k - (int) code;
+
+				if (sizes[k] == j) {
+					while (sizes[k] == j)
+						codes[k++] = (unsigned short) code++;
+
+					if (code - 1 >= (1u << j))
+						return false;
+				}
+
+				maxcode[j] = code << (16 - j);
+				code <<= 1;
+			}
+
+			maxcode[17] = 0xFFFFFFFF;
+
+			for (int i = 0; i < (1 << FastBits); ++i)
+				fast[i] = Slow;
+
+			for (int i = 0; i < k; ++i)
+				if (sizes[i] <= FastBits) {
+					int first = codes[i] << (FastBits - sizes[i]);
+					int count = 1 << (FastBits - sizes[i]);
+
+					for (int j = 0; j < count; ++j)
+						fast[first + j] = (unsigned short) i;
+				}
+
+			defined = true;
+			return true;
+		}
+	};
+
+	/*
+	 * Reader of entropy coded segment
+	 * Removes stuffed zero bytes, stops at marker and reads zero bits past it
+	 */
+	class BitReader {
+
+		const unsigned char* data;
+		size_t size;
+		size_t position;
+
+		// Unread bits, left aligned
+		unsigned buffer = 0;
+		int count = 0;
+
+		// Set when marker was reached
+		bool marker = false;
+
+		void fill() {
+			while (count <= 24) {
+				unsigned byte = 0;
+
+				if (!marker && position < size) {
+					byte = data[position];
+
+					if (byte == 0xFF) {
+						if (position + 1 < size && data[position + 1] == 0x00)
+							position += 2;
+						else {
+							marker = true;
+							byte = 0;
+						}
+					} else
+						++position;
+				}
+
+				buffer |= byte << (24 - count);
+				count += 8;
+			}
+		}
+
+	public:
+
+		BitReader(const unsigned char* data, size_t size, size_t position) : data(data), size(size), position(position) {}
+
+		// Position of the first byte not consumed from segment
+		size_t getPosition() const {
+			return position;
+		}
+
+		// Returns symbol or -1 on invalid code
+		int decode(const Huffman& table) {
+			fill();
+
+			unsigned short index = table.fast[buffer >> (32 - Huffman::FastBits)];
+			if (index != Huffman::Slow) {
+				int length = table.sizes[index];
+				buffer <<= length;
+				count -= length;
+				return table.values[index];
+			}
+
+			unsigned prefix = buffer >> 16;
+			int length = Huffman::FastBits + 1;
+			while (prefix >= table.maxcode[length])
+				++length;
+
+			if (length == 17)
+				return -1;
+
+			int symbol = (int) (buffer >> (32 - length)) + table.delta[length];
+			if (symbol < 0 || symbol > 255)
+				return -1;
+
+			buffer <<= length;
+			count -= length;
+			return table.values[symbol];
+		}
+
+		// Reads up to 16 bits
+		int bits(int amount) {
+			if (!amount)
+				return 0;
+
+			fill();
+
+			int value = (int) (buffer >> (32 - amount));
+			buffer <<= amount;
+			count -= amount;
+			return value;
+		}
+
+		// Converts amount bits of magnitude category into signed value
+		static int extend(int value, int amount) {
+			return value < (1 << (amount - 1)) ? value - (1 << amount) + 1 : value;
+		}
+
+		// Drops remaining bits of the interval and skips restart marker following it
+		void restart() {
+			buffer = 0;
+			count = 0;
+			marker = false;
+
+			while (position + 1 < size && !(data[position] == 0xFF && data[position + 1] != 0x00 && data[position + 1] != 0xFF))
+				++position;
+
+			if (position + 1 < size && data[position + 1] >= 0xD0 && data[position + 1] <= 0xD7)
+				position += 2;
+			else
+				marker = true;
+		}
+	};
+
+	struct Component {
+		int id = 0;
+
+		// Sampling factors and quantization table
+		int h = 1;
+		int v = 1;
+		int table = 0;
+
+		// Huffman tables of the current scan
+		int dcTable = 0;
+		int acTable = 0;
+
+		// Samples of the component, not counting padding
+		int width = 0;
+		int height = 0;
+
+		// Blocks allocated, padded to whole MCUs
+		int blocksWide = 0;
+		int blocksHigh = 0;
+
+		int dcPrediction = 0;
+
+		// Quantized coefficients of all blocks, natural order
+		std::vector<short> coefficients;
+
+		// Decoded samples, blocksWide * 8 wide
+		std::vector<unsigned char> samples;
+	};
+
+	/*
+	 * IDCT basis, A[x][u] = C(u) / 2 * cos((2x + 1) u pi / 16)
+	 * Rows of the block are transformed with A by frequency, then columns with A by sample.
+	 */
+	struct Basis {
+		alignas(16) float byFrequency[8][8];
+		float bySample[8][8];
+
+		Basis() {
+			const double pi = 3.14159265358979323846;
+
+			for (int x = 0; x < 8; ++x)
+				for (int u = 0; u < 8; ++u) {
+					float value = (float) ((u ? 1.0 : sqrt(0.5)) * 0.5 * cos((2 * x + 1) * u * pi / 16.0));
+					byFrequency[u][x] = value;
+					bySample[x][u] = value;
+				}
+		}
+	};
+
+	inline const Basis& getBasis() {
+		static const Basis basis;
+		return basis;
+	}
+
+	// Dequantizes and transforms block into 8x8 samples
+	inline void idct(const short* block, const unsigned short* quant, unsigned char* out, size_t stride) {
+		const Basis& basis = getBasis();
+		const __m128i zero = _mm_setzero_si128();
+
+		__m128 rows[8][2];
+		int used = 0;
+
+		// Horizontal pass, rows without coefficients (most of them) are skipped by both passes
+		for (int v = 0; v < 8; ++v) {
+			__m128i coefficients = _mm_loadu_si128((const __m128i*) (block + v * 8));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(coefficients, zero)) == 0xFFFF)
+				continue;
+
+			// 32 bit products of coefficients and quantization steps
+			__m128i q = _mm_loadu_si128((const __m128i*) (quant + v * 8));
+			__m128i low = _mm_mullo_epi16(coefficients, q);
+			__m128i high = _mm_mulhi_epi16(coefficients, q);
+
+			alignas(16) float values[8];
+			_mm_store_ps(values, _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, high)));
+			_mm_store_ps(values + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, high)));
+
+			__m128 left = _mm_setzero_ps();
+			__m128 right = _mm_setzero_ps();
+
+			for (int u = 0; u < 8; ++u) {
+				__m128 value = _mm_set1_ps(values[u]);
+				left = _mm_add_ps(left, _mm_mul_ps(value, _mm_load_ps(&basis.byFrequency[u][0])));
+				right = _mm_add_ps(right, _mm_mul_ps(value, _mm_load_ps(&basis.byFrequency[u][4])));
+			}
+
+			rows[v][0] = left;
+			rows[v][1] = right;
+			used |= 1 << v;
+		}
+
+		// Vertical pass, level shift and saturation to bytes
+		const __m128 center = _mm_set1_ps(128.0f);
+
+		for (int y = 0; y < 8; ++y) {
+			__m128 left = center;
+			__m128 right = center;
+
+			for (int v = 0; v < 8; ++v) {
+				if (!(used & (1 << v)))
+					continue;
+
+				__m128 weight = _mm_set1_ps(basis.bySample[y][v]);
+				left = _mm_add_ps(left, _mm_mul_ps(weight, rows[v][0]));
+				right = _mm_add_ps(right, _mm_mul_ps(weight, rows[v][1]));
+			}
+
+			__m128i words = _mm_packs_epi32(_mm_cvtps_epi32(left), _mm_cvtps_epi32(right));
+			_mm_storel_epi64((__m128i*) (out + y * stride), _mm_packus_epi16(words, words));
+		}
+	}
+
+	// Loads 4 bytes as floats
+	inline __m128 loadBytes(const unsigned char* data) {
+		int packed;
+		memcpy(&packed, data, 4);
+
+		__m128i zero = _mm_setzero_si128();
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero));
+	}
+
+	inline unsigned char clampByte(float value) {
+		return (unsigned char) (value < 0.0f ? 0 : value > 255.0f ? 255 : (int) (value + 0.5f));
+	}
+
+	// Converts row of YCbCr samples into RGBA pixels
+	inline void convertRow(const unsigned char* luma, const unsigned char* cb, const unsigned char* cr, unsigned char* out, int width) {
+		const __m128 center = _mm_set1_ps(128.0f);
+		const __m128 crToR = _mm_set1_ps(1.402f);
+		const __m128 cbToG = _mm_set1_ps(-0.344136f);
+		const __m128 crToG = _mm_set1_ps(-0.714136f);
+		const __m128 cbToB = _mm_set1_ps(1.772f);
+		const __m128i alpha = _mm_set1_epi32(255);
+
+		int x = 0;
+		for (; x + 4 <= width; x += 4) {
+			__m128 y = loadBytes(luma + x);
+			__m128 u = _mm_sub_ps(loadBytes(cb + x), center);
+			__m128 v = _mm_sub_ps(loadBytes(cr + x), center);
+
+			__m128 r = _mm_add_ps(y, _mm_mul_ps(v, crToR));
+			__m128 g = _mm_add_ps(y, _mm_add_ps(_mm_mul_ps(u, cbToG), _mm_mul_ps(v, crToG)));
+			__m128 b = _mm_add_ps(y, _mm_mul_ps(u, cbToB));
+
+			// Saturate to bytes: r0..r3 g0..g3 and b0..b3 a0..a3
+			__m128i rg = _mm_packs_epi32(_mm_cvtps_epi32(r), _mm_cvtps_epi32(g));
+			__m128i ba = _mm_packs_epi32(_mm_cvtps_epi32(b), alpha);
+			rg = _mm_packus_epi16(rg, rg);
+			ba = _mm_packus_epi16(ba, ba);
+
+			// Interleave into r0 g0 b0 a0 r1 ...
+			rg = _mm_unpacklo_epi8(rg, _mm_srli_si128(rg, 4));
+			ba = _mm_unpacklo_epi8(ba, _mm_srli_si128(ba, 4));
+			_mm_storeu_si128((__m128i*) (out + x * 4), _mm_unpacklo_epi16(rg, ba));
+		}
+
+		for (; x < width; ++x) {
+			float y = luma[x];
+			float u = cb[x] - 128.0f;
+			float v = cr[x] - 128.0f;
+
+			out[x * 4 + 0] = clampByte(y + 1.402f * v);
+			out[x * 4 + 1] = clampByte(y - 0.344136f * u - 0.714136f * v);
+			out[x * 4 + 2] = clampByte(y + 1.772f * u);
+			out[x * 4 + 3] = 255;
+		}
+	}
+
+	class Decoder {
+
+		const unsigned char* data;
+		size_t size;
+
+		unsigned short quant[4][64];
+		bool quantDefined[4] = {};
+
+		Huffman dc[4];
+		Huffman ac[4];
+
+		std::vector<Component> components;
+		bool frame = false;
+		bool progressive = false;
+
+		int width = 0;
+		int height = 0;
+		int hmax = 1;
+		int vmax = 1;
+		int mcusWide = 0;
+		int mcusHigh = 0;
+
+		int restartInterval = 0;
+
+		// Color transform from Adobe marker, 0 means RGB, -1 if there is no marker
+		int transform = -1;
+
+		// Current scan
+		int scanComponents[4];
+		int scanCount = 0;
+		int spectralStart = 0;
+		int spectralEnd = 63;
+		int approxHigh = 0;
+		int approxLow = 0;
+		int eobRun = 0;
+
+		std::string parseQuant(const unsigned char* segment, size_t length) {
+			size_t p = 0;
+
+			while (p < length) {
+				int precision = segment[p] >> 4;
+				int id = segment[p] & 15;
+				++p;
+
+				if (precision > 1 || id > 3 || p + 64 * (precision + 1) > length)
+					return "Invalid JPEG quantization table";
+
+				for (int k = 0; k < 64; ++k) {
+					// IDCT multiplies as signed 16 bit, larger steps make no sense anyway
+					quant[id][ZigZag[k]] = (unsigned short) std::min(precision ? readBE16(segment + p) : segment[p], 32767);
+					p += precision + 1;
+				}
+
+				quantDefined[id] = true;
+			}
+
+			return "";
+		}
+
+		std::string parseHuffman(const unsigned char* segment, size_t length) {
+			size_t p = 0;
+
+			while (p + 17 <= length) {
+				int type = segment[p] >> 4;
+				int id = segment[p] & 15;
+				const unsigned char* counts = segment + p + 1;
+				p += 17;
+
+				int total = 0;
+				for (int i = 0; i < 16; ++i)
+					total += counts[i];
+
+				if (type > 1 || id > 3 || total > 256 || p + total > length)
+					return "Invalid JPEG Huffman table";
+
+				if (!(type ? ac[id] : dc[id]).build(counts, segment + p))
+					return "Invalid JPEG Huffman table";
+
+				p += total;
+			}
+
+			return "";
+		}
+
+		std::string parseFrame(const unsigned char* segment, size_t length) {
+			if (frame)
+				return "JPEG with multiple frames is not supported";
+
+			if (length < 6)
+				return "Invalid JPEG frame header";
+
+			if (segment[0] != 8)
+				return "Only 8 bit JPEG is supported";
+
+			height = readBE16(segment + 1);
+			width = readBE16(segment + 3);
+			int count = segment[5];
+
+			if (!width || !height)
+				return "Image has no pixels";
+
+			if ((size_t) width * height > MaxPixels)
+				return "Image is too large";
+
+			if (count != 1 && count != 3)
+				return "Only grayscale and YCbCr JPEG is supported";
+
+			if (length < 6 + 3 * (size_t) count)
+				return "Invalid JPEG frame header";
+
+			components.resize(count);
+			for (int i = 0; i < count; ++i) {
+				Component& component = components[i];
+				component.id = segment[6 + 3 * i];
+				component.h = segment[7 + 3 * i] >> 4;
+				component.v = segment[7 + 3 * i] & 15;
+				component.table = segment[8 + 3 * i];
+
+				if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.table > 3)
+					return "Invalid JPEG frame header";
+
+				hmax = std::max(hmax, component.h);
+				vmax = std::max(vmax, component.v);
+			}
+
+			mcusWide = (width + 8 * hmax - 1) / (8 * hmax);
+			mcusHigh = (height + 8 * vmax - 1) / (8 * vmax);
+
+			for (auto& component : components) {
+				component.width = (width * component.h + hmax - 1) / hmax;
+				component.height = (height * component.v + vmax - 1) / vmax;
+				component.blocksWide = mcusWide * component.h;
+				component.blocksHigh = mcusHigh * component.v;
+				component.coefficients.assign((size_t) component.blocksWide * component.blocksHigh * 64, 0);
+			}
+
+			frame = true;
+			return "";
+		}
+
+		std::string parseScan(const unsigned char* segment, size_t length) {
+			if (!frame)
+				return "JPEG scan before frame header";
+
+			scanCount = length ? segment[0] : 0;
+			if (scanCount < 1 || scanCount > 4 || length < 4 + 2 * (size_t) scanCount)
+				return "Invalid JPEG scan header";
+
+			for (int i = 0; i < scanCount; ++i) {
+				int id = segment[1 + 2 * i];
+				int tables = segment[2 + 2 * i];
+
+				scanComponents[i] = -1;
+				for (size_t c = 0; c < components.size(); ++c)
+					if (components[c].id == id)
+						scanComponents[i] = (int) c;
+
+				if (scanComponents[i] < 0 || (tables >> 4) > 3 || (tables & 15) > 3)
+					return "Invalid JPEG scan header";
+
+				components[scanComponents[i]].dcTable = tables >> 4;
+				components[scanComponents[i]].acTable = tables & 15;
+			}
+
+			const unsigned char* spectral = segment + 1 + 2 * scanCount;
+
+			if (progressive) {
+				spectralStart = spectral[0];
+				spectralEnd = spectral[1];
+				approxHigh = spectral[2] >> 4;
+				approxLow = spectral[2] & 15;
+
+				if (spectralStart > spectralEnd || spectralEnd > 63 || (spectralStart == 0 && spectralEnd != 0) || (spectralStart > 0 && scanCount != 1) || approxLow > 13)
+					return "Invalid JPEG progressive scan";
+			} else {
+				spectralStart = 0;
+				spectralEnd = 63;
+				approxHigh = 0;
+				approxLow = 0;
+			}
+
+			for (int i = 0; i < scanCount; ++i) {
+				const Component& component = components[scanComponents[i]];
+
+				if (spectralStart == 0 && approxHigh == 0 && !dc[component.dcTable].defined)
+					return "Missing JPEG Huffman table";
+
+				if (spectralEnd > 0 && !ac[component.acTable].defined)
+					return "Missing JPEG Huffman table";
+			}
+
+			return "";
+		}
+
+		bool decodeSequential(BitReader& reader, Component& component, short* block) {
+			int category = reader.decode(dc[component.dcTable]);
+			if (category < 0 || category > 15)
+				return false;
+
+			component.dcPrediction += category ? BitReader::extend(reader.bits(category), category) : 0;
+			block[0] = (short) component.dcPrediction;
+
+			for (int k = 1; k < 64;) {
+				int symbol = reader.decode(ac[component.acTable]);
+				if (symbol < 0)
+					return false;
+
+				int run = symbol >> 4;
+				int category = symbol & 15;
+
+				if (!category) {
+					if (run != 15)
+						break;
+
+					k += 16;
+					continue;
+				}
+
+				k += run;
+				if (k > 63)
+					return false;
+
+				block[ZigZag[k++]] = (short) BitReader::extend(reader.bits(category), category);
+			}
+
+			return true;
+		}
+
+		bool decodeDCFirst(BitReader& reader, Component& component, short* block) {
+			int category = reader.decode(dc[component.dcTable]);
+			if (category < 0 || category > 15)
+				return false;
+
+			component.dcPrediction += category ? BitReader::extend(reader.bits(category), category) : 0;
+			block[0] = (short) (component.dcPrediction * (1 << approxLow));
+
+			return true;
+		}
+
+		bool decodeDCRefine(BitReader& reader, short* block) {
+			if (reader.bits(1))
+				block[0] |= (short) (1 << approxLow);
+
+			return true;
+		}
+
+		bool decodeACFirst(BitReader& reader, Component& component, short* block) {
+			if (eobRun) {
+				--eobRun;
+				return true;
+			}
+
+			for (int k = spectralStart; k <= spectralEnd;) {
+				int symbol = reader.decode(ac[component.acTable]);
+				if (symbol < 0)
+					return false;
+
+				int run = symbol >> 4;
+				int category = symbol & 15;
+
+				if (!category) {
+
+					// End of band in this block and in the following eobRun blocks
+					if (run < 15) {
+						eobRun = (1 << run) - 1 + reader.bits(run);
+						break;
+					}
+
+					k += 16;
+					continue;
+				}
+
+				k += run;
+				if (k > spectralEnd)
+					return false;
+
+				block[ZigZag[k++]] = (short) (BitReader::extend(reader.bits(category), category) * (1 << approxLow));
+			}
+
+			return true;
+		}
+
+		bool decodeACRefine(BitReader& reader, Component& component, short* block) {
+			short bit = (short) (1 << approxLow);
+
+			// Adds correction bit to coefficient that is already nonzero
+			auto refine = [&](short& coefficient) {
+				if (reader.bits(1) && !(coefficient & bit))
+					coefficient += coefficient > 0 ? bit : -bit;
+			};
+
+			if (eobRun) {
+				--eobRun;
+
+				for (int k = spectralStart; k <= spectralEnd; ++k)
+					if (block[ZigZag[k]])
+						refine(block[ZigZag[k]]);
+
+				return true;
+			}
+
+			int k = spectralStart;
+			do {
+				int symbol = reader.decode(ac[component.acTable]);
+				if (symbol < 0)
+					return false;
+
+				int run = symbol >> 4;
+				int category = symbol & 15;
+				short value = 0;
+
+				if (!category) {
+
+					// End of band, the rest of the block only gets correction bits
+					if (run < 15) {
+						eobRun = (1 << run) - 1 + reader.bits(run);
+						run = 64;
+					}
+				} else
+					value = reader.bits(1) ? bit : -bit;
+
+				// Skip run of zero coefficients, nonzero ones in between get correction bits
+				while (k <= spectralEnd) {
+					short& coefficient = block[ZigZag[k++]];
+
+					if (coefficient)
+						refine(coefficient);
+					else {
+						if (!run) {
+							coefficient = value;
+							break;
+						}
+
+						--run;
+					}
+				}
+			} while (k <= spectralEnd);
+
+			return true;
+		}
+
+		bool decodeBlock(BitReader& reader, Component& component, int x, int y) {
+			short* block = &component.coefficients[((size_t) y * component.blocksWide + x) * 64];
+
+			if (!progressive)
+				return decodeSequential(reader, component, block);
+
+			if (spectralStart == 0)
+				return approxHigh ? decodeDCRefine(reader, block) : decodeDCFirst(reader, component, block);
+
+			return approxHigh ? decodeACRefine(reader, component, block) : decodeACFirst(reader, component, block);
+		}
+
+		// Decodes entropy coded segment of the scan starting at position
+		// Returns position after the segment, broken data ends the scan leaving the rest of coefficients as is
+		size_t decodeScan(size_t position) {
+			BitReader reader(data, size, position);
+
+			for (int i = 0; i < scanCount; ++i)
+				components[scanComponents[i]].dcPrediction = 0;
+
+			eobRun = 0;
+
+			// Restart markers reset prediction, MCUs of the interval are counted down
+			int units = 0;
+			int remaining = restartInterval;
+			auto next = [&](int total) {
+				++units;
+
+				if (restartInterval && --remaining == 0 && units < total) {
+					reader.restart();
+
+					for (int i = 0; i < scanCount; ++i)
+						components[scanComponents[i]].dcPrediction = 0;
+
+					eobRun = 0;
+					remaining = restartInterval;
+				}
+			};
+
+			// Single component scans are not interleaved and cover only blocks of the component itself
+			if (scanCount == 1) {
+				Component& component = components[scanComponents[0]];
+				int blocksWide = (component.width + 7) / 8;
+				int blocksHigh = (component.height + 7) / 8;
+
+				for (int y = 0; y < blocksHigh; ++y)
+					for (int x = 0; x < blocksWide; ++x) {
+						if (!decodeBlock(reader, component, x, y))
+							return reader.getPosition();
+
+						next(blocksWide * blocksHigh);
+					}
+
+				return reader.getPosition();
+			}
+
+			for (int my = 0; my < mcusHigh; ++my)
+				for (int mx = 0; mx < mcusWide; ++mx) {
+					for (int i = 0; i < scanCount; ++i) {
+						Component& component = components[scanComponents[i]];
+
+						for (int v = 0; v < component.v; ++v)
+							for (int h = 0; h < component.h; ++h)
+								if (!decodeBlock(reader, component, mx * component.h + h, my * component.v + v))
+									return reader.getPosition();
+					}
+
+					next(mcusWide * mcusHigh);
+				}
+
+			return reader.getPosition();
+		}
+
+		// Samples of the component upsampled to image width for row y
+		const unsigned char* upsampleRow(const Component& component, int y, const std::vector<int>& columns, const std::vector<float>& weights, std::vector<float>& column, std::vector<unsigned char>& row) {
+			size_t stride = (size_t) component.blocksWide * 8;
+
+			if (component.h == hmax && component.v == vmax)
+				return &component.samples[stride * y];
+
+			// Bilinear, sample centers are aligned as in libjpeg fancy upsampling
+			// Vertical pass runs at component width, horizontal pass expands it to image width
+			float sy = std::min(std::max((y + 0.5f) * component.v / vmax - 0.5f, 0.0f), (float) (component.height - 1));
+			int y0 = (int) sy;
+			int y1 = std::min(y0 + 1, component.height - 1);
+			float fy = sy - y0;
+
+			const unsigned char* top = &component.samples[stride * y0];
+			const unsigned char* bottom = &component.samples[stride * y1];
+
+			for (int x = 0; x < component.width; ++x)
+				column[x] = top[x] + (bottom[x] - top[x]) * fy;
+
+			column[component.width] = column[component.width - 1];
+
+			for (int x = 0; x < width; ++x) {
+				const float* pair = &column[columns[x]];
+				row[x] = (unsigned char) (pair[0] + (pair[1] - pair[0]) * weights[x] + 0.5f);
+			}
+
+			return row.data();
+		}
+
+		std::string finish(std::vector<unsigned char>& pixels) {
+			if (!frame)
+				return "JPEG has no frame";
+
+			for (auto& component : components) {
+				if (!quantDefined[component.table])
+					return "Missing JPEG quantization table";
+
+				size_t stride = (size_t) component.blocksWide * 8;
+				component.samples.assign(stride * component.blocksHigh * 8, 0);
+
+				for (int y = 0; y < component.blocksHigh; ++y)
+					for (int x = 0; x < component.blocksWide; ++x)
+						idct(&component.coefficients[((size_t) y * component.blocksWide + x) * 64], quant[component.table], &component.samples[stride * y * 8 + x * 8], stride);
+
+				std::vector<short>().swap(component.coefficients);
+			}
+
+			// Source column and weight of each output column for subsampled components
+			std::vector<std::vector<int>> columns(components.size());
+			std::vector<std::vector<float>> weights(components.size());
+			std::vector<std::vector<float>> vertical(components.size());
+			std::vector<std::vector<unsigned char>> rows(components.size());
+
+			for (size_t c = 0; c < components.size(); ++c) {
+				const Component& component = components[c];
+				columns[c].resize(width);
+				weights[c].resize(width);
+				vertical[c].resize(component.width + 1);
+				rows[c].resize(width);
+
+				for (int x = 0; x < width; ++x) {
+					float sx = std::min(std::max((x + 0.5f) * component.h / hmax - 0.5f, 0.0f), (float) (component.width - 1));
+					columns[c][x] = (int) sx;
+					weights[c][x] = sx - (int) sx;
+				}
+			}
+
+			// Components are stored as is with Adobe RGB transform, or without any marker when named R, G, B
+			bool rgb = components.size() == 3 && (transform == 0 || (transform < 0 && components[0].id == 'R' && components[1].id == 'G' && components[2].id == 'B'));
+
+			pixels.resize((size_t) width * height * 4);
+
+			for (int y = 0; y < height; ++y) {
+				const unsigned char* planes[3];
+				for (size_t c = 0; c < components.size(); ++c)
+					planes[c] = upsampleRow(components[c], y, columns[c], weights[c], vertical[c], rows[c]);
+
+				// Bottom row first
+				unsigned char* out = &pixels[(size_t) (height - 1 - y) * width * 4];
+
+				if (components.size() == 1) {
+					for (int x = 0; x < width; ++x) {
+						out[x * 4 + 0] = out[x * 4 + 1] = out[x * 4 + 2] = planes[0][x];
+						out[x * 4 + 3] = 255;
+					}
+				} else if (rgb) {
+					for (int x = 0; x < width; ++x) {
+						out[x * 4 + 0] = planes[0][x];
+						out[x * 4 + 1] = planes[1][x];
+						out[x * 4 + 2] = planes[2][x];
+						out[x * 4 + 3] = 255;
+					}
+				} else
+					convertRow(planes[0], planes[1], planes[2], out, width);
+			}
+
+			return "";
+		}
+
+	public:
+
+		Decoder(const unsigned char* data, size_t size) : data(data), size(size) {}
+
+		// Returns empty string on success, error description else
+		std::string decode(int& imageWidth, int& imageHeight, std::vector<unsigned char>& pixels) {
+			if (!isJPEG(data, size))
+				return "Not a JPEG file";
+
+			size_t position = 2;
+			std::string error;
+
+			while (true) {
+
+				// Next marker, fill bytes and anything unexpected before it are skipped
+				while (position + 1 < size && !(data[position] == 0xFF && data[position + 1] != 0x00 && data[position + 1] != 0xFF && (data[position + 1] < 0xD0 || data[position + 1] > 0xD7)))
+					++position;
+
+				// Truncated file is decoded as far as it goes
+				if (position + 1 >= size)
+					break;
+
+				int marker = data[position + 1];
+				position += 2;
+
+				if (marker == 0xD9)
+					break;
+
+				if (position + 2 > size)
+					break;
+
+				size_t length = readBE16(data + position);
+				if (length < 2 || position + length > size)
+					return "Invalid JPEG segment";
+
+				const unsigned char* segment = data + position + 2;
+				position += length;
+				length -= 2;
+
+				switch (marker) {
+					case 0xC0:
+					case 0xC1:
+					case 0xC2:
+						progressive = marker == 0xC2;
+						error = parseFrame(segment, length);
+						break;
+
+					case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+					case 0xC9: case 0xCA: case 0xCB:
+					case 0xCD: case 0xCE: case 0xCF:
+						return "Lossless and arithmetic coded JPEG is not supported";
+
+					case 0xC4:
+						error = parseHuffman(segment, length);
+						break;
+
+					case 0xDB:
+						error = parseQuant(segment, length);
+						break;
+
+					case 0xDD:
+						if (length < 2)
+							return "Invalid JPEG restart interval";
+
+						restartInterval = readBE16(segment);
+						break;
+
+					case 0xDA:
+						error = parseScan(segment, length);
+						if (error.empty())
+							position = decodeScan(position);
+						break;
+
+					case 0xEE:
+						if (length >= 12 && !memcmp(segment, "Adobe", 5))
+							transform = segment[11];
+						break;
+
+					default:
+						break;
+				}
+
+				if (!error.empty())
+					return error;
+			}
+
+			error = finish(pixels);
+			if (!error.empty())
+				return error;
+
+			imageWidth = width;
+			imageHeight = height;
+			return "";
+		}
+	};
+
+	// Decodes JPEG file contents into RGBA pixels (bottom row first)
+	// Returns empty string on success, error description else
+	inline std::string decode(const std::vector<unsigned char>& file, int& width, int& height, std::vector<unsigned char>& pixels) {
+		Decoder decoder(file.data(), file.size());
+		return decoder.decode(width, height, pixels);
+	}
+}
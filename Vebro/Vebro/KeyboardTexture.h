@@ -0,0 +1,356 @@
+#pragma once
+
+// Keyboard input, produces shadertoy compatible keyboard texture
+// Texture is 256x3 single channel indexed by virtual key code (same as javascript keyCode for common keys):
+//  row 0 contains current key state, row 1 contains keys pressed this frame, row 2 contains toggle state.
+// Key events are produced by Source (window procedure or it's own thread) and passed through lock-free queue,
+//  render thread applies them once per frame and uploads only changed texels.
+// Does not touch OpenGL.
+namespace KeyboardTexture {
+
+	const int TextureWidth  = 256;
+	const int TextureHeight = 3;
+
+	// Maximal amount of events between two frames, extra events are dropped
+	const int QueueSize = 1024;
+
+	struct KeyEvent {
+		unsigned char key = 0;
+		bool down = false;
+	};
+
+	typedef LockFree::SPSCRing<KeyEvent> KeyQueue;
+
+	/*
+	 * Source of key events
+	 * Events are pushed into queue from single thread of the source
+	 */
+	class Source {
+	public:
+		virtual ~Source() {}
+
+		// Starts producing events into queue
+		// Returns 0 on success, 1 else
+		virtual BOOL start(KeyQueue* queue) = 0;
+
+		virtual void stop() = 0;
+	};
+
+	/*
+	 * System keyboard
+	 * Wallpaper window never has focus, so keys are received as Raw Input delivered to target window in background
+	 *  (RIDEV_INPUTSINK). Window procedure of the target passes WM_INPUT to handleInput(), there is no global hook
+	 *  and no own thread on the input path of other applications.
+	 */
+	class RawInputSource : public Source {
+
+		// Raw input registration is per process, only one raw input source can be active
+		inline static std::atomic<KeyQueue*> activeQueue { nullptr };
+
+		HWND target;
+		bool started = false;
+
+		// Registers or removes keyboard raw input
+		// Returns 0 on success, 1 else
+		BOOL registerDevice(DWORD flags, HWND window) {
+			RAWINPUTDEVICE device = {};
+			device.usUsagePage = 0x01; // Generic desktop
+			device.usUsage = 0x06;     // Keyboard
+			device.dwFlags = flags;
+			device.hwndTarget = window;
+
+			return RegisterRawInputDevices(&device, 1, sizeof(device)) ? 0 : 1;
+		}
+
+	public:
+
+		RawInputSource(HWND target) : target(target) {}
+
+		~RawInputSource() {
+			stop();
+		}
+
+		// Pushes key event of WM_INPUT message into active queue, called from window procedure of the target
+		static void handleInput(LPARAM lParam) {
+			KeyQueue* queue = activeQueue;
+			if (!queue)
+				return;
+
+			RAWINPUT input;
+			UINT size = sizeof(input);
+
+			if (GetRawInputData((HRAWINPUT) lParam, RID_INPUT, &input, &size, sizeof(RAWINPUTHEADER)) == (UINT) -1 || input.header.dwType != RIM_TYPEKEYBOARD)
+				return;
+
+			// Fake key of escaped sequences, raw input already reports generic modifier codes
+			const RAWKEYBOARD& keyboard = input.data.keyboard;
+			if (keyboard.VKey == 0 || keyboard.VKey >= 0xFF)
+				return;
+
+			KeyEvent event;
+			event.key = (unsigned char) keyboard.VKey;
+			event.down = !(keyboard.Flags & RI_KEY_BREAK);
+
+			if (KeyEvent* slot = queue->writeSlot()) {
+				*slot = event;
+				queue->push();
+			}
+		}
+
+		BOOL start(KeyQueue* queue) override {
+			if (started)
+				return 0;
+
+			if (!target || activeQueue || registerDevice(RIDEV_INPUTSINK, target))
+				return 1;
+
+			started = true;
+			activeQueue = queue;
+			return 0;
+		}
+
+		void stop() override {
+			if (!started)
+				return;
+
+			started = false;
+			activeQueue = nullptr;
+			registerDevice(RIDEV_REMOVE, NULL);
+		}
+	};
+
+	/*
+	 * Scripted key stream, replays events in loop with original timing
+	 * Used to drive keyboard input without real keyboard (demos, benchmarks, headless runs)
+	 * Script is text with one event per line: <time in seconds> <key code> <down|up>, lines starting with # are ignored
+	 */
+	class ScriptedSource : public Source {
+
+		struct ScriptEvent {
+			double time;
+			KeyEvent event;
+		};
+
+		std::vector<ScriptEvent> events;
+
+		// Loop period (in seconds)
+		double period = 0.0;
+
+		std::thread* thread = nullptr;
+		std::mutex stopMutex;
+		std::condition_variable stopCondition;
+		bool stopping = false;
+
+		void run(KeyQueue* queue) {
+			auto loopStart = std::chrono::steady_clock::now();
+			std::unique_lock<std::mutex> lock(stopMutex);
+
+			while (!stopping) {
+				for (auto& scripted : events) {
+					auto due = loopStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(scripted.time));
+
+					if (stopCondition.wait_until(lock, due, [this]() { return stopping; }))
+						return;
+
+					if (KeyEvent* slot = queue->writeSlot()) {
+						*slot = scripted.event;
+						queue->push();
+					}
+				}
+
+				loopStart += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period));
+			}
+		}
+
+	public:
+
+		~ScriptedSource() {
+			stop();
+		}
+
+		// Parses script from stream
+		// Returns 0 on success, 1 else
+		BOOL parse(std::istream& stream, std::string& error) {
+			events.clear();
+
+			std::string line;
+			int lineNumber = 0;
+
+			while (std::getline(stream, line)) {
+				++lineNumber;
+
+				std::istringstream lineStream(line);
+				ScriptEvent scripted;
+				int key;
+				std::string action;
+
+				// Skip empty lines and comments
+				lineStream >> std::ws;
+				if (lineStream.peek() == EOF || lineStream.peek() == '#')
+					continue;
+
+				if (!(lineStream >> scripted.time >> key >> action) || scripted.time < 0.0 || key < 0 || key >= TextureWidth || (action != "down" && action != "up")) {
+					error = "Invalid key event at line " + std::to_string(lineNumber) + ", expected <time> <key> <down|up>";
+					return 1;
+				}
+
+				scripted.event.key = (unsigned char) key;
+				scripted.event.down = action == "down";
+				events.push_back(scripted);
+			}
+
+			if (events.size() == 0) {
+				error = "Script contains no key events";
+				return 1;
+			}
+
+			std::stable_sort(events.begin(), events.end(), [](const ScriptEvent& a, const ScriptEvent& b) { return a.time < b.time; });
+
+			// Loop right after the last event, but never faster than once a second
+			period = std::max(events.back().time, 1.0);
+
+			return 0;
+		}
+
+		// Parses script from file
+		// Returns 0 on success, 1 else
+		BOOL load(const std::wstring& path, std::string& error) {
+			std::ifstream file(path);
+
+			if (!file) {
+				error = "Failed to open key script";
+				return 1;
+			}
+
+			return parse(file, error);
+		}
+
+		BOOL start(KeyQueue* queue) override {
+			if (thread)
+				return 0;
+
+			stopping = false;
+			thread = new std::thread(&ScriptedSource::run, this, queue);
+
+			return 0;
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			{
+				std::lock_guard<std::mutex> lock(stopMutex);
+				stopping = true;
+			}
+
+			stopCondition.notify_all();
+			thread->join();
+			delete thread;
+			thread = nullptr;
+		}
+	};
+
+	// Rectangle of changed texels, [x0, x1) x [y0, y1)
+	struct Rect {
+		int x0 = 0;
+		int y0 = 0;
+		int x1 = 0;
+		int y1 = 0;
+	};
+
+	/*
+	 * Keyboard texture state
+	 * Owns source and event queue, update() is called by render thread once per frame
+	 */
+	class Keyboard {
+
+		Source* source;
+		KeyQueue queue { QueueSize };
+
+		unsigned char texels[TextureWidth * TextureHeight] = {};
+
+		// Keys marked in row 1 during the previous frame
+		std::vector<unsigned char> pressed;
+
+		// Extends rect of changes with texel
+		static void extend(Rect& rect, bool& changed, int x, int y) {
+			if (!changed) {
+				rect.x0 = x;
+				rect.x1 = x + 1;
+				rect.y0 = y;
+				rect.y1 = y + 1;
+				changed = true;
+				return;
+			}
+
+			rect.x0 = std::min(rect.x0, x);
+			rect.x1 = std::max(rect.x1, x + 1);
+			rect.y0 = std::min(rect.y0, y);
+			rect.y1 = std::max(rect.y1, y + 1);
+		}
+
+	public:
+
+		// Takes ownership of source
+		Keyboard(Source* source) : source(source) {}
+
+		~Keyboard() {
+			stop();
+			delete source;
+		}
+
+		// Returns 0 on success, 1 else
+		BOOL start() {
+			return source->start(&queue);
+		}
+
+		void stop() {
+			source->stop();
+		}
+
+		// Applies queued events
+		// Returns true if texels changed, rect contains all changed texels
+		bool update(Rect& rect) {
+			bool changed = false;
+
+			// Pressed state lasts single frame
+			for (unsigned char key : pressed) {
+				texels[TextureWidth + key] = 0;
+				extend(rect, changed, key, 1);
+			}
+
+			pressed.clear();
+
+			while (KeyEvent* event = queue.front()) {
+				unsigned char key = event->key;
+
+				if (event->down) {
+
+					// Ignore auto repeat
+					if (!texels[key]) {
+						texels[key] = 255;
+						texels[TextureWidth + key] = 255;
+						texels[TextureWidth * 2 + key] ^= 255;
+						pressed.push_back(key);
+
+						extend(rect, changed, key, 0);
+						extend(rect, changed, key, 2);
+					}
+				} else if (texels[key]) {
+					texels[key] = 0;
+					extend(rect, changed, key, 0);
+				}
+
+				queue.pop();
+			}
+
+			return changed;
+		}
+
+		// Texels of the texture, TextureWidth * TextureHeight
+		const unsigned char* getTexels() const {
+			return texels;
+		}
+	};
+}
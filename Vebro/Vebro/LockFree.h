@@ -0,0 +1,146 @@
+#pragma once
+
+// Lock-free primitives used to pass data between media threads and render thread
+// Render thread must never wait for producer, so all structures are single producer single consumer
+//  and never block: producer drops data when consumer is behind, consumer keeps the old data when producer is behind.
+namespace LockFree {
+
+	/*
+	 * Triple buffer
+	 * Producer always has slot to write into, consumer always reads the newest complete value,
+	 *  intermediate values are dropped if consumer is slower than producer.
+	 */
+	template<typename T>
+	class TripleBuffer {
+
+		// Marks shared slot holding value not yet seen by consumer
+		static const int DirtyBit = 4;
+
+		T slots[3];
+
+		// Index of the shared slot
+		std::atomic<int> middle { 1 };
+
+		// Owned by producer
+		int back = 0;
+
+		// Owned by consumer
+		int front = 2;
+
+	public:
+
+		// Slot available to producer
+		T& writeSlot() {
+			return slots[back];
+		}
+
+		// Makes written slot available to consumer
+		void publish() {
+			back = middle.exchange(back | DirtyBit, std::memory_order_acq_rel) & ~DirtyBit;
+		}
+
+		// Fetches the newest published value, returns true if there is new value
+		bool update() {
+			if (!(middle.load(std::memory_order_acquire) & DirtyBit))
+				return false;
+
+			front = middle.exchange(front, std::memory_order_acq_rel) & ~DirtyBit;
+			return true;
+		}
+
+		// Slot available to consumer, valid after update() returned true at least once
+		const T& readSlot() const {
+			return slots[front];
+		}
+	};
+
+	/*
+	 * Bounded ring queue
+	 * Elements are written in place: producer fills slot returned by writeSlot() and commits it with push(),
+	 *  consumer reads slot returned by front() and releases it with pop().
+	 */
+	template<typename T>
+	class SPSCRing {
+
+		std::vector<T> slots;
+
+		// Index of the next element to read, owned by consumer
+		std::atomic<size_t> head { 0 };
+
+		// Index of the next element to write, owned by producer
+		std::atomic<size_t> tail { 0 };
+
+	public:
+
+		SPSCRing(size_t capacity) : slots(capacity) {}
+
+		size_t capacity() const {
+			return slots.size();
+		}
+
+		// Number of elements available to consumer
+		size_t size() const {
+			return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+		}
+
+		// Free slot for producer, nullptr if ring is full
+		T* writeSlot() {
+			size_t t = tail.load(std::memory_order_relaxed);
+			if (t - head.load(std::memory_order_acquire) == slots.size())
+				return nullptr;
+
+			return &slots[t % slots.size()];
+		}
+
+		// Commits slot returned by writeSlot()
+		void push() {
+			tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Element at given distance from the oldest one, nullptr if there is no such element
+		T* front(size_t offset = 0) {
+			size_t h = head.load(std::memory_order_relaxed);
+			if (tail.load(std::memory_order_acquire) - h <= offset)
+				return nullptr;
+
+			return &slots[(h + offset) % slots.size()];
+		}
+
+		// Releases the oldest element
+		void pop() {
+			head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Copies up to count elements into ring at once, elements that do not fit are dropped
+		// Returns amount of elements written
+		size_t write(const T* data, size_t count) {
+			size_t t = tail.load(std::memory_order_relaxed);
+			size_t free = slots.size() - (t - head.load(std::memory_order_acquire));
+
+			if (count > free)
+				count = free;
+
+			for (size_t i = 0; i < count; ++i)
+				slots[(t + i) % slots.size()] = data[i];
+
+			tail.store(t + count, std::memory_order_release);
+			return count;
+		}
+
+		// Moves up to count the oldest elements out of ring at once
+		// Returns amount of elements read
+		size_t read(T* data, size_t count) {
+			size_t h = head.load(std::memory_order_relaxed);
+			size_t available = tail.load(std::memory_order_acquire) - h;
+
+			if (count > available)
+				count = available;
+
+			for (size_t i = 0; i < count; ++i)
+				data[i] = slots[(h + i) % slots.size()];
+
+			head.store(h + count, std::memory_order_release);
+			return count;
+		}
+	};
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+// Output of samples produced by Sound shader
+// Render thread writes interleaved stereo float samples into lock-free ring ahead of playback, sink consumes them
+//  from it's own thread. Sink never waits for render thread: if ring runs dry, silence is played and underrun is counted.
+// Does not touch OpenGL.
+namespace SoundOutput {
+
+	const int SampleRate = 44100;
+	const int Channels   = 2;
+
+	// Device plays DeviceBlockCount buffers of DeviceBlockSize frames in turn (~23 ms each)
+	const int DeviceBlockSize  = 1024;
+	const int DeviceBlockCount = 4;
+
+	// Interleaved stereo samples
+	typedef LockFree::SPSCRing<float> SampleRing;
+
+	/*
+	 * Consumer of the sample ring
+	 */
+	class Sink {
+	protected:
+
+		SampleRing* ring = nullptr;
+
+		std::atomic<unsigned> underruns { 0 };
+		std::atomic<unsigned long long> played { 0 };
+
+		// Moves up to frames frames out of ring, missing frames are filled with silence
+		// Short read before the first sample arrived is pre-roll, not underrun
+		// Returns amount of frames read from ring
+		size_t take(float* out, size_t frames) {
+			size_t read = ring->read(out, frames * Channels) / Channels;
+
+			if (read < frames) {
+				std::fill(out + read * Channels, out + frames * Channels, 0.0f);
+
+				if (played)
+					++underruns;
+			}
+
+			played += read;
+			return read;
+		}
+
+	public:
+
+		virtual ~Sink() {}
+
+		// Opens the sink, samples are read from ring once started
+		// Returns 0 on success, 1 else
+		virtual BOOL open(SampleRing* source, std::string& error) = 0;
+
+		virtual void start() = 0;
+
+		virtual void stop() = 0;
+
+		virtual void setPaused(bool value) = 0;
+
+		// Indicates if sink does not take samples anymore
+		virtual bool finished() const {
+			return false;
+		}
+
+		// Amount of blocks played with missing samples
+		unsigned getUnderruns() const {
+			return underruns;
+		}
+
+		// Amount of frames taken from ring
+		unsigned long long getPlayed() const {
+			return played;
+		}
+	};
+
+	/*
+	 * Default playback device through waveOut
+	 * Device plays DeviceBlockCount buffers in turn, playback thread wakes up on each finished buffer,
+	 *  refills it from ring and gives it back to device.
+	 */
+	class WaveOutSink : public Sink {
+
+		HWAVEOUT device = NULL;
+		HANDLE event = NULL;
+
+		WAVEHDR headers[DeviceBlockCount] = {};
+		std::vector<short> memory;
+
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+
+		void fill(WAVEHDR& header, std::vector<float>& block) {
+			take(block.data(), DeviceBlockSize);
+
+			short* pcm = (short*) header.lpData;
+			for (size_t i = 0; i < block.size(); ++i)
+				pcm[i] = (short) (std::clamp(block[i], -1.0f, 1.0f) * 32767.0f);
+		}
+
+		void run() {
+			std::vector<float> block(DeviceBlockSize * Channels);
+
+			// Buffers are played in order they were queued
+			int next = 0;
+
+			while (running) {
+				WaitForSingleObject(event, 100);
+
+				while (running && (headers[next].dwFlags & WHDR_DONE)) {
+					fill(headers[next], block);
+
+					waveOutWrite(device, &headers[next], sizeof(WAVEHDR));
+					next = (next + 1) % DeviceBlockCount;
+				}
+			}
+		}
+
+		void close() {
+			if (!device)
+				return;
+
+			waveOutReset(device);
+
+			for (auto& header : headers)
+				waveOutUnprepareHeader(device, &header, sizeof(WAVEHDR));
+
+			waveOutClose(device);
+			device = NULL;
+
+			CloseHandle(event);
+			event = NULL;
+		}
+
+	public:
+
+		~WaveOutSink() {
+			stop();
+			close();
+		}
+
+		BOOL open(SampleRing* source, std::string& error) override {
+			stop();
+			close();
+
+			ring = source;
+
+			WAVEFORMATEX format = {};
+			format.wFormatTag = WAVE_FORMAT_PCM;
+			format.nChannels = Channels;
+			format.nSamplesPerSec = SampleRate;
+			format.wBitsPerSample = 16;
+			format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+			format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+			event = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+			if (waveOutOpen(&device, WAVE_MAPPER, &format, (DWORD_PTR) event, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+				CloseHandle(event);
+				event = NULL;
+				device = NULL;
+
+				error = "No audio playback device available";
+				return 1;
+			}
+
+			memory.assign(DeviceBlockSize * Channels * DeviceBlockCount, 0);
+
+			for (int i = 0; i < DeviceBlockCount; ++i) {
+				headers[i] = {};
+				headers[i].lpData = (char*) &memory[DeviceBlockSize * Channels * i];
+				headers[i].dwBufferLength = DeviceBlockSize * Channels * sizeof(short);
+				waveOutPrepareHeader(device, &headers[i], sizeof(WAVEHDR));
+			}
+
+			return 0;
+		}
+
+		void start() override {
+			if (thread || !device)
+				return;
+
+			// Device starts with silence, samples are picked up by the next buffers
+			for (auto& header : headers) {
+				memset(header.lpData, 0, header.dwBufferLength);
+				waveOutWrite(device, &header, sizeof(WAVEHDR));
+			}
+
+			running = true;
+			thread = new std::thread(&WaveOutSink::run, this);
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			running = false;
+			SetEvent(event);
+
+			thread->join();
+			delete thread;
+			thread = nullptr;
+
+			// Takes all buffers back from device
+			waveOutReset(device);
+		}
+
+		void setPaused(bool value) override {
+			if (!device)
+				return;
+
+			if (value)
+				waveOutPause(device);
+			else
+				waveOutRestart(device);
+		}
+	};
+
+	/*
+	 * Writes samples into 32 bit float stereo WAV file as fast as they arrive
+	 * Stops after given amount of frames, header sizes are written on close.
+	 */
+	class WavFileSink : public Sink {
+
+		std::wstring path;
+		unsigned long long limit;
+
+		std::ofstream file;
+
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+		std::atomic<bool> done { false };
+
+		static void writeU16(std::ofstream& out, unsigned value) {
+			char bytes[2] = { (char) (value & 255), (char) ((value >> 8) & 255) };
+			out.write(bytes, 2);
+		}
+
+		static void writeU32(std::ofstream& out, unsigned value) {
+			char bytes[4] = { (char) (value & 255), (char) ((value >> 8) & 255), (char) ((value >> 16) & 255), (char) (value >> 24) };
+			out.write(bytes, 4);
+		}
+
+		// RIFF sizes are filled by close()
+		void writeHeader() {
+			file.write("RIFF", 4);
+			writeU32(file, 0);
+			file.write("WAVE", 4);
+
+			file.write("fmt ", 4);
+			writeU32(file, 16);
+			writeU16(file, 3); // IEEE float
+			writeU16(file, Channels);
+			writeU32(file, SampleRate);
+			writeU32(file, SampleRate * Channels * sizeof(float));
+			writeU16(file, Channels * sizeof(float));
+			writeU16(file, 32);
+
+			file.write("data", 4);
+			writeU32(file, 0);
+		}
+
+		void run() {
+			std::vector<float> block(DeviceBlockSize * Channels);
+
+			while (running && played < limit) {
+				size_t frames = (size_t) std::min<unsigned long long>(DeviceBlockSize, limit - played);
+
+				// Only complete samples are written, file has no gaps
+				size_t read = ring->read(block.data(), frames * Channels) / Channels;
+				if (!read) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(5));
+					continue;
+				}
+
+				file.write((const char*) block.data(), read * Channels * sizeof(float));
+				played += read;
+			}
+
+			if (played >= limit)
+				done = true;
+		}
+
+		void close() {
+			if (!file.is_open())
+				return;
+
+			unsigned dataSize = (unsigned) (played * Channels * sizeof(float));
+
+			file.seekp(4);
+			writeU32(file, 36 + dataSize);
+			file.seekp(40);
+			writeU32(file, dataSize);
+
+			file.close();
+		}
+
+	public:
+
+		WavFileSink(const std::wstring& path, unsigned long long frames) : path(path), limit(frames) {}
+
+		~WavFileSink() {
+			stop();
+			close();
+		}
+
+		BOOL open(SampleRing* source, std::string& error) override {
+			stop();
+			close();
+
+			ring = source;
+			played = 0;
+			done = false;
+
+			file.open(path, std::ios::binary);
+			if (!file) {
+				error = "Failed to create WAV file";
+				return 1;
+			}
+
+			writeHeader();
+			return 0;
+		}
+
+		void start() override {
+			if (thread || !file.is_open())
+				return;
+
+			running = true;
+			thread = new std::thread(&WavFileSink::run, this);
+		}
+
+		void stop() override {
+			if (!thread)
+				return;
+
+			running = false;
+
+			thread->join();
+			delete thread;
+			thread = nullptr;
+		}
+
+		// File has no clock, pause of render thread simply stops samples from coming
+		void setPaused(bool value) override {}
+
+		bool finished() const override {
+			return done;
+		}
+	};
+}
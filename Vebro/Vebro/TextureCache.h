@@ -0,0 +1,212 @@
+#pragma once
+
+// Disk cache of block compressed still images
+// Decoded PNG and JPEG inputs are compressed in background once shown and stored as DDS files under
+//  %LOCALAPPDATA%\Vebro\TextureCache, next load maps cached blocks instead of decoding the file again.
+// Entry name is made of hash of the file contents and encoder settings, so edited image or changed encoder
+//  never hits stale entry. The least recently used entries are deleted once cache grows above MaxSize.
+// Does not touch OpenGL.
+namespace TextureCache {
+
+	// Changes with encoder output, old entries are left for trim()
+	const int EncoderVersion = 1;
+
+	// Smaller images are kept exact, those are usually noise or lookup textures read texel by texel
+	const size_t MinPixels = 512 * 512;
+
+	// Limit of cache directory size (in bytes)
+	const unsigned long long MaxSize = 1024ull * 1024 * 1024;
+
+	struct Settings {
+
+		// Block format of entries (BC7 or BC1_RGBA), UNKNOWN_BLOCKS disables cache
+		CompressedTexture::BlockFormat format = CompressedTexture::UNKNOWN_BLOCKS;
+
+		// Entries hold images padded to power of two size
+		bool powerOfTwo = false;
+
+		// Entries hold rows from the bottom of the image
+		bool vflip = true;
+
+		// Entries hold full mip chain
+		bool mipmaps = false;
+	};
+
+	// Blocks of single mip level
+	struct EncodedLevel {
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> blocks;
+	};
+
+	// FNV-1a
+	inline unsigned long long hash(const std::vector<unsigned char>& data) {
+		unsigned long long value = 14695981039346656037ull;
+
+		for (unsigned char byte : data) {
+			value ^= byte;
+			value *= 1099511628211ull;
+		}
+
+		return value;
+	}
+
+	// Creates cache directory, returns empty string if it is not available
+	inline std::wstring getDirectory() {
+		wchar_t localAppData[MAX_PATH];
+		DWORD length = GetEnvironmentVariableW(L"LOCALAPPDATA", localAppData, MAX_PATH);
+
+		if (!length || length >= MAX_PATH)
+			return L"";
+
+		std::error_code error;
+		std::filesystem::path directory = std::filesystem::path(localAppData) / L"Vebro" / L"TextureCache";
+		std::filesystem::create_directories(directory, error);
+
+		if (error)
+			return L"";
+
+		return directory.wstring();
+	}
+
+	// Path of the entry for image file contents, empty if cache is not available
+	inline std::wstring getEntry(const std::vector<unsigned char>& file, const Settings& settings) {
+		if (settings.format == CompressedTexture::UNKNOWN_BLOCKS)
+			return L"";
+
+		std::wstring directory = getDirectory();
+		if (directory.empty())
+			return L"";
+
+		wchar_t name[64];
+		swprintf(name, 64, L"%016llx-%zx-%ls%ls%ls%ls-v%d.dds", hash(file), file.size(), settings.format == CompressedTexture::BC7 ? L"bc7" : L"bc1",
+			settings.powerOfTwo ? L"-pot" : L"", settings.vflip ? L"" : L"-top", settings.mipmaps ? L"-mip" : L"", EncoderVersion);
+
+		return (std::filesystem::path(directory) / name).wstring();
+	}
+
+	// Maps cached blocks of the entry
+	// Returns 0 on success, 1 else
+	inline BOOL find(const std::wstring& entry, CompressedTexture::Texture& texture) {
+		std::error_code error;
+
+		if (entry.empty() || !std::filesystem::exists(entry, error))
+			return 1;
+
+		// Write time is the last use, trim() deletes entries not used for the longest time
+		std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), error);
+
+		return CompressedTexture::load(entry, texture).empty() ? 0 : 1;
+	}
+
+	// Deletes the least recently used entries until cache fits MaxSize
+	inline void trim(const std::wstring& directory) {
+		struct File {
+			std::filesystem::path path;
+			std::filesystem::file_time_type time;
+			unsigned long long size;
+		};
+
+		std::vector<File> files;
+		unsigned long long total = 0;
+		std::error_code error;
+
+		for (auto& entry : std::filesystem::directory_iterator(directory, error)) {
+			if (!entry.is_regular_file(error))
+				continue;
+
+			File file { entry.path(), entry.last_write_time(error), entry.file_size(error) };
+			if (error)
+				continue;
+
+			files.push_back(file);
+			total += file.size;
+		}
+
+		if (total <= MaxSize)
+			return;
+
+		std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+
+		// Entries mapped by other instance fail to delete and stay
+		for (auto& file : files) {
+			if (total <= MaxSize)
+				break;
+
+			if (std::filesystem::remove(file.path, error))
+				total -= file.size;
+		}
+	}
+
+	inline void writeLE32(unsigned char* p, unsigned value) {
+		p[0] = value & 255;
+		p[1] = (value >> 8) & 255;
+		p[2] = (value >> 16) & 255;
+		p[3] = value >> 24;
+	}
+
+	// Writes levels of blocks (from the largest one) as DDS entry, file appears at once complete
+	// Returns 0 on success, 1 else
+	inline BOOL store(const std::wstring& entry, CompressedTexture::BlockFormat format, const std::vector<EncodedLevel>& levels) {
+		const unsigned DDSD_REQUIRED = 0x1 | 0x2 | 0x4 | 0x1000; // Caps, height, width, pixel format
+		const unsigned DDSD_LINEARSIZE = 0x80000;
+		const unsigned DDSD_MIPMAPCOUNT = 0x20000;
+		const unsigned DDPF_FOURCC = 0x4;
+		const unsigned DDSCAPS_TEXTURE = 0x1000;
+		const unsigned DDSCAPS_MIPMAP = 0x8 | 0x400000; // Complex, mipmap
+		const unsigned DXGI_FORMAT_BC7_UNORM = 98;
+
+		if (levels.empty())
+			return 1;
+
+		bool mipmapped = levels.size() > 1;
+
+		bool extended = format == CompressedTexture::BC7;
+		std::vector<unsigned char> header(extended ? 148 : 128, 0);
+
+		memcpy(&header[0], "DDS ", 4);
+		writeLE32(&header[4], 124);
+		writeLE32(&header[8], DDSD_REQUIRED | DDSD_LINEARSIZE | (mipmapped ? DDSD_MIPMAPCOUNT : 0));
+		writeLE32(&header[12], levels[0].height);
+		writeLE32(&header[16], levels[0].width);
+		writeLE32(&header[20], (unsigned) levels[0].blocks.size());
+		writeLE32(&header[28], (unsigned) levels.size());
+		writeLE32(&header[76], 32);
+		writeLE32(&header[80], DDPF_FOURCC);
+		memcpy(&header[84], extended ? "DX10" : "DXT1", 4);
+		writeLE32(&header[108], DDSCAPS_TEXTURE | (mipmapped ? DDSCAPS_MIPMAP : 0));
+
+		// Texture2D, single element
+		if (extended) {
+			writeLE32(&header[128], DXGI_FORMAT_BC7_UNORM);
+			writeLE32(&header[132], 3);
+			writeLE32(&header[140], 1);
+		}
+
+		// Other instance may write the same entry, each writes own temporary file
+		std::wstring temporary = entry + L"." + std::to_wstring(GetCurrentProcessId()) + L"." + std::to_wstring(GetCurrentThreadId()) + L".tmp";
+		std::error_code error;
+
+		{
+			std::ofstream file(temporary, std::ios::binary);
+			file.write((const char*) header.data(), header.size());
+			for (auto& level : levels)
+				file.write((const char*) level.blocks.data(), level.blocks.size());
+
+			if (!file) {
+				file.close();
+				std::filesystem::remove(temporary, error);
+				return 1;
+			}
+		}
+
+		std::filesystem::rename(temporary, entry, error);
+		if (error) {
+			std::filesystem::remove(temporary, error);
+			return 1;
+		}
+
+		trim(std::filesystem::path(entry).parent_path().wstring());
+		return 0;
+	}
+}
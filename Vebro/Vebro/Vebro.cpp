@@ -54,22 +54,54 @@ GLuint glSquareVAO;
 GLuint glSquareVBO;
 GLuint glSquareEBO;
 
+// Vertex array without attributes, vertex pass reads only gl_VertexID and gl_InstanceID
+GLuint glEmptyVAO;
+
 // Shaders (if exists)
 // Shader for texture copy
 GLuint glPassthroughShaderProgramID;
 
+// Compile-time constant of the shader, injected as "#define first second" right after #version line
+// Keeps json value it was parsed from, so saved pack has the same value types as loaded one
+struct ShaderDefine : std::pair<std::string, std::string> {
+	nlohmann::json value;
+
+	ShaderDefine(const std::string& name, const std::string& text, const nlohmann::json& value) : std::pair<std::string, std::string>(name, text), value(value) {}
+};
+
+// Order is preserved, value may be empty
+typedef std::vector<ShaderDefine> ShaderDefines;
+
+// Number of buffer passes and number of input channels of each pass
+// The first four buffers are Buffer A / B / C / D, the rest are named by pack (see "Buffers" section)
+// Storage of the buffer is allocated only once some pass uses it, so unused buffers cost nothing
+const int MaxBuffers = 16;
+const int MaxChannels = 8;
+
+// Number of render targets of single buffer pass, written as layout(location = k) out vec4
+const int MaxBufferOutputs = 4;
+
 // Main shader
 GLuint glMainShaderProgramID = -1;   // Main shader program ID
 std::wstring glMainShaderPath = L""; // Path to the main shader (For support reload button)
+ShaderDefines glMainShaderDefines;   // Defines of the main shader (From pack)
+std::vector<GLuint> glMainShaderVariants; // Main shader program for each quality level, glMainShaderProgramID is one of them
 
 // Value == -1 indicates that shader sould not be rendered
-GLuint glBufferShaderProgramIDs[4] = { -1, -1, -1, -1 };     // Buffer i shader program (A / B / C / D)
-std::wstring glBufferShaderPath[4] = { L"", L"", L"", L"" }; // Path to the Buffer i shader (For support reload button)
-int scBufferFrames[4] = { 0, 0, 0, 0 };                      // Frame number for each buffer shader (fictional, used only to prevent flickering and correctly save frame number on unload)
+// Arrays are filled with -1 by initSC()
+GLuint glBufferShaderProgramIDs[MaxBuffers];                 // Buffer i shader program (A / B / C / D / named)
+std::wstring glBufferShaderPath[MaxBuffers];                 // Path to the Buffer i shader (For support reload button)
+ShaderDefines glBufferShaderDefines[MaxBuffers];             // Defines of the Buffer i shader (From pack)
+std::vector<GLuint> glBufferShaderVariants[MaxBuffers];      // Buffer i shader program for each quality level
+int scBufferFrames[MaxBuffers];                              // Frame number for each buffer shader (fictional, used only to prevent flickering and correctly save frame number on unload)
+
+// Name of each buffer, used by inputs of the pack to refer the buffer
+// Buffer A / B / C / D are always named BufferA / BufferB / BufferC / BufferD, named buffers have empty name while unused
+std::wstring scBufferNames[MaxBuffers] = { L"BufferA", L"BufferB", L"BufferC", L"BufferD" };
 
 // Framebuffers for these shaders
 // 2 Framebuffers for each single buffer to enable multipass
-GLuint glBufferShaderFramebuffers[2][4];
+GLuint glBufferShaderFramebuffers[2][MaxBuffers];
 
 // Textures to render in.
 //  This textures will exist till the end of the program because they 
@@ -77,17 +109,160 @@ GLuint glBufferShaderFramebuffers[2][4];
 //   and can be used as input even if shader for this buffer (A / B / C / D) 
 //   was removed.
 // 2 Textures for each single buffer to enable multipass
-GLuint glBufferShaderFramebufferTextures[2][4];
+GLuint glBufferShaderFramebufferTextures[2][MaxBuffers];
+
+// Textures of additional outputs (location 1, 2, ...) of the buffer, attached to the same framebuffers
+// Only the first glBufferShaderOutputs[i] - 1 of them have storage, see getBufferTexture()
+GLuint glBufferShaderOutputTextures[2][MaxBuffers][MaxBufferOutputs - 1];
+
+// Number of outputs of buffer declared by "outputs" key of buffer section, changed only with setBufferOutputs()
+int glBufferShaderOutputs[MaxBuffers];
+
+// Shader stage of the buffer pass, GL_FRAGMENT_SHADER or GL_COMPUTE_SHADER (declared by "compute" key of buffer section)
+// Compute pass writes outputs as image units 0, 1, ... instead of drawing full-screen quad
+// GL_GEOMETRY_SHADER is cubemap pass (declared by "cubemap" key), fragment shader is drawn into all six faces at once
+//  by built-in geometry shader, see compileShader()
+// GL_VERTEX_SHADER is vertex pass (declared by "vertices" key), pack shader is vertex shader drawn as instanced primitives
+//  without vertex buffers, built-in fragment shader writes it's color
+GLenum glBufferShaderStages[MaxBuffers];
+
+// Primitives drawn by vertex pass, declared by "primitive" key of buffer section
+struct VertexPrimitive {
+	const char* name;
+	GLenum mode;
+};
+
+const VertexPrimitive VertexPrimitives[] = {
+	{ "points",         GL_POINTS },
+	{ "lines",          GL_LINES },
+	{ "line_strip",     GL_LINE_STRIP },
+	{ "line_loop",      GL_LINE_LOOP },
+	{ "triangles",      GL_TRIANGLES },
+	{ "triangle_strip", GL_TRIANGLE_STRIP },
+	{ "triangle_fan",   GL_TRIANGLE_FAN }
+};
+
+const int VertexPrimitiveCount = sizeof(VertexPrimitives) / sizeof(VertexPrimitives[0]);
+
+// Blending of vertex pass primitives, declared by "blend" key of buffer section
+// Alpha is the same blending other passes have
+struct BlendMode {
+	const char* name;
+	BOOL enabled;
+	GLenum source;
+	GLenum destination;
+};
+
+const BlendMode BlendModes[] = {
+	{ "alpha",    TRUE,  GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA },
+	{ "additive", TRUE,  GL_ONE,       GL_ONE },
+	{ "none",     FALSE, GL_ONE,       GL_ZERO }
+};
+
+const int BlendModeCount = sizeof(BlendModes) / sizeof(BlendModes[0]);
+
+// Vertex pass draws glBufferShaderInstanceCounts[i] instances of glBufferShaderVertexCounts[i] vertices each
+// Indices of VertexPrimitives and BlendModes entries, 0 for other passes
+int glBufferShaderVertexCounts[MaxBuffers];
+int glBufferShaderInstanceCounts[MaxBuffers];
+int glBufferShaderPrimitives[MaxBuffers];
+int glBufferShaderBlends[MaxBuffers];
+
+// Cube textures of cubemap passes, attached as layered output 0 instead of glBufferShaderFramebufferTextures
+GLuint glBufferShaderCubeTextures[2][MaxBuffers];
+
+// Size of cubemap face unless buffer declares fixed size, scaled by "scale" key
+const int DefaultCubemapSize = 1024;
+
+// Workgroup grid of compute pass declared by "groups" key, { 0, 0, 0 } covers buffer size with workgroups of the shader
+int glBufferShaderComputeGroups[MaxBuffers][3];
+
+// Workgroup size declared by current program of compute pass, read once program is selected
+GLint glBufferShaderLocalSizes[MaxBuffers][3];
+
+// Shader storage buffer of compute pass declared by "storage" key (in bytes), bound to binding point equal to buffer index
+// Storage is not swapped between frames, 0 if buffer has no storage
+GLuint glBufferShaderStorage[MaxBuffers];
+GLsizeiptr glBufferShaderStorageSizes[MaxBuffers];
+
+// Render target formats available to buffers, declared by "format" key of buffer section
+struct BufferFormat {
+	const char* name;
+	GLenum internalFormat;
+	GLenum format;
+	GLenum type;
+};
+
+const BufferFormat BufferFormats[] = {
+	{ "RGBA32F",        GL_RGBA32F,        GL_RGBA, GL_FLOAT },
+	{ "RGBA16F",        GL_RGBA16F,        GL_RGBA, GL_HALF_FLOAT },
+	{ "RGBA8",          GL_RGBA8,          GL_RGBA, GL_UNSIGNED_BYTE },
+	{ "RGB10_A2",       GL_RGB10_A2,       GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV },
+	{ "R11F_G11F_B10F", GL_R11F_G11F_B10F, GL_RGB,  GL_UNSIGNED_INT_10F_11F_11F_REV },
+	{ "RG32F",          GL_RG32F,          GL_RG,   GL_FLOAT },
+	{ "RG16F",          GL_RG16F,          GL_RG,   GL_HALF_FLOAT },
+	{ "RG8",            GL_RG8,            GL_RG,   GL_UNSIGNED_BYTE },
+	{ "R32F",           GL_R32F,           GL_RED,  GL_FLOAT },
+	{ "R16F",           GL_R16F,           GL_RED,  GL_HALF_FLOAT },
+	{ "R8",             GL_R8,             GL_RED,  GL_UNSIGNED_BYTE }
+};
+
+const int BufferFormatCount = sizeof(BufferFormats) / sizeof(BufferFormats[0]);
+
+// Float buffers as shadertoy has
+const int DefaultBufferFormat = 0;
+
+// Index of BufferFormats entry for each buffer, changed only with setBufferFormat()
+int glBufferShaderFormats[MaxBuffers];
+
+// Size of buffer relative to window, declared by "scale" key of buffer section, changed only with setBufferSize()
+float glBufferShaderScales[MaxBuffers];
+
+// Fixed size of buffer declared by "size" key of buffer section, { 0, 0 } if buffer follows window size
+int glBufferShaderFixedSizes[MaxBuffers][2];
+
+// Actual size of buffer textures, viewport and iResolution of the pass and iChannelResolution of the buffer input
+// Size is 0 while buffer storage is not allocated
+int glBufferShaderWidths[MaxBuffers];
+int glBufferShaderHeights[MaxBuffers];
+
+// Indicates if buffer texture has mip chain of it's current contents
+// Chain is generated right after the pass wrote the texture and is lost on clear and resize
+BOOL glBufferShaderFramebufferMipmaps[2][MaxBuffers];
+
+// Indicates if buffer[i] is sampled with mipmap filter by some live channel, computed by updateRenderGraph()
+BOOL glBufferShaderMipmapped[MaxBuffers];
 
 // Indicates if buffer[i] should be rendered
-// Changed view resource control
+// Computed by updateRenderGraph(), buffer is rendered only if it is reachable from Main shader through live channels
 // Render requires (glBufferShaderShouldBeRendered[i] && glBufferShaderProgramIDs[i] != -1)
 //  to be true in order to render the shader because shader can be 
 //  loaded but not rendered (in this case it is only compiled and not used) or 
 //  rendered but not loaded (in this case buffer texture of shader is rendered, but code is not compiled).
 // Shader code can be unloaded by Remove button in menu.
 // Shader as input can be disabled by removing it manually from inputs.
-BOOL glBufferShaderShouldBeRendered[4] = { FALSE, FALSE, FALSE, FALSE };
+BOOL glBufferShaderShouldBeRendered[MaxBuffers];
+
+// Buffers rendered in each frame (in order of index), computed by updateRenderGraph()
+// Frame walks only this list, so cost of the frame does not depend on MaxBuffers
+std::vector<int> glBufferRenderList;
+
+// Bit mask of iChannelN samplers actually used by current program of the pass
+// Dead channels are not bound and do not pull their buffers into the render graph
+int glMainShaderLiveChannels = 0;
+int glBufferShaderLiveChannels[MaxBuffers];
+
+// Bit masks of iChannelN samplers declared as samplerCube and sampler3D, shader is recompiled by updateRenderGraph() once bound inputs change them
+int glMainShaderCubeChannels = 0;
+int glBufferShaderCubeChannels[MaxBuffers];
+int glMainShaderVolumeChannels = 0;
+int glBufferShaderVolumeChannels[MaxBuffers];
+
+// Set when shaders or inputs change, render graph is rebuilt before the next frame
+BOOL scRenderGraphDirty = TRUE;
+
+// Set while pack is parsed, shaders only keep their paths and are compiled once all inputs are known
+BOOL scShaderCompilationDeferred = FALSE;
 
 
 // >> Scene related
@@ -103,11 +278,87 @@ int    scMinFrameTime   = 1000 / 30;   // Holds minimal frame time in ms (1000 /
 int    scFPSMode        = 30;          // Just defines the FPS used
 BOOL   scSoundEnabled   = FALSE;       // Indicates if sound capture enabled / disabled. Used to force disable sound capture if shader uses audio input
 std::wstring scPackPath = L"";         // Defines full path for pack locations
+BOOL   scTexturePadding = FALSE;       // Indicates if still images are padded to power of two size (legacy packs)
+
+
+// >> Simulation related
+// Pack may declare fixed rate of buffers, then buffers are rendered as many steps as time passed since the
+//  previous frame (but at most scSimulationMaxSteps) with constant iTimeDelta, and Main shader shows the latest step.
+// Simulation speed does not depend on scFPSMode then.
+double scSimulationRate        = 0.0;          // Buffer steps per second, 0 if buffers are rendered once per frame
+int    scSimulationMaxSteps    = 4;            // Limit of steps per frame, time above the limit is dropped
+double scSimulationAccumulator = 0.0;          // Time not simulated yet
+double scSimulationTime        = 0.0;          // iTime of buffers
+int    scSimulationFrame       = 0;            // iFrame of buffers
+int    scSimulationSteps[4]    = { 1, 1, 1, 1 }; // Steps rendered in each frame of PassTimerLatency, scales buffer pass timers
 
 // ID's for all shader inputs
 // Should only be changed via special functions to correctly process GC
-int scMainShaderInputs[4] = { -1, -1, -1, -1 };
-int scBufferShaderInputs[4][4] = { { -1, -1, -1, -1 }, { -1, -1, -1, -1 }, { -1, -1, -1, -1 }, { -1, -1, -1, -1 } };
+// Arrays are filled with -1 by initSC()
+int scMainShaderInputs[MaxChannels];
+int scBufferShaderInputs[MaxBuffers][MaxChannels];
+
+
+// >> Quality related
+// Quality levels are declared by pack, ordered from the lowest to the highest quality.
+// Each shader is compiled for every level ahead of time, governor switches between compiled
+//  variants to hold frame time within budget of scFPSMode.
+std::vector<ShaderDefines> scQualityLevels;     // Defines of each quality level (empty if pack has no levels)
+int    scQualityLevel           = -1;           // Current quality level index
+int    scQualityInitialLevel    = -1;           // Level declared by "initial" of pack (-1 if not declared)
+BOOL   scQualityGovernorEnabled = TRUE;         // Indicates if quality level is selected automatically
+double scQualityFrameTime       = 0.0;          // Smoothed frame time (ms) used by governor
+int    scQualityOverBudget      = 0;            // Number of sequential frames over the budget
+int    scQualityUnderBudget     = 0;            // Number of sequential frames well under the budget
+int    scQualitySettleFrames    = 0;            // Number of frames to ignore after level switch (measurements lag behind)
+int    scQualityUpgradeBackoff  = 1;            // Multiplier of frames required to try higher level after the downgrade
+
+
+// >> Timing related
+// GPU time of each pass is measured with GL_TIME_ELAPSED queries.
+// Results are read back PassTimerLatency frames later to never stall the pipeline.
+const int PassTimerLatency = 4;                 // Number of frames in flight for timer queries
+const int PassTimerCount   = MaxBuffers + 1;    // Buffers and Main
+const int PassTimerMain    = MaxBuffers;        // Index of the Main pass timer
+GLuint glPassTimerQueries[PassTimerLatency][PassTimerCount];
+BOOL   glPassTimerIssued[PassTimerLatency][PassTimerCount];
+double scPassGPUTime[PassTimerCount];           // Smoothed GPU time of each pass (ms)
+double scFrameGPUTime = 0.0;                    // Smoothed GPU time of the frame (ms)
+double scFrameCPUTime = 0.0;                    // Smoothed CPU time of the frame (ms)
+
+
+// >> Sound related
+// Pack may declare Sound shader (shadertoy mainSound). It is rendered ahead of playback into float texture, one block
+//  of samples per draw, each texel holds left and right sample. Blocks are read back through pixel buffers and copied
+//  into sample ring only once their fences are signalled, so render thread never waits for GPU.
+// Render thread keeps SoundLookaheadBlocks blocks queued (~0.5 s), slow frame is covered by queued samples.
+const int SoundBlockWidth      = 512;
+const int SoundBlockHeight     = 8;
+const int SoundBlockFrames     = SoundBlockWidth * SoundBlockHeight; // Stereo frames in block (~93 ms)
+const int SoundReadbacks       = 4;  // Number of blocks read back at the same time
+const int SoundLookaheadBlocks = 6;  // Number of blocks queued ahead of playback (in ring and in flight)
+const int SoundBlocksPerFrame  = 2;  // Limit of blocks rendered in single frame, spreads initial fill over frames
+
+GLuint glSoundShaderProgramID = -1;        // Sound shader program ID
+std::wstring glSoundShaderPath = L"";      // Path to the sound shader (For support reload button)
+ShaderDefines glSoundShaderDefines;        // Defines of the sound shader (From pack)
+std::vector<GLuint> glSoundShaderVariants; // Sound shader program for each quality level
+
+GLuint glSoundFramebuffer = 0;
+GLuint glSoundTexture = 0;
+GLuint glSoundReadbackBuffers[SoundReadbacks];
+GLsync glSoundReadbackFences[SoundReadbacks];
+int    scSoundReadbackHead  = 0;           // Slot of the oldest block in flight, blocks complete in order
+int    scSoundReadbackCount = 0;           // Number of blocks in flight
+int    scSoundBlock         = 0;           // Index of the next block to render, sample offset is scSoundBlock * SoundBlockFrames
+
+SoundOutput::SampleRing* scSoundRing = nullptr;
+SoundOutput::Sink*       scSoundSink = nullptr;
+
+// Samples are written into WAV file instead of playback device (--sound-wav), application exits once file is complete
+std::wstring scSoundWavPath    = L"";
+double       scSoundWavSeconds = 0.0;
+BOOL         scSoundWavDone    = FALSE;
 
 
 // >> Threading related
@@ -121,11 +372,10 @@ BOOL         appLockRequested = FALSE; // indicates if main thread wants to acqu
 // Resource type
 // Buffer : id (A / B / C / D)
 // Image : path, GLuint bind (image texture)
-// Video : path, GLuint bind (current frame as texture), specific media data
-// Audio : path, GLuint bind (current FFT as texture), specific media data
+// Video : path, GLuint bind (current frame as texture), video stream with pixel buffers
+// Audio : path, GLuint bind (current FFT as texture), audio stream
 // Webcam : GLuint bind (current frame as texture)
 // Microphone : GLuint (current FFT as texture)
-// TODO: Cubemap input
 enum ResourceType {
 	IMAGE_TEXTURE,    // Simple image as input
 	AUDIO_TEXTURE,    // Audio file as input
@@ -133,7 +383,49 @@ enum ResourceType {
 	MIC_TEXTURE,      // Microphone as inout
 	WEB_TEXTURE,      // Webcam as input
 	KEYBOARD_TEXTURE, // Keyboard key states as input
-	FRAME_BUFFER      // Buffer A / B / C / D as input
+	FRAME_BUFFER,     // Buffer A / B / C / D as input
+	CUBEMAP_TEXTURE,  // Six images (or cross image) as cube texture input
+	VOLUME_TEXTURE    // Memory mapped volume file as 3D texture input
+};
+
+// Video input state
+// Frames are uploaded through pixel buffer per stream slot. With ARB_buffer_storage buffers are persistently mapped and
+//  decode thread writes frames right into them, slot is returned to decode thread when fence of its upload is signalled.
+// Without it, frame is copied into orphaned streaming buffer and slot is returned immediately.
+struct VideoInput {
+	VideoTexture::FileStream stream;
+
+	BOOL   persistent = FALSE;
+	GLuint buffers[VideoTexture::RingSize] = {};
+	GLsync fences[VideoTexture::RingSize] = {};
+};
+
+// Image decoding and animation state
+// All frames of animated image are stored in texture array, displayed frame is copied into texture bound to channels
+struct ImageInput {
+	ImageTexture::Loader loader;
+
+	// Set once decoding finished (successfully or not)
+	BOOL   ready = FALSE;
+	GLuint array = 0;
+
+	// Frame currently copied into channel texture
+	int    frame = -1;
+
+	// Read / draw framebuffers used for layer copy
+	GLuint framebuffers[2] = {};
+};
+
+// Cubemap input state
+// Faces are decoded on worker threads at once, six files (+X, -X, +Y, -Y, +Z, -Z) or single horizontal cross image
+struct CubemapInput {
+	ImageTexture::Loader loaders[6];
+
+	// Amount of decoded files, 1 for cross image
+	int files = 0;
+
+	// Set once decoding finished (successfully or not)
+	BOOL ready = FALSE;
 };
 
 // Resource unit
@@ -148,31 +440,134 @@ struct SCResource {
 	// Bind for texture (id exists for this unit)
 	GLuint bind = 0;
 
-	// ID number of buffer (only for buffer input)
+	// ID number of buffer and index of it's output (only for buffer input)
 	int buffer_id = 0;
+	int output = 0;
 
 	// Absolute path of resource (used to determine duplications)
+	// Cubemap of six files keeps their paths separated with '|', see splitCubemapPath()
 	std::wstring path;
 
-	// Dimensions
+	// Image rows go from the bottom as shadertoy shows them and full mip chain is built (only for image input)
+	// Both are baked into texture, so inputs with different values get separate resources
+	BOOL vflip = TRUE;
+	BOOL mipmaps = FALSE;
+
+	// Mip levels stored in pre-compressed file, set once uploaded (only for image input)
+	int levels = 1;
+
+	// Dimensions, depth only for volume input
 	int width;
 	int height;
+	int depth = 0;
+
+	// Layout of raw volume file, empty for BIN file (only for volume input)
+	VolumeTexture::Layout volume;
+
+	// Decoding and animation state (only for image input), owned by resource table
+	ImageInput* image = nullptr;
+
+	// Audio stream (only for audio and microphone input), owned by resource table
+	AudioTexture::Stream* audio = nullptr;
+
+	// Video stream and upload state (only for video input), owned by resource table
+	VideoInput* video = nullptr;
+
+	// Key states and event source (only for keyboard input), owned by resource table
+	KeyboardTexture::Keyboard* keyboard = nullptr;
+
+	// Decoding state (only for cubemap input), owned by resource table
+	CubemapInput* cubemap = nullptr;
+
+	// Playback time (in seconds) and sample rate of the last uploaded frame (only for media inputs)
+	double time = 0.0;
+	int sampleRate = 0;
 };
 
 // Returns short description of the resource state
 std::wstring resourceToShordDescription(SCResource& res) {
 	switch (res.type) {
 		case IMAGE_TEXTURE: return std::wstring(L"Image [") + std::wstring(res.path.begin(), res.path.end()) + L"]";
-		case AUDIO_TEXTURE: return L"Audio";
-		case VIDEO_TEXTURE: return L"Video";
-		case MIC_TEXTURE: return L"Microphone";
+		case AUDIO_TEXTURE: return std::wstring(L"Audio [") + res.path + L"]";
+		case VIDEO_TEXTURE: return std::wstring(L"Video [") + res.path + L"]";
+		case MIC_TEXTURE: return res.path.empty() ? L"Microphone" : std::wstring(L"Microphone [") + res.path + L"]";
 		case WEB_TEXTURE: return L"Webcam";
-		case KEYBOARD_TEXTURE: return L"Keyboard";
-		case FRAME_BUFFER: return std::wstring(L"Buffer ") + L"ABCD"[res.buffer_id];
+		case KEYBOARD_TEXTURE: return res.path.empty() ? L"Keyboard" : std::wstring(L"Keyboard [") + res.path + L"]";
+		case CUBEMAP_TEXTURE: return std::wstring(L"Cubemap [") + res.path + L"]";
+		case VOLUME_TEXTURE: return std::wstring(L"Volume [") + res.path + L"]";
+		case FRAME_BUFFER: return (res.buffer_id < 4 ? std::wstring(L"Buffer ") + L"ABCD"[res.buffer_id] : std::wstring(L"Buffer [") + scBufferNames[res.buffer_id] + L"]") + (res.output ? L" output " + std::to_wstring(res.output) : L"");
 		default: return L"";
 	}
 }
 
+// Sampling of input channel, declared by pack for each input
+// Channel without declared filter and wrap samples with texture own parameters, which depend on input type
+enum InputFilter {
+	DEFAULT_FILTER = -1,
+	NEAREST_FILTER,
+	LINEAR_FILTER,
+	MIPMAP_FILTER
+};
+
+enum InputWrap {
+	DEFAULT_WRAP = -1,
+	REPEAT_WRAP,
+	CLAMP_WRAP,
+	MIRROR_WRAP
+};
+
+struct InputSampler {
+	InputFilter filter = DEFAULT_FILTER;
+	InputWrap wrap = DEFAULT_WRAP;
+};
+
+// Sampler of each input of main shader and buffers, set together with inputs
+InputSampler scMainShaderSamplers[MaxChannels];
+InputSampler scBufferShaderSamplers[MaxBuffers][MaxChannels];
+
+// Sampler object for each filter and wrap, created once
+GLuint glInputSamplers[3][3];
+
+// Filter and wrap of texture created for input type, textures with mip chain are created with mipmap filter
+void getDefaultSampling(ResourceType type, BOOL mipmaps, InputFilter& filter, InputWrap& wrap) {
+	InputFilter smooth = mipmaps ? MIPMAP_FILTER : LINEAR_FILTER;
+
+	switch (type) {
+		case IMAGE_TEXTURE:    filter = smooth;         wrap = REPEAT_WRAP; return;
+		case CUBEMAP_TEXTURE:  filter = smooth;         wrap = CLAMP_WRAP;  return;
+		case VOLUME_TEXTURE:   filter = smooth;         wrap = REPEAT_WRAP; return;
+		case FRAME_BUFFER:     filter = NEAREST_FILTER; wrap = REPEAT_WRAP; return;
+		case KEYBOARD_TEXTURE: filter = NEAREST_FILTER; wrap = CLAMP_WRAP;  return;
+		default:               filter = LINEAR_FILTER;  wrap = CLAMP_WRAP;  return;
+	}
+}
+
+// Binds sampler object of the channel to texture unit, channel without declared sampling keeps texture parameters
+void bindInputSampler(GLuint unit, const SCResource& res, const InputSampler& sampler) {
+	if (sampler.filter == DEFAULT_FILTER && sampler.wrap == DEFAULT_WRAP) {
+		glBindSampler(unit, 0);
+		return;
+	}
+
+	// Texture without mip chain would be incomplete, buffer has the chain once written by it's pass
+	// Pre-compressed image brings it's own chain
+	BOOL mipmaps = res.type == FRAME_BUFFER ? glBufferShaderFramebufferMipmaps[scBufferFrames[res.buffer_id] & 1][res.buffer_id] : res.mipmaps || res.levels > 1;
+
+	InputFilter filter;
+	InputWrap wrap;
+	getDefaultSampling(res.type, mipmaps, filter, wrap);
+
+	if (sampler.filter != DEFAULT_FILTER)
+		filter = sampler.filter;
+	if (sampler.wrap != DEFAULT_WRAP)
+		wrap = sampler.wrap;
+
+	if (filter == MIPMAP_FILTER && !mipmaps)
+		filter = LINEAR_FILTER;
+
+	glBindSampler(unit, glInputSamplers[filter][wrap]);
+}
+
 // Resource storage table (used to prevent reduplications of loading and processing)
 // Storas static fixed amount of resources matching the total amount of inputs for all shaders
 // Allows deletion of any element and insertion into any free cell
@@ -181,8 +576,8 @@ struct ResourceTableEntry {
 	SCResource resource;
 };
 
-// 4 main inputs + 4 buffers * 4 inputs
-const int ResourceTableSize = 4 + 4 * 4;
+// Main inputs + inputs of each buffer
+const int ResourceTableSize = MaxChannels + MaxBuffers * MaxChannels;
 
 ResourceTableEntry scResources[ResourceTableSize];
 
@@ -195,7 +590,7 @@ int findResource(SCResource res) {
 		if (res.type == scResources[i].resource.type) {
 			switch (res.type) {
 				case IMAGE_TEXTURE: {
-					if (res.path == scResources[i].resource.path)
+					if (res.path == scResources[i].resource.path && res.vflip == scResources[i].resource.vflip && res.mipmaps == scResources[i].resource.mipmaps)
 						return i;
 					return -1;
 				}
@@ -212,13 +607,40 @@ int findResource(SCResource res) {
 					return -1;
 				}
 
-				case MIC_TEXTURE:
+				case CUBEMAP_TEXTURE: {
+					if (res.path == scResources[i].resource.path && res.mipmaps == scResources[i].resource.mipmaps)
+						return i;
+					return -1;
+				}
+
+				case VOLUME_TEXTURE: {
+					if (res.path == scResources[i].resource.path && res.volume == scResources[i].resource.volume && res.mipmaps == scResources[i].resource.mipmaps)
+						return i;
+					return -1;
+				}
+
+				// Single live keyboard is shared, scripts are matched by path
+				// Keep scanning, the live keyboard may follow other keyboard entries
+				case KEYBOARD_TEXTURE: {
+					if (res.path == scResources[i].resource.path)
+						return i;
+					continue;
+				}
+
+				// Single capture device is shared, replays are matched by path
+				// Keep scanning, the live capture may follow replay entries
+				case MIC_TEXTURE: {
+					if (res.path == scResources[i].resource.path)
+						return i;
+					continue;
+				}
+
 				case WEB_TEXTURE: {
 					return -1;
 				}
 
 				case FRAME_BUFFER: {
-					if (res.buffer_id == scResources[i].resource.buffer_id)
+					if (res.buffer_id == scResources[i].resource.buffer_id && res.output == scResources[i].resource.output)
 						return i;
 					return -1;
 				}
@@ -229,943 +651,3869 @@ int findResource(SCResource res) {
 	return -1;
 }
 
-// Load and initialize the desired resource
-// Returns ResourceID as index in scResources or -1
-int loadResource(SCResource res) {
+// Format of texture cache entries the video driver can sample, cache is disabled without one
+TextureCache::Settings getTextureCacheSettings(const SCResource& res) {
+	TextureCache::Settings settings;
 
-	int resID = findResource(res);
+	if (GLEW_ARB_texture_compression_bptc)
+		settings.format = CompressedTexture::BC7;
+	else if (GLEW_EXT_texture_compression_s3tc)
+		settings.format = CompressedTexture::BC1_RGBA;
 
-	if (resID != -1) {
-		++scResources[resID].resource.refs;
-		return resID;
+	settings.powerOfTwo = scTexturePadding;
+	settings.vflip = res.vflip;
+	settings.mipmaps = res.mipmaps;
+
+	return settings;
+}
+
+// Starts decoding image of the resource on worker thread and creates placeholder texture
+// Texture is filled by updateImageInput() once decoded
+// Returns 0 on success, 1 else
+BOOL createImageInput(SCResource& res) {
+	ImageTexture::Format format = ImageTexture::detectFormat(res.path);
+
+	if (format == ImageTexture::UNKNOWN_FORMAT) {
+		std::wcout << "Image resource load error: Unsupported or missing image file [" << res.path << ']' << std::endl;
+		MessageBoxA(
+			NULL,
+			"Unsupported or missing image file",
+			"Image load error",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
 	}
 
-	// Called once when initially loading resource:
-	switch (res.type) {
-		case IMAGE_TEXTURE: {
-			res.refs = 1;
+	std::wcout << "Loading resource for Texture [" << res.path << ']' << std::endl;
+
+	res.image = new ImageInput();
+	res.image->loader.start(res.path, format, getTextureCacheSettings(res));
+
+	res.width = 0;
+	res.height = 0;
+	res.time = 0.0;
+
+	// Transparent placeholder until decoded
+	unsigned char transparent[4] = { 0, 0, 0, 0 };
 
-			std::vector<unsigned char> image;
-			unsigned width, height;
+	glGenTextures(1, &res.bind);
+	glBindTexture(GL_TEXTURE_2D, res.bind);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+	glBindTexture(GL_TEXTURE_2D, 0);
 
-			// Convert path to char*
-			// Google says that MAX_PATH is 260, but i'm not sure, lol
-			// <strike>
-			// idfk why it is STILL can not be done in one line
-			// using convert_type = std::codecvt_utf8<wchar_t>;
-			// std::wstring_convert<convert_type, wchar_t> converter;
-			// std::string stringPath = converter.to_bytes(res.path);
-			// </strike>
-			// Updated after 15 seconds:
-			// https://stackoverflow.com/a/18374698
-			std::string stringPath = std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(res.path);
+	return 0;
+}
 
-			unsigned error = lodepng::decode(image, width, height, stringPath);
+// GL formats of decoded image, keeping channels and bit depth of the file
+// Gray images are swizzled to read as gray RGB the same as RGBA decoding gives
+void getImageFormat(const ImageTexture::Animation& image, GLenum& internalFormat, GLenum& format, GLenum& type, const GLint*& swizzle) {
+	static const GLenum formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	static const GLenum internalFormats[2][4] = {
+		{ GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 },
+		{ GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 }
+	};
+	static const GLint swizzles[4][4] = {
+		{ GL_RED, GL_RED, GL_RED, GL_ONE },
+		{ GL_RED, GL_RED, GL_RED, GL_GREEN },
+		{ GL_RED, GL_GREEN, GL_BLUE, GL_ONE },
+		{ GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA }
+	};
 
-			std::wcout << "Loading resource for Texture [" << res.path << "] (" << width << ", " << height << ')' << std::endl;
+	int channels = image.channels - 1;
+	int wide = image.bitDepth == 16 ? 1 : 0;
 
-			if (error != 0) {
+	internalFormat = internalFormats[wide][channels];
+	format = formats[channels];
+	type = wide ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+	swizzle = swizzles[channels];
+}
 
-				std::wcout << "Image resource load error: " << lodepng_error_text(error) << std::endl;
-				MessageBoxA(
-					NULL,
-					lodepng_error_text(error),
-					"Image load error",
-					MB_ICONERROR | MB_OK
-				);
+// Uploads decoded still image into channel texture
+// Image keeps channels and bit depth of the file, gray images are swizzled to read as gray RGB the same as RGBA decoding gives
+// Image is uploaded with it's own size, legacy packs pad it with transparent pixels to power of two size
+// Rows in reverse order are uploaded as is and flipped on GPU by the copy, there is no CPU copy of the image
+void uploadStillImage(SCResource& res, ImageTexture::Animation& image) {
 
-				return -1;
-			}
+	size_t width = image.width;
+	size_t height = image.height;
+	size_t pixelSize = image.getPixelSize();
 
-			// Flip image vertically
-			for (size_t y = 0; y < height / 2; y++)
-				for (size_t x = 0; x < width; x++)
-					for (size_t c = 0; c < 4; c++)
-						std::swap(image[4 * width * y + 4 * x + c], image[4 * width * (height - y - 1) + 4 * x + c]);
+	// Shown image has the bottom row first
+	bool flip = image.topDown == (res.vflip == TRUE);
 
-			// Find closest power of two
-			size_t u2 = 1; while (u2 < width) u2 *= 2;
-			size_t v2 = 1; while (v2 < height) v2 *= 2;
+	if (scTexturePadding) {
 
-			res.width = u2;
-			res.height = v2;
+		// Find closest power of two
+		size_t u2 = 1; while (u2 < width) u2 *= 2;
+		size_t v2 = 1; while (v2 < height) v2 *= 2;
 
-			if (u2 != width)
-				std::wcout << "Texture warning: width must be power of two, got " << width << ", resizing to closest " << u2 << std::endl;
-			if (v2 != height)
-				std::wcout << "Texture warning: height must be power of two, got " << height << ", resizing to closest " << v2 << std::endl;
-			
-			// To size of two conversion ratio
-			double u3 = (double) width / u2;
-			double v3 = (double) height / v2;
+		if (u2 != width)
+			std::wcout << "Texture warning: width must be power of two, got " << width << ", resizing to closest " << u2 << std::endl;
+		if (v2 != height)
+			std::wcout << "Texture warning: height must be power of two, got " << height << ", resizing to closest " << v2 << std::endl;
+
+		// Resize texture to power of two, image stays in the lower left corner after flip
+		if (u2 != width || v2 != height) {
+			size_t offset = flip ? v2 - height : 0;
 
-			// Resize texture to power of two
-			std::vector<unsigned char> image2(u2 * v2 * 4);
+			std::vector<unsigned char> image2(u2 * v2 * pixelSize);
 			for (size_t y = 0; y < height; y++)
-				for (size_t x = 0; x < width; x++)
-					for (size_t c = 0; c < 4; c++) 
-						image2[4 * u2 * y + 4 * x + c] = image[4 * width * y + 4 * x + c];
+				memcpy(&image2[pixelSize * u2 * (y + offset)], &image.pixels[pixelSize * width * y], pixelSize * width);
 
-			// Generate texture & pass pixeldata
-			glGenTextures(1, &res.bind);
-			glBindTexture(GL_TEXTURE_2D, res.bind);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			glTexImage2D(GL_TEXTURE_2D, 0, 4, u2, v2, 0, GL_RGBA, GL_UNSIGNED_BYTE, &image2[0]);
-			glBindTexture(GL_TEXTURE_2D, 0);
+			image.pixels.swap(image2);
+			width = u2;
+			height = v2;
+		}
+	}
 
-			std::wcout << "Inserting resource for Texture [" << res.path << ']' << std::endl;
+	res.width = width;
+	res.height = height;
 
-			// Insert into first free cell
-			for (int i = 0; i < ResourceTableSize; ++i)
-				if (scResources[i].empty) {
-					scResources[i].empty = FALSE;
-					scResources[i].resource = res;
-					return i;
-				}
+	GLenum internalFormat, format, type;
+	const GLint* swizzle;
+	getImageFormat(image, internalFormat, format, type, swizzle);
 
-			std::wcout << "Can not insert Texture resource, resource table is corrupted" << std::endl;
-			glDeleteTextures(1, &res.bind);
+	// RGB formats are not required to be renderable, flipped image is copied through framebuffers
+	if (flip && internalFormat == GL_RGB8)
+		internalFormat = GL_RGBA8;
+	else if (flip && internalFormat == GL_RGB16)
+		internalFormat = GL_RGBA16;
 
-			return -1;
-		}
+	glBindTexture(GL_TEXTURE_2D, res.bind);
+	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
 
-		case AUDIO_TEXTURE: { // TODO: Load media resources
-			std::wcout << "Load Resource :: Incomplete :: Audio" << std::endl;
-			return -1;
-		}
+	// Rows of 1-3 channel images and NPOT images are not aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-		case VIDEO_TEXTURE: {
-			std::wcout << "Load Resource :: Incomplete :: Video" << std::endl;
-			return -1;
-		}
+	if (flip) {
+		GLuint source;
+		GLuint framebuffers[2];
 
-		case MIC_TEXTURE: {
-			std::wcout << "Load Resource :: Incomplete :: Microphone" << std::endl;
-			return -1;
-		}
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
 
-		case WEB_TEXTURE: {
-			std::wcout << "Load Resource :: Incomplete :: Webcam" << std::endl;
-			return -1;
-		}
+		glGenTextures(1, &source);
+		glBindTexture(GL_TEXTURE_2D, source);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, image.pixels.data());
 
-		case KEYBOARD_TEXTURE: {
-			std::wcout << "Load Resource :: Incomplete :: Keyboard" << std::endl;
-			return -1;
-		}
+		glGenFramebuffers(2, framebuffers);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, res.bind, 0);
 
-		case FRAME_BUFFER: {
-			res.refs = 1;
+		glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-			// TODO: TRUE this frag only if the shader is used in chain of rendering main shader
-			glBufferShaderShouldBeRendered[res.buffer_id] = TRUE;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(2, framebuffers);
+		glDeleteTextures(1, &source);
 
-			std::wcout << "Inserting resource for Buffer " << res.buffer_id << std::endl;
+		glBindTexture(GL_TEXTURE_2D, res.bind);
+	} else
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, image.pixels.data());
 
-			// Insert into first free cell
-			for (int i = 0; i < ResourceTableSize; ++i)
-				if (scResources[i].empty) {
-					scResources[i].empty = FALSE;
-					scResources[i].resource = res;
-					return i;
-				}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-			std::wcout << "Can not insert Buffer " << ("ABCD"[res.buffer_id]) << " resource, resource table is corrupted" << std::endl;
-			return -1;
-		}
+	if (res.mipmaps) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glGenerateMipmap(GL_TEXTURE_2D);
 	}
 
-	return -1;
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// Next load maps compressed blocks of exactly this texture, pixels are released
+	res.image->loader.cache(width, height, image.channels, image.bitDepth, flip, image.pixels);
+	std::vector<unsigned char>().swap(image.pixels);
 }
 
-// Unloads the resource with given ID
-// If resource is used somewhere, it's refs count decreased, else it is completely disposed.
-void unloadResource(int resID) {
-	
-	if (scResources[resID].empty) {
-		std::wcout << "Can not unload empty resource, resource table is corrupted" << std::endl;
-		return;
+// Deletes textures of the image resource, waits for decoding
+void destroyImageInput(SCResource& res) {
+	if (res.image) {
+		glDeleteTextures(1, &res.image->array);
+		glDeleteFramebuffers(2, res.image->framebuffers);
+
+		delete res.image;
+		res.image = nullptr;
 	}
 
-	// Check if references > 0
-	if (scResources[resID].resource.refs > 1) {
-		--scResources[resID].resource.refs;
-		return;
+	glDeleteTextures(1, &res.bind);
+	res.bind = 0;
+	res.levels = 1;
+}
+
+// GL format of compressed blocks, 0 if context does not support them
+GLenum getCompressedFormat(CompressedTexture::BlockFormat format) {
+	switch (format) {
+		case CompressedTexture::BC1_RGB:     return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+		case CompressedTexture::BC1_RGBA:    return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : 0;
+		case CompressedTexture::BC2:         return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT3_EXT : 0;
+		case CompressedTexture::BC3:         return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+		case CompressedTexture::BC4:         return GL_COMPRESSED_RED_RGTC1;
+		case CompressedTexture::BC4_SIGNED:  return GL_COMPRESSED_SIGNED_RED_RGTC1;
+		case CompressedTexture::BC5:         return GL_COMPRESSED_RG_RGTC2;
+		case CompressedTexture::BC5_SIGNED:  return GL_COMPRESSED_SIGNED_RG_RGTC2;
+		case CompressedTexture::BC7:         return GLEW_ARB_texture_compression_bptc ? GL_COMPRESSED_RGBA_BPTC_UNORM : 0;
+		case CompressedTexture::ETC2_RGB:    return GLEW_ARB_ES3_compatibility ? GL_COMPRESSED_RGB8_ETC2 : 0;
+		case CompressedTexture::ETC2_RGB_A1: return GLEW_ARB_ES3_compatibility ? GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 : 0;
+		case CompressedTexture::ETC2_RGBA:   return GLEW_ARB_ES3_compatibility ? GL_COMPRESSED_RGBA8_ETC2_EAC : 0;
+		case CompressedTexture::EAC_R:       return GLEW_ARB_ES3_compatibility ? GL_COMPRESSED_R11_EAC : 0;
+		case CompressedTexture::EAC_RG:      return GLEW_ARB_ES3_compatibility ? GL_COMPRESSED_RG11_EAC : 0;
+		default:                             return 0;
 	}
+}
 
-	if (scResources[resID].resource.refs <= 0) {
-		std::wcout << "Can not unload unreferenced resource, resource table is corrupted" << std::endl;
+// Uploads mapped levels of pre-compressed image as is and unmaps the file
+void uploadCompressedImage(SCResource& res, CompressedTexture::Texture& texture) {
+	GLenum format = getCompressedFormat(texture.format);
+
+	if (!format) {
+		std::wcout << "Image resource load error: Compressed format is not supported by video driver [" << res.path << ']' << std::endl;
+		texture.release();
 		return;
 	}
-	
-	// In other case unload the resource
-	scResources[resID].empty = TRUE;
 
-	// Called once when finally disposing resource:
-	switch (scResources[resID].resource.type) {
-		case IMAGE_TEXTURE: {
-			std::wcout << "Unloading resource for Texture [" << scResources[resID].resource.path << ']' << std::endl;
-			glDeleteTextures(1, &scResources[resID].resource.bind);
-			return;
-		}
+	std::wcout << "Compressed texture [" << res.path << "] (" << texture.width << ", " << texture.height << ", " << texture.levels.size() << " levels)" << std::endl;
 
-		case AUDIO_TEXTURE: { // TODO: Unload media resources
-			std::wcout << "Unload Resource :: Incomplete :: Audio" << std::endl;
-			return;
-		}
+	// Cached blocks are already in texture order, blocks of files can not be flipped
+	if (!res.image->loader.cached) {
+		if (texture.topDown && res.vflip)
+			std::wcout << "Texture warning: KTX2 rows are stored from the top, image is shown flipped, export it with lower left origin [" << res.path << ']' << std::endl;
+		else if (!texture.topDown && !res.vflip)
+			std::wcout << "Texture warning: vflip is not supported for compressed textures, export image with upper left origin instead [" << res.path << ']' << std::endl;
+	}
 
-		case VIDEO_TEXTURE: {
-			std::wcout << "Unload Resource :: Incomplete :: Video" << std::endl;
+	if (res.mipmaps && texture.levels.size() == 1)
+		std::wcout << "Texture warning: compressed texture has no mip levels, mipmap filter samples only full size image [" << res.path << ']' << std::endl;
+
+	int levels = (int) texture.levels.size();
+	res.levels = levels;
+
+	glBindTexture(GL_TEXTURE_2D, res.bind);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+	// Blocks are not aligned to rows
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (int i = 0; i < levels; ++i) {
+		const CompressedTexture::Level& level = texture.levels[i];
+		glCompressedTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0, (GLsizei) level.size, level.data);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// Single channel blocks are gray, as gray PNG is
+	if (texture.format == CompressedTexture::BC4 || texture.format == CompressedTexture::BC4_SIGNED || texture.format == CompressedTexture::EAC_R) {
+		GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	res.width = texture.width;
+	res.height = texture.height;
+
+	// Data lives on GPU now
+	texture.release();
+}
+
+// Uploads decoded image once, for animated image shows the frame matching shader time
+// Frame change is layer copy on GPU, no pixels are sent from CPU during playback
+void updateImageInput(SCResource& res) {
+	ImageInput* input = res.image;
+
+	if (!input->ready) {
+		if (!input->loader.ready())
 			return;
-		}
 
-		case MIC_TEXTURE: {
-			std::wcout << "Unload Resource :: Incomplete :: Microphone" << std::endl;
+		input->ready = TRUE;
+
+		std::string error = input->loader.get();
+		if (!error.empty()) {
+			std::wcout << "Image resource load error: " << error.c_str() << " [" << res.path << ']' << std::endl;
 			return;
 		}
 
-		case WEB_TEXTURE: {
-			std::wcout << "Unload Resource :: Incomplete :: Webcam" << std::endl;
+		if (input->loader.compressed.levels.size()) {
+			uploadCompressedImage(res, input->loader.compressed);
 			return;
 		}
 
-		case FRAME_BUFFER: {
-			std::wcout << "Unloading resource for Buffer " << ("ABCD"[scResources[resID].resource.buffer_id]) << std::endl;
-			glBufferShaderShouldBeRendered[scResources[resID].resource.buffer_id] = FALSE;
+		ImageTexture::Animation& animation = input->loader.animation;
+
+		if (animation.getFrames() == 1) {
+			std::wcout << "Texture [" << res.path << "] (" << animation.width << ", " << animation.height << ", " << animation.channels << " x " << animation.bitDepth << " bit)" << std::endl;
+			uploadStillImage(res, animation);
 			return;
 		}
-	}
-}
 
-// Performs reloading of all resources
-// Returns 0 on success, 1 else
-BOOL reloadResources() {
-	BOOL error = FALSE;
-	for (size_t i = 0; i < ResourceTableSize; ++i) {
-		if (scResources[i].empty)
-			continue;
+		GLint maxLayers = 0;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
 
-		switch (scResources[i].resource.type) {
-			case IMAGE_TEXTURE: {
+		if (animation.getFrames() > maxLayers) {
+			std::wcout << "Texture warning: animation has " << animation.getFrames() << " frames, only first " << maxLayers << " are shown [" << res.path << ']' << std::endl;
 
-				std::wcout << "Reloading resource for Texture [" << scResources[i].resource.path << ']' << std::endl;
+			animation.delays.resize(maxLayers);
+			animation.starts.resize(maxLayers);
+			animation.duration = animation.starts.back() + animation.delays.back();
+		}
 
-				// Unload
-				std::wcout << "Unloading resource for Texture [" << scResources[i].resource.path << ']' << std::endl;
-				glDeleteTextures(1, &scResources[i].resource.bind);
+		std::wcout << "Animated texture [" << res.path << "] (" << animation.width << ", " << animation.height << ", " << animation.getFrames() << " frames, " << animation.duration << " s)" << std::endl;
 
-				// Load
-				std::vector<unsigned char> image;
-				unsigned width, height;
+		glGenTextures(1, &input->array);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, input->array);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, animation.width, animation.height, animation.getFrames(), 0, GL_RGBA, GL_UNSIGNED_BYTE, animation.pixels.data());
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
-				std::string stringPath = std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[i].resource.path);
+		// Pixels live on GPU now
+		std::vector<unsigned char>().swap(animation.pixels);
 
-				unsigned error = lodepng::decode(image, width, height, stringPath);
+		glBindTexture(GL_TEXTURE_2D, res.bind);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, animation.width, animation.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
-				std::wcout << "Loading resource for Texture [" << scResources[i].resource.path << "] (" << width << ", " << height << ')' << std::endl;
+		if (res.mipmaps)
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-				if (error != 0) {
+		glBindTexture(GL_TEXTURE_2D, 0);
 
-					std::wcout << "Image resource load error: " << lodepng_error_text(error) << std::endl;
-					MessageBoxA(
-						NULL,
-						lodepng_error_text(error),
-						"Image load error",
-						MB_ICONERROR | MB_OK
-					);
+		glGenFramebuffers(2, input->framebuffers);
 
-					error = TRUE;
-					break;
-				}
+		res.width = animation.width;
+		res.height = animation.height;
+		input->frame = -1;
+	}
 
-				// Flip image vertically
-				for (size_t y = 0; y < height / 2; y++)
-					for (size_t x = 0; x < width; x++)
-						for (size_t c = 0; c < 4; c++)
-							std::swap(image[4 * width * y + 4 * x + c], image[4 * width * (height - y - 1) + 4 * x + c]);
-
-				// Find closest power of two
-				size_t u2 = 1; while (u2 < width) u2 *= 2;
-				size_t v2 = 1; while (v2 < height) v2 *= 2;
-
-				scResources[i].resource.width = u2;
-				scResources[i].resource.height = v2;
-
-				if (u2 != width)
-					std::wcout << "Texture warning: width must be power of two, got " << width << ", resizing to closest " << u2 << std::endl;
-				if (v2 != height)
-					std::wcout << "Texture warning: height must be power of two, got " << height << ", resizing to closest " << v2 << std::endl;
-
-				// To size of two conversion ratio
-				double u3 = (double) width / u2;
-				double v3 = (double) height / v2;
-
-				// Resize texture to power of two
-				std::vector<unsigned char> image2(u2 * v2 * 4);
-				for (size_t y = 0; y < height; y++)
-					for (size_t x = 0; x < width; x++)
-						for (size_t c = 0; c < 4; c++)
-							image2[4 * u2 * y + 4 * x + c] = image[4 * width * y + 4 * x + c];
-
-				// Generate texture & pass pixeldata
-				glGenTextures(1, &scResources[i].resource.bind);
-				glBindTexture(GL_TEXTURE_2D, scResources[i].resource.bind);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-				glTexImage2D(GL_TEXTURE_2D, 0, 4, u2, v2, 0, GL_RGBA, GL_UNSIGNED_BYTE, &image2[0]);
-				glBindTexture(GL_TEXTURE_2D, 0);
+	if (!input->array)
+		return;
 
-				break; // No insertion
-			}
+	const ImageTexture::Animation& animation = input->loader.animation;
 
-			case AUDIO_TEXTURE: { // TODO: Reload media resources
-				std::wcout << "Reload Resource :: Incomplete :: Audio" << std::endl;
-				break;
-			}
+	// Animation follows shader time
+	double time = glfwGetTime();
+	res.time = animation.duration > 0.0 ? fmod(time, animation.duration) : 0.0;
 
-			case VIDEO_TEXTURE: {
-				std::wcout << "Reload Resource :: Incomplete :: Video" << std::endl;
-				break;
-			}
+	int frame = animation.frameAt(time);
+	if (frame == input->frame)
+		return;
 
-			case MIC_TEXTURE: {
-				std::wcout << "Reload Resource :: Incomplete :: Microphone" << std::endl;
-				break;
-			}
+	input->frame = frame;
 
-			case WEB_TEXTURE: {
-				std::wcout << "Reload Resource :: Incomplete :: Webcam" << std::endl;
-				break;
-			}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, input->framebuffers[0]);
+	glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, input->array, 0, frame);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, input->framebuffers[1]);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, res.bind, 0);
 
-			case KEYBOARD_TEXTURE: {
-				std::wcout << "Reload Resource :: Incomplete :: Keyboard" << std::endl;
-				break;
-			}
+	// Frames are stored from the bottom, flipped by the copy
+	if (res.vflip)
+		glBlitFramebuffer(0, 0, res.width, res.height, 0, 0, res.width, res.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	else
+		glBlitFramebuffer(0, 0, res.width, res.height, 0, res.height, res.width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-			case FRAME_BUFFER: {
-				std::wcout << "Reloading resource for Buffer " << ("ABCD"[scResources[i].resource.buffer_id]) << " : PASS" << std::endl;
-				break;
-			}
-		}
-	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	return error;
+	// Mip chain follows displayed frame
+	if (res.mipmaps) {
+		glBindTexture(GL_TEXTURE_2D, res.bind);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
 }
 
-// Unloads all resources
-void unloadResources() {
-	for (int i = 0; i < ResourceTableSize; ++i) {
-		if (scResources[i].empty)
-			continue;
-
-		unloadResource(i);
+// Splits path of cubemap resource into face files, single path is a cross image
+std::vector<std::wstring> splitCubemapPath(const std::wstring& path) {
+	std::vector<std::wstring> files;
+	size_t start = 0;
 
-		scResources[i].empty = TRUE;
-	}
+	while (true) {
+		size_t end = path.find(L'|', start);
+		files.push_back(path.substr(start, end == std::wstring::npos ? std::wstring::npos : end - start));
 
-	// Unload all inputs for all shaders
-	for (int i = 0; i < 4; ++i) {
-		scMainShaderInputs[i] = -1;
+		if (end == std::wstring::npos)
+			return files;
 
-		for (int k = 0; k < 4; ++k)
-			scBufferShaderInputs[i][k] = -1;
+		start = end + 1;
 	}
 }
 
-// Performs load of main shader resource
-// Warning: Path should be absolute
+// Starts decoding faces of the cubemap resource on worker threads (one per file) and creates placeholder texture
+// Texture is filled by updateCubemapInput() once all faces are decoded
 // Returns 0 on success, 1 else
-BOOL loadMainShaderResource(SCResource res, int inputID) {
-
-	// If main input is bound to some resource, reload this resource
-	// Optionally check if target resource is loaded in this input and cancel load
-	if (scMainShaderInputs[inputID] != -1) {
-
-		int resID = findResource(res);
-
-		// Do not relod the resource
-		if (resID == scMainShaderInputs[inputID])
-			return 0;
+BOOL createCubemapInput(SCResource& res) {
+	std::vector<std::wstring> files = splitCubemapPath(res.path);
+	ImageTexture::Format formats[6];
 
-		// If resource does not exist or is not bound to this input, unload it
-		unloadResource(scMainShaderInputs[inputID]);
-		scMainShaderInputs[inputID] = -1;
-	}
+	const char* error = nullptr;
 
-	scMainShaderInputs[inputID] = loadResource(res);
-	return scMainShaderInputs[inputID] == -1;
-}
+	if (files.size() != 1 && files.size() != 6)
+		error = "Cubemap should be six image files or single cross image";
 
-// Performs unloading of main shader resource
-void unloadMainShaderResource(int inputID) {
+	for (size_t i = 0; !error && i < files.size(); ++i) {
+		formats[i] = ImageTexture::detectFormat(files[i]);
 
-	if (scMainShaderInputs[inputID] != -1) {
-		unloadResource(scMainShaderInputs[inputID]);
-		scMainShaderInputs[inputID] = -1;
+		if (formats[i] == ImageTexture::UNKNOWN_FORMAT)
+			error = "Unsupported or missing cubemap image file";
+		else if (formats[i] == ImageTexture::DDS_FORMAT || formats[i] == ImageTexture::KTX2_FORMAT)
+			error = "Pre-compressed cubemap faces are not supported, use PNG or JPEG";
 	}
-}
 
-// Performs load of main shader resource
-// Warning: Path should be absolute
-// Returns 0 on success, 1 else
-BOOL loadBufferShaderResource(SCResource res, int bufferID, int inputID) {
+	if (error) {
+		std::wcout << "Cubemap resource load error: " << error << " [" << res.path << ']' << std::endl;
+		MessageBoxA(
+			NULL,
+			error,
+			"Cubemap load error",
+			MB_ICONERROR | MB_OK
+		);
 
-	if (bufferID < 0 || bufferID > 3) {
-		std::wcout << "Can not load resource for Buffer " << bufferID << ", Buffer does not exist, bufferID corrupt" << std::endl;
 		return 1;
 	}
 
-	// If main input is bound to some resource, reload this resource
-	// Optionally check if target resource is loaded in this input and cancel load
-	if (scBufferShaderInputs[bufferID][inputID] != -1) {
+	std::wcout << "Loading resource for Cubemap [" << res.path << ']' << std::endl;
 
-		int resID = findResource(res);
+	res.cubemap = new CubemapInput();
+	res.cubemap->files = (int) files.size();
 
-		// Do not relod the resource
-		if (resID == scBufferShaderInputs[bufferID][inputID])
-			return 0;
+	// Faces are cut out of decoded pixels, texture cache is not used
+	TextureCache::Settings settings;
 
-		// If resource does not exist or is not bound to this input, unload it
-		unloadResource(scBufferShaderInputs[bufferID][inputID]);
-		scBufferShaderInputs[bufferID][inputID] = -1;
-	}
+	for (size_t i = 0; i < files.size(); ++i)
+		res.cubemap->loaders[i].start(files[i], formats[i], settings);
 
-	scBufferShaderInputs[bufferID][inputID] = loadResource(res);
-	return scBufferShaderInputs[bufferID][inputID] == -1;
-}
+	res.width = 0;
+	res.height = 0;
+	res.time = 0.0;
 
-// Performs unloading of main shader resource
-BOOL unloadBufferShaderResource(int bufferID, int inputID) {
+	// Transparent placeholder until decoded
+	unsigned char transparent[4] = { 0, 0, 0, 0 };
 
-	if (bufferID < 0 || bufferID > 3) {
-		std::wcout << "Can not load resource for Buffer " << bufferID << ", Buffer does not exist, bufferID corrupt" << std::endl;
-		return 1;
-	}
+	glGenTextures(1, &res.bind);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, res.bind);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-	if (scBufferShaderInputs[bufferID][inputID] != -1) {
-		unloadResource(scBufferShaderInputs[bufferID][inputID]);
-		scBufferShaderInputs[bufferID][inputID] = -1;
-	}
+	for (int face = 0; face < 6; ++face)
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
 	return 0;
 }
 
+// Uploads decoded faces once all of them are ready
+// Faces are stored with the top row first, as cube map addresses them. Cross image is laid out as
+//       +Y
+//   -X  +Z  +X  -Z
+//       -Y
+void updateCubemapInput(SCResource& res) {
+	static const int crossX[6] = { 2, 0, 1, 1, 1, 3 };
+	static const int crossY[6] = { 1, 1, 0, 2, 1, 1 };
 
-// Performs simple operation of opening file picker with specified extensions allowed for file open
-std::wstring openFile(int fileTypesSize, const COMDLG_FILTERSPEC* fileTypes) {
+	CubemapInput* input = res.cubemap;
 
-	std::wstring result;
-	HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+	if (input->ready)
+		return;
 
-	if (SUCCEEDED(hr)) {
+	for (int i = 0; i < input->files; ++i)
+		if (!input->loaders[i].ready())
+			return;
 
-		IFileOpenDialog* pFileOpen;
+	input->ready = TRUE;
 
-		// Create the FileOpenDialog object.
-		hr = CoCreateInstance(CLSID_FileOpenDialog, NULL, CLSCTX_ALL, IID_IFileOpenDialog, reinterpret_cast<void**>(&pFileOpen));
+	std::string error;
+	for (int i = 0; i < input->files; ++i) {
+		std::string fileError = input->loaders[i].get();
+		if (error.empty())
+			error = fileError;
+	}
 
-		if (SUCCEEDED(hr)) {
+	ImageTexture::Animation& first = input->loaders[0].animation;
+	int size = input->files == 1 ? first.width / 4 : first.width;
 
-			// Set extension filter
-			pFileOpen->SetFileTypes(fileTypesSize, fileTypes);
+	if (error.empty()) {
+		if (input->files == 1 && (first.width != size * 4 || first.height != size * 3))
+			error = "Cubemap image should be horizontal cross of 4 x 3 square faces";
 
-			// Show the Open dialog box.
-			hr = pFileOpen->Show(NULL);
+		for (int i = 0; error.empty() && i < input->files; ++i) {
+			ImageTexture::Animation& face = input->loaders[i].animation;
 
-			// Get the file name from the dialog box.
-			if (SUCCEEDED(hr)) {
+			if (input->files == 6 && (face.width != size || face.height != size || face.channels != first.channels || face.bitDepth != first.bitDepth))
+				error = "Cubemap faces should be square images of the same size and pixel format";
+		}
+	}
 
-				IShellItem* pItem;
-				hr = pFileOpen->GetResult(&pItem);
+	if (!error.empty()) {
+		std::wcout << "Cubemap resource load error: " << error.c_str() << " [" << res.path << ']' << std::endl;
+		return;
+	}
 
-				if (SUCCEEDED(hr)) {
+	std::wcout << "Cubemap [" << res.path << "] (" << size << " x " << size << ", " << first.channels << " x " << first.bitDepth << " bit)" << std::endl;
 
-					PWSTR pszFilePath;
-					hr = pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszFilePath);
+	GLenum internalFormat, format, type;
+	const GLint* swizzle;
+	getImageFormat(first, internalFormat, format, type, swizzle);
 
-					// Display the file name to the user.
-					if (SUCCEEDED(hr)) {
-						result = pszFilePath;
-						std::wcout << "File Open result :: " << result << std::endl;
+	glBindTexture(GL_TEXTURE_CUBE_MAP, res.bind);
+	glTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-						CoTaskMemFree(pszFilePath);
-					}
-					pItem->Release();
-				}
-			}
-			pFileOpen->Release();
+	for (int i = 0; i < input->files; ++i) {
+		ImageTexture::Animation& image = input->loaders[i].animation;
+
+		// Only the first frame of animated image is used, it is stored from the bottom
+		if (!image.topDown) {
+			size_t rowSize = (size_t) image.width * image.getPixelSize();
+			for (int y = 0; y < image.height / 2; ++y)
+				std::swap_ranges(image.pixels.begin() + rowSize * y, image.pixels.begin() + rowSize * (y + 1), image.pixels.begin() + rowSize * (image.height - 1 - y));
 		}
-		CoUninitialize();
 	}
 
-	return result;
-}
+	for (int face = 0; face < 6; ++face) {
+		ImageTexture::Animation& image = input->loaders[input->files == 1 ? 0 : face].animation;
 
-// Performs simple operation of opening file picker with specified extensions allowed for file save
-std::wstring saveFile(int fileTypesSize, const COMDLG_FILTERSPEC* fileTypes, const wchar_t* defaultFileName = NULL) {
+		// Face is cut out of cross image right during upload
+		if (input->files == 1) {
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, image.width);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, crossX[face] * size);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, crossY[face] * size);
+		}
 
-	std::wstring result;
-	HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, internalFormat, size, size, 0, format, type, image.pixels.data());
+	}
 
-	if (SUCCEEDED(hr)) {
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-		IFileOpenDialog* pFileSave;
+	if (res.mipmaps) {
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	}
 
-		// Create the FileOpenDialog object.
-		hr = CoCreateInstance(CLSID_FileSaveDialog, NULL, CLSCTX_ALL, IID_IFileSaveDialog, reinterpret_cast<void**>(&pFileSave));
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
-		if (SUCCEEDED(hr)) {
+	res.width = size;
+	res.height = size;
 
-			// Set extension filter
-			pFileSave->SetFileTypes(fileTypesSize, fileTypes);
-			if (defaultFileName != NULL)
-				pFileSave->SetFileName(defaultFileName);
+	// Pixels live on GPU now
+	for (int i = 0; i < input->files; ++i)
+		std::vector<unsigned char>().swap(input->loaders[i].animation.pixels);
+}
 
-			// Show the Open dialog box.
-			hr = pFileSave->Show(NULL);
+// Deletes texture of the cubemap resource, waits for decoding
+void destroyCubemapInput(SCResource& res) {
+	delete res.cubemap;
+	res.cubemap = nullptr;
 
-			// Get the file name from the dialog box.
-			if (SUCCEEDED(hr)) {
+	glDeleteTextures(1, &res.bind);
+	res.bind = 0;
+}
 
-				IShellItem* pItem;
-				hr = pFileSave->GetResult(&pItem);
+// Maps volume file of the resource and uploads voxels right from the mapping as 3D texture
+// Returns 0 on success, 1 else
+BOOL createVolumeInput(SCResource& res) {
+	static const GLenum formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	static const GLenum internalFormats[5][4] = {
+		{ 0, 0, 0, 0 },
+		{ GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 },
+		{ GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 },
+		{ GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F },
+		{ GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F }
+	};
+	static const GLenum types[5] = { 0, GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_HALF_FLOAT, GL_FLOAT };
 
-				if (SUCCEEDED(hr)) {
+	VolumeTexture::Volume volume;
+	std::string error = VolumeTexture::load(res.path, res.volume, volume);
 
-					PWSTR pszFilePath;
-					hr = pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszFilePath);
+	GLint maxSize = 0;
+	glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxSize);
 
-					// Display the file name to the user.
-					if (SUCCEEDED(hr)) {
-						result = pszFilePath;
-						std::wcout << "File Save result :: " << result << std::endl;
+	if (error.empty() && (volume.layout.width > maxSize || volume.layout.height > maxSize || volume.layout.depth > maxSize))
+		error = "Volume is larger than video driver supports (" + std::to_string(maxSize) + " voxels per side)";
 
-						CoTaskMemFree(pszFilePath);
-					}
-					pItem->Release();
-				}
-			}
-			pFileSave->Release();
-		}
-		CoUninitialize();
+	if (!error.empty()) {
+		std::wcout << "Volume resource load error: " << error.c_str() << " [" << res.path << ']' << std::endl;
+		MessageBoxA(
+			NULL,
+			error.c_str(),
+			"Volume load error",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
 	}
 
-	return result;
-}
+	const VolumeTexture::Layout& layout = volume.layout;
 
+	std::wcout << "Loading resource for Volume [" << res.path << "] " << layout.width << " x " << layout.height << " x " << layout.depth << ", " << layout.channels << " x " << VolumeTexture::formatName(layout.format) << std::endl;
 
-struct ShaderCompilationStatus {
-	GLuint shaderID = -1;
-	BOOL success = FALSE;
-};
+	glGenTextures(1, &res.bind);
+	glBindTexture(GL_TEXTURE_3D, res.bind);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, res.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
 
-// Compiles fragment shader and returns shader program ID
-// Debug only
-// shaderName defines the name of the shader to display if error occurs. For example BufferA or myshader.glsl
-ShaderCompilationStatus compileShader(const char* fragmentSource, const char* shaderName = NULL) { // const std::wstring& fragmentSource
+	// Voxel rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage3D(GL_TEXTURE_3D, 0, internalFormats[layout.format][layout.channels - 1], layout.width, layout.height, layout.depth, 0, formats[layout.channels - 1], types[layout.format], volume.voxels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-	// Default Vertex shader
-	const char* vertexSource = R"glsl(
-		#version 330 core
+	if (res.mipmaps)
+		glGenerateMipmap(GL_TEXTURE_3D);
 
-		in vec2 position;
+	glBindTexture(GL_TEXTURE_3D, 0);
 
-		void main()
-		{
-			gl_Position = vec4(position, 0.0, 1.0);
-		}
-	)glsl";
+	res.width = layout.width;
+	res.height = layout.height;
+	res.depth = layout.depth;
+	res.time = 0.0;
 
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexSource, NULL);
-	glCompileShader(vertexShader);
+	// Voxels live on GPU now
+	volume.release();
 
-	GLint status;
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &status);
+	return 0;
+}
 
-	if (status != GL_TRUE) {
+// Deletes texture of the volume resource
+void destroyVolumeInput(SCResource& res) {
+	glDeleteTextures(1, &res.bind);
+	res.bind = 0;
+}
 
-		// TODO: std::vector<char> or std::string buffer
-		char buffer[2048];
-		glGetShaderInfoLog(vertexShader, 4096, NULL, buffer);
+// Opens audio stream of the resource (file or capture) and creates texture for it
+// Returns 0 on success, 1 else
+BOOL createAudioInput(SCResource& res) {
+	std::string error;
+	BOOL failed;
+
+	if (res.type == AUDIO_TEXTURE) {
+		AudioTexture::FileStream* stream = new AudioTexture::FileStream();
+		failed = stream->open(res.path, error);
+		res.audio = stream;
+	} else {
 
-		std::wcout << "Vertex shader compilation error: " << buffer << std::endl;
+		// Capture device or WAV replay with the same timing
+		AudioTexture::CaptureSource* source;
+		if (res.path.empty())
+			source = new AudioTexture::WaveInSource();
+		else
+			source = new AudioTexture::ReplaySource(res.path);
+
+		AudioTexture::CaptureStream* stream = new AudioTexture::CaptureStream(source);
+		failed = stream->open(error);
+		res.audio = stream;
+	}
+
+	if (failed) {
+
+		std::wcout << "Audio resource load error: " << error.c_str() << " [" << resourceToShordDescription(res) << ']' << std::endl;
 		MessageBoxA(
 			NULL,
-			buffer,
-			"Vertex shader compilation error",
+			error.c_str(),
+			"Audio load error",
 			MB_ICONERROR | MB_OK
 		);
 
-		return { 0, FALSE };
+		delete res.audio;
+		res.audio = nullptr;
+		return 1;
 	}
 
-	// Compile Fragment shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	std::wcout << "Loading resource for " << resourceToShordDescription(res) << " (" << res.audio->getSampleRate() << " Hz)" << std::endl;
+
+	res.width = AudioTexture::TextureWidth;
+	res.height = AudioTexture::TextureHeight;
+	res.sampleRate = res.audio->getSampleRate();
+	res.time = 0.0;
+
+	// Single channel texture, updated by renderSC() from the stream frames
+	std::vector<unsigned char> silence(AudioTexture::TextureWidth * AudioTexture::TextureHeight, 0);
+
+	glGenTextures(1, &res.bind);
+	glBindTexture(GL_TEXTURE_2D, res.bind);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, res.width, res.height, 0, GL_RED, GL_UNSIGNED_BYTE, &silence[0]);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
 
-	glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
-	glCompileShader(fragmentShader);
+	res.audio->setPaused(scPaused);
+	res.audio->start();
 
-	status;
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &status);
+	return 0;
+}
 
-	if (status != GL_TRUE) {
+// Stops audio stream of the resource and deletes texture
+void destroyAudioInput(SCResource& res) {
+	delete res.audio;
+	res.audio = nullptr;
 
-		// TODO: std::vector<char> or std::string buffer
-		char buffer[8192];
-		glGetShaderInfoLog(fragmentShader, 4096, NULL, buffer);
+	glDeleteTextures(1, &res.bind);
+	res.bind = 0;
+}
 
-		if (shaderName == NULL)
-			std::wcout << "Fragment shader compilation error: " << buffer << std::endl;
-		else
-			std::wcout << "Fragment shader " << shaderName << " compilation error: " << buffer << std::endl;
+// Opens video stream of the resource and creates texture and pixel buffers for it
+// Returns 0 on success, 1 else
+BOOL createVideoInput(SCResource& res) {
+	std::string error;
+	res.video = new VideoInput();
+
+	if (res.video->stream.open(res.path, error)) {
+
+		std::wcout << "Video resource load error: " << error.c_str() << " [" << res.path << ']' << std::endl;
 		MessageBoxA(
 			NULL,
-			buffer,
-			shaderName == NULL ? "Fragment shader compilation error" : ("Fragment shader " + std::string(shaderName) + " compilation error").c_str(),
+			error.c_str(),
+			"Video load error",
 			MB_ICONERROR | MB_OK
 		);
 
-		return { 0, FALSE };
+		delete res.video;
+		res.video = nullptr;
+		return 1;
 	}
 
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
+	res.width = res.video->stream.getWidth();
+	res.height = res.video->stream.getHeight();
+	res.time = 0.0;
 
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	std::wcout << "Loading resource for Video [" << res.path << "] (" << res.width << ", " << res.height << ", " << res.video->stream.getDuration() << " s)" << std::endl;
 
+	glGenTextures(1, &res.bind);
+	glBindTexture(GL_TEXTURE_2D, res.bind);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	return { shaderProgram, TRUE };
-}
+	// Decoded frames are BGRX, alpha byte is undefined
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, res.width, res.height, 0, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
 
-// Load shader and then compile
-ShaderCompilationStatus compileShaderFromFile(const std::wstring& path) {
-	std::ifstream f(path);
-	std::string str;
+	GLsizeiptr frameSize = (GLsizeiptr) res.width * res.height * 4;
+	res.video->persistent = GLEW_ARB_buffer_storage ? TRUE : FALSE;
 
-	if (!f) {
+	if (res.video->persistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
 
-		std::wcout << "Failed to load Shader file: " << "Failed to load file [" << path << ']' << std::endl;
-		MessageBox(
-			NULL,
-			(L"Failed to load file " + path).c_str(),
-			L"Failed to load Shader file",
-			MB_ICONERROR | MB_OK
-		);
+		glGenBuffers(VideoTexture::RingSize, res.video->buffers);
+		for (int i = 0; i < VideoTexture::RingSize; ++i) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, res.video->buffers[i]);
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER, frameSize, NULL, flags);
 
-		return { 0, FALSE };
+			void* memory = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frameSize, flags);
+			res.video->stream.setSlotMemory(i, memory);
+
+			if (!memory)
+				res.video->persistent = FALSE;
+		}
+
+		// Decoder would write into it's own memory for unmapped slots, so upload everything through streaming buffer
+		if (!res.video->persistent) {
+			std::wcout << "Failed to map pixel buffers, using streaming upload for Video [" << res.path << ']' << std::endl;
+
+			for (int i = 0; i < VideoTexture::RingSize; ++i)
+				res.video->stream.setSlotMemory(i, nullptr);
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			glDeleteBuffers(VideoTexture::RingSize, res.video->buffers);
+			memset(res.video->buffers, 0, sizeof(res.video->buffers));
+		}
 	}
 
-	f.seekg(0, std::ios::end);
-	str.reserve(f.tellg());
-	f.seekg(0, std::ios::beg);
+	if (!res.video->persistent) {
+		glGenBuffers(1, res.video->buffers);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, res.video->buffers[0]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, frameSize, NULL, GL_STREAM_DRAW);
+	}
 
-	str.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-	return compileShader(str.c_str(), std::filesystem::path(path).filename().string().c_str());
-}
+	res.video->stream.setPaused(scPaused);
+	res.video->stream.start();
 
-// Loads Main shader from file, saves path
-// Returns 0 on success, 1 else
-BOOL loadMainShaderFromFile(const std::wstring& path) {
-	
-	// Set path for main shader in any case
-	glMainShaderPath = path;
+	return 0;
+}
 
-	ShaderCompilationStatus shaderResult = compileShaderFromFile(glMainShaderPath);
-	if (shaderResult.success) {
+// Stops video stream of the resource and deletes it's GL objects
+void destroyVideoInput(SCResource& res) {
+	if (!res.video)
+		return;
 
-		// Delete previous shader program only if load successfull
-		if (glMainShaderProgramID != -1)
-			glDeleteProgram(glMainShaderProgramID);
+	// Decode thread writes into mapped buffers, stop it first
+	res.video->stream.stop();
 
-		glMainShaderProgramID = shaderResult.shaderID;
+	for (int i = 0; i < VideoTexture::RingSize; ++i)
+		if (res.video->fences[i])
+			glDeleteSync(res.video->fences[i]);
 
-		return 0;
-	}
+	// Mapped buffers are unmapped on delete
+	glDeleteBuffers(res.video->persistent ? VideoTexture::RingSize : 1, res.video->buffers);
+	glDeleteTextures(1, &res.bind);
+	res.bind = 0;
 
-	return 1;
+	delete res.video;
+	res.video = nullptr;
 }
 
-// Reloads Main shader from saved path
-// Returns 0 on success, 1 else
-BOOL reloadMainShader() {
+// Uploads the newest due frame of video resource, never waits for decode thread or for GPU
+void updateVideoInput(SCResource& res) {
+	VideoInput* video = res.video;
+	if (!video)
+		return;
 
-	if (glMainShaderProgramID == -1) { // Not loaded, ignore
-		return 0;
-	} else if (glMainShaderPath == L"") { // Loaded, but no path -> corrupt
-		std::wcout << "Can not load Main shader, Shader path corrupt" << std::endl;
-		return 1;
+	// Return slots whose uploads are complete
+	for (int i = 0; i < VideoTexture::RingSize; ++i) {
+		if (!video->fences[i])
+			continue;
+
+		GLenum status = glClientWaitSync(video->fences[i], 0, 0);
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+			glDeleteSync(video->fences[i]);
+			video->fences[i] = 0;
+			video->stream.releaseSlot(i);
+		}
 	}
 
-	ShaderCompilationStatus shaderResult = compileShaderFromFile(glMainShaderPath);
-	if (shaderResult.success) {
+	VideoTexture::Frame frame;
+	if (!video->stream.acquireFrame(frame))
+		return;
 
-		// Delete previous shader program only if load successfull
-		if (glMainShaderProgramID != -1)
-			glDeleteProgram(glMainShaderProgramID);
+	GLsizeiptr frameSize = (GLsizeiptr) res.width * res.height * 4;
 
-		glMainShaderProgramID = shaderResult.shaderID;
+	glBindTexture(GL_TEXTURE_2D, res.bind);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-		return 0;
-	}
+	if (video->persistent) {
 
-	return 1;
-}
+		// Frame is already in the buffer, upload is asynchronous
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, video->buffers[frame.slot]);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, res.width, res.height, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+		video->fences[frame.slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	} else {
 
-// Unloads Main shader from saved path
-void unloadMainShader() {
-	if (glMainShaderProgramID != -1) {
-		glDeleteProgram(glMainShaderProgramID);
-		glMainShaderProgramID = -1;
+		// Orphan buffer to not wait for the previous upload
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, video->buffers[0]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, frameSize, NULL, GL_STREAM_DRAW);
+
+		void* pixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frameSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (pixels) {
+			memcpy(pixels, video->stream.getSlotPixels(frame.slot), frameSize);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, res.width, res.height, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+		}
+
+		video->stream.releaseSlot(frame.slot);
 	}
 
-	glMainShaderPath = L"";
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	res.time = video->stream.getPlaybackTime(frame.time);
 }
 
-// Loads Buffer i shader from file, saves path
-// Returns 0 on success, 1 else
-BOOL loadBufferShaderFromFile(const std::wstring& path, int buffer_id) {
+// Load and initialize the desired resource
+// Returns ResourceID as index in scResources or -1
+int loadResource(SCResource res) {
 
-	if (buffer_id < 0 || buffer_id > 3) {
-		std::wcout << "Can not load Shader for Buffer " << buffer_id << ", Buffer does not exist, buffer_id corrupt" << std::endl;
-		return 1;
+	int resID = findResource(res);
+
+	if (resID != -1) {
+		++scResources[resID].resource.refs;
+		return resID;
 	}
 
-	// Set path for buffer shader in any case
-	glBufferShaderPath[buffer_id] = path;
+	// Called once when initially loading resource:
+	switch (res.type) {
+		case IMAGE_TEXTURE: {
+			res.refs = 1;
 
-	ShaderCompilationStatus shaderResult = compileShaderFromFile(glBufferShaderPath[buffer_id]);
-	if (shaderResult.success) {
+			if (createImageInput(res))
+				return -1;
 
-		// Delete previous shader program only if load successfull
-		if (glBufferShaderProgramIDs[buffer_id] != -1)
-			glDeleteProgram(glBufferShaderProgramIDs[buffer_id]);
+			std::wcout << "Inserting resource for Texture [" << res.path << ']' << std::endl;
 
-		glBufferShaderProgramIDs[buffer_id] = shaderResult.shaderID;
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
 
-		return 0;
-	}
+			std::wcout << "Can not insert Texture resource, resource table is corrupted" << std::endl;
+			destroyImageInput(res);
 
-	return 1;
-}
+			return -1;
+		}
 
-// Loads Buffer i shader from saved path
-// Returns 0 on success, 1 else
-BOOL reloadBufferShader(int buffer_id) {
+		case AUDIO_TEXTURE:
+		case MIC_TEXTURE: {
+			res.refs = 1;
 
-	if (buffer_id < 0 || buffer_id > 3) {
-		std::wcout << "Can not reload Shader for Buffer " << buffer_id << ", Buffer does not exist, buffer_id corrupt" << std::endl;
-		return 1;
-	}
+			if (createAudioInput(res))
+				return -1;
 
-	if (glBufferShaderProgramIDs[buffer_id] == -1) { // Not loaded, ignore
-		return 0;
-	} else if (glBufferShaderPath[buffer_id] == L"") { // Loaded, but no path -> corrupt
-		std::wcout << "Can not reload Shader for Buffer " << ("ABCD"[buffer_id]) << ", Shader path corrupt" << std::endl;
-		return 1;
-	}
+			std::wcout << "Inserting resource for " << resourceToShordDescription(res) << std::endl;
 
-	ShaderCompilationStatus shaderResult = compileShaderFromFile(glBufferShaderPath[buffer_id]);
-	if (shaderResult.success) {
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
 
-		// Delete previous shader program only if load successfull
-		if (glBufferShaderProgramIDs[buffer_id] != -1)
-			glDeleteProgram(glBufferShaderProgramIDs[buffer_id]);
+			std::wcout << "Can not insert Audio resource, resource table is corrupted" << std::endl;
+			destroyAudioInput(res);
 
-		glBufferShaderProgramIDs[buffer_id] = shaderResult.shaderID;
+			return -1;
+		}
 
-		return 0;
-	}
+		case VIDEO_TEXTURE: {
+			res.refs = 1;
 
-	return 1;
-}
+			if (createVideoInput(res))
+				return -1;
 
-// Unloads Main shader from saved path
-void unloadBufferShader(int buffer_id) {
-	if (glBufferShaderProgramIDs[buffer_id] != -1) {
-		glDeleteProgram(glBufferShaderProgramIDs[buffer_id]);
-		glBufferShaderProgramIDs[buffer_id] = -1;
-	}
+			std::wcout << "Inserting resource for Video [" << res.path << ']' << std::endl;
 
-	glBufferShaderPath[buffer_id] = L"";
-	// scBufferFrames[bufferId] = 0;
-}
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
 
+			std::wcout << "Can not insert Video resource, resource table is corrupted" << std::endl;
+			destroyVideoInput(res);
 
-// Reloads Shader Pack from scPackPath
-void reloadPack() {
-	if (scPackPath != L"") {
-		// unload previous shaders & resources
-		unloadMainShader();
+			return -1;
+		}
 
-		for (int i = 0; i < 4; ++i)
-			if (glBufferShaderProgramIDs[i] != -1)
-				unloadBufferShader(i);
+		case CUBEMAP_TEXTURE: {
+			res.refs = 1;
 
-		unloadResources();
+			if (createCubemapInput(res))
+				return -1;
 
-		// Clear buffers
-		for (int i = 0; i < 4; ++i) {
+			std::wcout << "Inserting resource for Cubemap [" << res.path << ']' << std::endl;
 
-			// First
-			glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[0][i]);
-			glViewport(0, 0, glWidth, glHeight);
-			glClearColor(0, 0, 0, 0);
-			glClear(GL_COLOR_BUFFER_BIT);
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
 
-			// Second
-			glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[1][i]);
-			glViewport(0, 0, glWidth, glHeight);
-			glClearColor(0, 0, 0, 0);
-			glClear(GL_COLOR_BUFFER_BIT);
+			std::wcout << "Can not insert Cubemap resource, resource table is corrupted" << std::endl;
+			destroyCubemapInput(res);
 
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			return -1;
+		}
 
-			scBufferFrames[i] = 0;
+		case VOLUME_TEXTURE: {
+			res.refs = 1;
+
+			if (createVolumeInput(res))
+				return -1;
+
+			std::wcout << "Inserting resource for Volume [" << res.path << ']' << std::endl;
+
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
+
+			std::wcout << "Can not insert Volume resource, resource table is corrupted" << std::endl;
+			destroyVolumeInput(res);
+
+			return -1;
 		}
 
-		glViewport(0, 0, glWidth, glHeight);
-		glClearColor(0, 0, 0, 0);
-		glClear(GL_COLOR_BUFFER_BIT);
+		case WEB_TEXTURE: {
+			std::wcout << "Load Resource :: Incomplete :: Webcam" << std::endl;
+			return -1;
+		}
 
-		// Reset time & frame
-		glfwSetTime(0.0);
-		scTimestamp = 0.0;
-		scFrames = 0;
+		case KEYBOARD_TEXTURE: {
+			res.refs = 1;
 
-		// Read JSON from path & validate
-		std::ifstream f(scPackPath);
-		std::string str;
+			// Live keyboard or scripted key stream from file
+			if (res.path.empty())
+				res.keyboard = new KeyboardTexture::Keyboard(new KeyboardTexture::RawInputSource(trayWindow));
+			else {
+				KeyboardTexture::ScriptedSource* script = new KeyboardTexture::ScriptedSource();
 
-		if (!f) {
+				std::string error;
+				if (script->load(res.path, error)) {
+					delete script;
 
-			std::wcout << "JSON :: Failed to open Pack file :: " << scPackPath << std::endl;
-			MessageBox(
-				NULL,
-				(L"Failed to open file " + scPackPath).c_str(),
-				L"Failed to load Pack file",
-				MB_ICONERROR | MB_OK
-			);
+					std::wcout << "Keyboard resource load error: " << error.c_str() << " [" << res.path << ']' << std::endl;
+					MessageBoxA(
+						NULL,
+						error.c_str(),
+						"Keyboard load error",
+						MB_ICONERROR | MB_OK
+					);
+
+					return -1;
+				}
+
+				res.keyboard = new KeyboardTexture::Keyboard(script);
+			}
+
+			if (res.keyboard->start()) {
+				delete res.keyboard;
+				res.keyboard = nullptr;
+
+				std::wcout << "Keyboard resource load error: failed to register raw keyboard input" << std::endl;
+				MessageBoxA(
+					NULL,
+					"Failed to register raw keyboard input",
+					"Keyboard load error",
+					MB_ICONERROR | MB_OK
+				);
+
+				return -1;
+			}
+
+			std::wcout << "Loading resource for " << resourceToShordDescription(res) << std::endl;
+
+			res.width = KeyboardTexture::TextureWidth;
+			res.height = KeyboardTexture::TextureHeight;
+
+			// Single channel texture, renderSC() uploads only changed texels
+			glGenTextures(1, &res.bind);
+			glBindTexture(GL_TEXTURE_2D, res.bind);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, res.width, res.height, 0, GL_RED, GL_UNSIGNED_BYTE, res.keyboard->getTexels());
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			std::wcout << "Inserting resource for " << resourceToShordDescription(res) << std::endl;
+
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
+
+			std::wcout << "Can not insert Keyboard resource, resource table is corrupted" << std::endl;
+			glDeleteTextures(1, &res.bind);
+			delete res.keyboard;
+
+			return -1;
+		}
+
+		case FRAME_BUFFER: {
+			res.refs = 1;
+
+			std::wcout << "Inserting resource for Buffer " << res.buffer_id << std::endl;
+
+			// Insert into first free cell
+			for (int i = 0; i < ResourceTableSize; ++i)
+				if (scResources[i].empty) {
+					scResources[i].empty = FALSE;
+					scResources[i].resource = res;
+					return i;
+				}
+
+			std::wcout << "Can not insert " << scBufferNames[res.buffer_id] << " resource, resource table is corrupted" << std::endl;
+			return -1;
+		}
+	}
+
+	return -1;
+}
+
+// Unloads the resource with given ID
+// If resource is used somewhere, it's refs count decreased, else it is completely disposed.
+void unloadResource(int resID) {
+	
+	if (scResources[resID].empty) {
+		std::wcout << "Can not unload empty resource, resource table is corrupted" << std::endl;
+		return;
+	}
+
+	// Check if references > 0
+	if (scResources[resID].resource.refs > 1) {
+		--scResources[resID].resource.refs;
+		return;
+	}
+
+	if (scResources[resID].resource.refs <= 0) {
+		std::wcout << "Can not unload unreferenced resource, resource table is corrupted" << std::endl;
+		return;
+	}
+	
+	// In other case unload the resource
+	scResources[resID].empty = TRUE;
+
+	// Called once when finally disposing resource:
+	switch (scResources[resID].resource.type) {
+		case IMAGE_TEXTURE: {
+			std::wcout << "Unloading resource for Texture [" << scResources[resID].resource.path << ']' << std::endl;
+			destroyImageInput(scResources[resID].resource);
+			return;
+		}
+
+		case AUDIO_TEXTURE:
+		case MIC_TEXTURE: {
+			std::wcout << "Unloading resource for " << resourceToShordDescription(scResources[resID].resource) << std::endl;
+			destroyAudioInput(scResources[resID].resource);
+			return;
+		}
+
+		case VIDEO_TEXTURE: {
+			std::wcout << "Unloading resource for Video [" << scResources[resID].resource.path << ']' << std::endl;
+			destroyVideoInput(scResources[resID].resource);
+			return;
+		}
+
+		case CUBEMAP_TEXTURE: {
+			std::wcout << "Unloading resource for Cubemap [" << scResources[resID].resource.path << ']' << std::endl;
+			destroyCubemapInput(scResources[resID].resource);
+			return;
+		}
+
+		case VOLUME_TEXTURE: {
+			std::wcout << "Unloading resource for Volume [" << scResources[resID].resource.path << ']' << std::endl;
+			destroyVolumeInput(scResources[resID].resource);
+			return;
+		}
+
+		case WEB_TEXTURE: {
+			std::wcout << "Unload Resource :: Incomplete :: Webcam" << std::endl;
+			return;
+		}
+
+		case KEYBOARD_TEXTURE: {
+			std::wcout << "Unloading resource for " << resourceToShordDescription(scResources[resID].resource) << std::endl;
+			delete scResources[resID].resource.keyboard;
+			scResources[resID].resource.keyboard = nullptr;
+			glDeleteTextures(1, &scResources[resID].resource.bind);
+			return;
+		}
+
+		case FRAME_BUFFER: {
+			std::wcout << "Unloading resource for " << scBufferNames[scResources[resID].resource.buffer_id] << std::endl;
+			return;
+		}
+	}
+}
+
+// Performs reloading of all resources
+// Returns 0 on success, 1 else
+BOOL reloadResources() {
+	BOOL error = FALSE;
+	for (size_t i = 0; i < ResourceTableSize; ++i) {
+		if (scResources[i].empty)
+			continue;
+
+		switch (scResources[i].resource.type) {
+			case IMAGE_TEXTURE: {
+				std::wcout << "Reloading resource for Texture [" << scResources[i].resource.path << ']' << std::endl;
+
+				// Size and animation may change, recreate everything
+				destroyImageInput(scResources[i].resource);
+
+				if (createImageInput(scResources[i].resource)) {
+					scResources[i].resource.width = 0;
+					scResources[i].resource.height = 0;
+					error = TRUE;
+				}
+
+				break; // No insertion
+			}
+
+			case AUDIO_TEXTURE:
+			case MIC_TEXTURE: {
+				std::wcout << "Reloading resource for " << resourceToShordDescription(scResources[i].resource) << std::endl;
+
+				// Reopen stream from the beginning
+				destroyAudioInput(scResources[i].resource);
+
+				if (createAudioInput(scResources[i].resource)) {
+					scResources[i].resource.width = 0;
+					scResources[i].resource.height = 0;
+					error = TRUE;
+				}
+
+				break;
+			}
+
+			case VIDEO_TEXTURE: {
+				std::wcout << "Reloading resource for Video [" << scResources[i].resource.path << ']' << std::endl;
+
+				// Size may change, recreate everything
+				destroyVideoInput(scResources[i].resource);
+
+				if (createVideoInput(scResources[i].resource)) {
+					scResources[i].resource.width = 0;
+					scResources[i].resource.height = 0;
+					error = TRUE;
+				}
+
+				break;
+			}
+
+			case CUBEMAP_TEXTURE: {
+				std::wcout << "Reloading resource for Cubemap [" << scResources[i].resource.path << ']' << std::endl;
+
+				// Faces may change, recreate everything
+				destroyCubemapInput(scResources[i].resource);
+
+				if (createCubemapInput(scResources[i].resource)) {
+					scResources[i].resource.width = 0;
+					scResources[i].resource.height = 0;
+					error = TRUE;
+				}
+
+				break;
+			}
+
+			case VOLUME_TEXTURE: {
+				std::wcout << "Reloading resource for Volume [" << scResources[i].resource.path << ']' << std::endl;
+
+				destroyVolumeInput(scResources[i].resource);
+
+				if (createVolumeInput(scResources[i].resource)) {
+					scResources[i].resource.width = 0;
+					scResources[i].resource.height = 0;
+					scResources[i].resource.depth = 0;
+					error = TRUE;
+				}
+
+				break;
+			}
+
+			case WEB_TEXTURE: {
+				std::wcout << "Reload Resource :: Incomplete :: Webcam" << std::endl;
+				break;
+			}
+
+			case KEYBOARD_TEXTURE: {
+
+				// Key states are live, nothing to reload
+				std::wcout << "Reloading resource for " << resourceToShordDescription(scResources[i].resource) << " : PASS" << std::endl;
+				break;
+			}
+
+			case FRAME_BUFFER: {
+				std::wcout << "Reloading resource for " << scBufferNames[scResources[i].resource.buffer_id] << " : PASS" << std::endl;
+				break;
+			}
+		}
+	}
+
+	return error;
+}
+
+// Pauses or resumes playback of media resources together with rendering
+void pauseResources(BOOL paused) {
+	for (int i = 0; i < ResourceTableSize; ++i) {
+		if (scResources[i].empty)
+			continue;
+
+		if ((scResources[i].resource.type == AUDIO_TEXTURE || scResources[i].resource.type == MIC_TEXTURE) && scResources[i].resource.audio)
+			scResources[i].resource.audio->setPaused(paused);
+		else if (scResources[i].resource.type == VIDEO_TEXTURE && scResources[i].resource.video)
+			scResources[i].resource.video->stream.setPaused(paused);
+	}
+
+	if (scSoundSink)
+		scSoundSink->setPaused(paused);
+}
+
+// Unloads all resources
+void unloadResources() {
+	for (int i = 0; i < ResourceTableSize; ++i) {
+		if (scResources[i].empty)
+			continue;
+
+		unloadResource(i);
+
+		scResources[i].empty = TRUE;
+	}
+
+	// Unload all inputs for all shaders
+	for (int k = 0; k < MaxChannels; ++k) {
+		scMainShaderInputs[k] = -1;
+		scMainShaderSamplers[k] = InputSampler();
+	}
+
+	for (int i = 0; i < MaxBuffers; ++i)
+		for (int k = 0; k < MaxChannels; ++k) {
+			scBufferShaderInputs[i][k] = -1;
+			scBufferShaderSamplers[i][k] = InputSampler();
+		}
+
+	scRenderGraphDirty = TRUE;
+}
+
+// Returns texture target of the buffer, GL_TEXTURE_CUBE_MAP for cubemap pass
+GLenum getBufferTarget(int bufferID) {
+	return glBufferShaderStages[bufferID] == GL_GEOMETRY_SHADER ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+}
+
+// Returns texture holding given output of the buffer in given frame parity
+GLuint getBufferTexture(int frame, int bufferID, int output) {
+	if (output)
+		return glBufferShaderOutputTextures[frame][bufferID][output - 1];
+
+	return glBufferShaderStages[bufferID] == GL_GEOMETRY_SHADER ? glBufferShaderCubeTextures[frame][bufferID] : glBufferShaderFramebufferTextures[frame][bufferID];
+}
+
+// Allocates both textures of the buffer (with all outputs) with it's format and size and clears them
+void allocateBufferTextures(int bufferID) {
+	const BufferFormat& format = BufferFormats[glBufferShaderFormats[bufferID]];
+
+	BOOL cubemap = glBufferShaderStages[bufferID] == GL_GEOMETRY_SHADER;
+
+	int width = glBufferShaderFixedSizes[bufferID][0];
+	int height = glBufferShaderFixedSizes[bufferID][1];
+
+	// Faces of cubemap do not follow window
+	if (cubemap) {
+		if (!width)
+			width = max((int) (DefaultCubemapSize * glBufferShaderScales[bufferID] + 0.5f), 1);
+
+		height = width;
+	} else if (!width || !height) {
+		width = max((int) (glWidth * glBufferShaderScales[bufferID] + 0.5f), 1);
+		height = max((int) (glHeight * glBufferShaderScales[bufferID] + 0.5f), 1);
+	}
+
+	glBufferShaderWidths[bufferID] = width;
+	glBufferShaderHeights[bufferID] = height;
+
+	const GLenum drawBuffers[MaxBufferOutputs] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+
+	for (int f = 0; f < 2; ++f) {
+		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[f][bufferID]);
+
+		// Faces of cubemap are layers of the single attachment, 2D textures of cubemap buffer have no storage and the other way around
+		glBindTexture(GL_TEXTURE_CUBE_MAP, glBufferShaderCubeTextures[f][bufferID]);
+		for (int face = 0; face < 6; ++face)
+			if (cubemap)
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, format.internalFormat, width, height, 0, format.format, format.type, 0);
+			else
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+		// All outputs share format and size of the buffer, outputs above declared amount have no storage and are detached
+		for (int o = 0; o < MaxBufferOutputs; ++o) {
+			GLuint texture = o ? glBufferShaderOutputTextures[f][bufferID][o - 1] : glBufferShaderFramebufferTextures[f][bufferID];
+			glBindTexture(GL_TEXTURE_2D, texture);
+
+			if (!cubemap && o < glBufferShaderOutputs[bufferID]) {
+				glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.format, format.type, 0);
+				glFramebufferTexture(GL_FRAMEBUFFER, drawBuffers[o], texture, 0);
+			} else {
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+				glFramebufferTexture(GL_FRAMEBUFFER, drawBuffers[o], cubemap && !o ? glBufferShaderCubeTextures[f][bufferID] : 0, 0);
+			}
+		}
+
+		glDrawBuffers(glBufferShaderOutputs[bufferID], drawBuffers);
+		glViewport(0, 0, width, height);
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// Old chain has the old size
+		glBufferShaderFramebufferMipmaps[f][bufferID] = FALSE;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Frees storage of both textures of the buffer, buffer is allocated again once some pass uses it
+void releaseBufferTextures(int bufferID) {
+	if (!glBufferShaderWidths[bufferID])
+		return;
+
+	for (int f = 0; f < 2; ++f) {
+		for (int o = 0; o < MaxBufferOutputs; ++o) {
+			glBindTexture(GL_TEXTURE_2D, o ? glBufferShaderOutputTextures[f][bufferID][o - 1] : glBufferShaderFramebufferTextures[f][bufferID]);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		}
+
+		glBindTexture(GL_TEXTURE_CUBE_MAP, glBufferShaderCubeTextures[f][bufferID]);
+		for (int face = 0; face < 6; ++face)
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+		glBufferShaderFramebufferMipmaps[f][bufferID] = FALSE;
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBufferShaderWidths[bufferID] = 0;
+	glBufferShaderHeights[bufferID] = 0;
+}
+
+// Clears contents of the buffer (and it's storage) and restarts it's frames
+void clearBufferTextures(int bufferID) {
+	scBufferFrames[bufferID] = 0;
+
+	if (glBufferShaderStorage[bufferID]) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, glBufferShaderStorage[bufferID]);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R8, GL_RED, GL_UNSIGNED_BYTE, NULL);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	if (!glBufferShaderWidths[bufferID])
+		return;
+
+	for (int f = 0; f < 2; ++f) {
+		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[f][bufferID]);
+		glViewport(0, 0, glBufferShaderWidths[bufferID], glBufferShaderHeights[bufferID]);
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		glBufferShaderFramebufferMipmaps[f][bufferID] = FALSE;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Changes render target format of the buffer, contents of the buffer are lost
+void setBufferFormat(int bufferID, int format) {
+	if (glBufferShaderFormats[bufferID] == format)
+		return;
+
+	glBufferShaderFormats[bufferID] = format;
+
+	if (glBufferShaderWidths[bufferID])
+		allocateBufferTextures(bufferID);
+}
+
+// Changes number of outputs of the buffer, contents of the buffer are lost
+void setBufferOutputs(int bufferID, int outputs) {
+	if (glBufferShaderOutputs[bufferID] == outputs)
+		return;
+
+	glBufferShaderOutputs[bufferID] = outputs;
+
+	if (glBufferShaderWidths[bufferID])
+		allocateBufferTextures(bufferID);
+}
+
+// Changes size of shader storage buffer of the buffer pass, 0 deletes storage
+// Storage is filled with zeros and bound to binding point equal to bufferID for all passes
+void setBufferStorage(int bufferID, GLsizeiptr size) {
+	if (glBufferShaderStorageSizes[bufferID] == size)
+		return;
+
+	if (glBufferShaderStorage[bufferID]) {
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bufferID, 0);
+		glDeleteBuffers(1, &glBufferShaderStorage[bufferID]);
+		glBufferShaderStorage[bufferID] = 0;
+	}
+
+	glBufferShaderStorageSizes[bufferID] = 0;
+
+	// Storage buffers and their clear are OpenGL 4.3
+	if (!size || !GLEW_ARB_shader_storage_buffer_object || !GLEW_ARB_clear_buffer_object)
+		return;
+
+	glBufferShaderStorageSizes[bufferID] = size;
+
+	glGenBuffers(1, &glBufferShaderStorage[bufferID]);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glBufferShaderStorage[bufferID]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_COPY);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R8, GL_RED, GL_UNSIGNED_BYTE, NULL);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bufferID, glBufferShaderStorage[bufferID]);
+}
+
+// Changes size of the buffer to scale of window size or to fixed size if width and height are set, contents of the buffer are lost
+void setBufferSize(int bufferID, float scale, int width, int height) {
+	if (glBufferShaderScales[bufferID] == scale && glBufferShaderFixedSizes[bufferID][0] == width && glBufferShaderFixedSizes[bufferID][1] == height)
+		return;
+
+	glBufferShaderScales[bufferID] = scale;
+	glBufferShaderFixedSizes[bufferID][0] = width;
+	glBufferShaderFixedSizes[bufferID][1] = height;
+
+	if (glBufferShaderWidths[bufferID])
+		allocateBufferTextures(bufferID);
+}
+
+// Returns index of the buffer with given name (any case), -1 if there is no such buffer
+int findBufferByName(const std::wstring& name) {
+	std::wstring lower = name;
+	transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
+
+	for (int i = 0; i < MaxBuffers; ++i) {
+		std::wstring bufferName = scBufferNames[i];
+		transform(bufferName.begin(), bufferName.end(), bufferName.begin(), ::towlower);
+
+		if (!bufferName.empty() && bufferName == lower)
+			return i;
+	}
+
+	return -1;
+}
+
+// Performs load of main shader resource
+// Warning: Path should be absolute
+// Returns 0 on success, 1 else
+BOOL loadMainShaderResource(SCResource res, int inputID, const InputSampler& sampler = InputSampler()) {
+
+	// Filter of buffer input decides if buffer needs mip chain
+	scMainShaderSamplers[inputID] = sampler;
+	scRenderGraphDirty = TRUE;
+
+	// If main input is bound to some resource, reload this resource
+	// Optionally check if target resource is loaded in this input and cancel load
+	if (scMainShaderInputs[inputID] != -1) {
+
+		int resID = findResource(res);
+
+		// Do not relod the resource
+		if (resID == scMainShaderInputs[inputID])
+			return 0;
+
+		// If resource does not exist or is not bound to this input, unload it
+		unloadResource(scMainShaderInputs[inputID]);
+		scMainShaderInputs[inputID] = -1;
+	}
+
+	scMainShaderInputs[inputID] = loadResource(res);
+	scRenderGraphDirty = TRUE;
+	return scMainShaderInputs[inputID] == -1;
+}
+
+// Performs unloading of main shader resource
+void unloadMainShaderResource(int inputID) {
+
+	scMainShaderSamplers[inputID] = InputSampler();
+
+	if (scMainShaderInputs[inputID] != -1) {
+		unloadResource(scMainShaderInputs[inputID]);
+		scMainShaderInputs[inputID] = -1;
+		scRenderGraphDirty = TRUE;
+	}
+}
+
+// Performs load of main shader resource
+// Warning: Path should be absolute
+// Returns 0 on success, 1 else
+BOOL loadBufferShaderResource(SCResource res, int bufferID, int inputID, const InputSampler& sampler = InputSampler()) {
+
+	if (bufferID < 0 || bufferID >= MaxBuffers) {
+		std::wcout << "Can not load resource for Buffer " << bufferID << ", Buffer does not exist, bufferID corrupt" << std::endl;
+		return 1;
+	}
+
+	// Filter of buffer input decides if buffer needs mip chain
+	scBufferShaderSamplers[bufferID][inputID] = sampler;
+	scRenderGraphDirty = TRUE;
+
+	// If main input is bound to some resource, reload this resource
+	// Optionally check if target resource is loaded in this input and cancel load
+	if (scBufferShaderInputs[bufferID][inputID] != -1) {
+
+		int resID = findResource(res);
+
+		// Do not relod the resource
+		if (resID == scBufferShaderInputs[bufferID][inputID])
+			return 0;
+
+		// If resource does not exist or is not bound to this input, unload it
+		unloadResource(scBufferShaderInputs[bufferID][inputID]);
+		scBufferShaderInputs[bufferID][inputID] = -1;
+	}
+
+	scBufferShaderInputs[bufferID][inputID] = loadResource(res);
+	scRenderGraphDirty = TRUE;
+	return scBufferShaderInputs[bufferID][inputID] == -1;
+}
+
+// Performs unloading of main shader resource
+BOOL unloadBufferShaderResource(int bufferID, int inputID) {
+
+	if (bufferID < 0 || bufferID >= MaxBuffers) {
+		std::wcout << "Can not load resource for Buffer " << bufferID << ", Buffer does not exist, bufferID corrupt" << std::endl;
+		return 1;
+	}
+
+	scBufferShaderSamplers[bufferID][inputID] = InputSampler();
+
+	if (scBufferShaderInputs[bufferID][inputID] != -1) {
+		unloadResource(scBufferShaderInputs[bufferID][inputID]);
+		scBufferShaderInputs[bufferID][inputID] = -1;
+		scRenderGraphDirty = TRUE;
+	}
+
+	return 0;
+}
+
+
+// Performs simple operation of opening file picker with specified extensions allowed for file open
+std::wstring openFile(int fileTypesSize, const COMDLG_FILTERSPEC* fileTypes) {
+
+	std::wstring result;
+	HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+
+	if (SUCCEEDED(hr)) {
+
+		IFileOpenDialog* pFileOpen;
+
+		// Create the FileOpenDialog object.
+		hr = CoCreateInstance(CLSID_FileOpenDialog, NULL, CLSCTX_ALL, IID_IFileOpenDialog, reinterpret_cast<void**>(&pFileOpen));
+
+		if (SUCCEEDED(hr)) {
+
+			// Set extension filter
+			pFileOpen->SetFileTypes(fileTypesSize, fileTypes);
+
+			// Show the Open dialog box.
+			hr = pFileOpen->Show(NULL);
+
+			// Get the file name from the dialog box.
+			if (SUCCEEDED(hr)) {
+
+				IShellItem* pItem;
+				hr = pFileOpen->GetResult(&pItem);
+
+				if (SUCCEEDED(hr)) {
+
+					PWSTR pszFilePath;
+					hr = pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszFilePath);
+
+					// Display the file name to the user.
+					if (SUCCEEDED(hr)) {
+						result = pszFilePath;
+						std::wcout << "File Open result :: " << result << std::endl;
+
+						CoTaskMemFree(pszFilePath);
+					}
+					pItem->Release();
+				}
+			}
+			pFileOpen->Release();
+		}
+		CoUninitialize();
+	}
+
+	return result;
+}
+
+// Performs simple operation of opening file picker with specified extensions allowed for file save
+std::wstring saveFile(int fileTypesSize, const COMDLG_FILTERSPEC* fileTypes, const wchar_t* defaultFileName = NULL) {
+
+	std::wstring result;
+	HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+
+	if (SUCCEEDED(hr)) {
+
+		IFileOpenDialog* pFileSave;
+
+		// Create the FileOpenDialog object.
+		hr = CoCreateInstance(CLSID_FileSaveDialog, NULL, CLSCTX_ALL, IID_IFileSaveDialog, reinterpret_cast<void**>(&pFileSave));
+
+		if (SUCCEEDED(hr)) {
+
+			// Set extension filter
+			pFileSave->SetFileTypes(fileTypesSize, fileTypes);
+			if (defaultFileName != NULL)
+				pFileSave->SetFileName(defaultFileName);
+
+			// Show the Open dialog box.
+			hr = pFileSave->Show(NULL);
+
+			// Get the file name from the dialog box.
+			if (SUCCEEDED(hr)) {
+
+				IShellItem* pItem;
+				hr = pFileSave->GetResult(&pItem);
+
+				if (SUCCEEDED(hr)) {
+
+					PWSTR pszFilePath;
+					hr = pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszFilePath);
+
+					// Display the file name to the user.
+					if (SUCCEEDED(hr)) {
+						result = pszFilePath;
+						std::wcout << "File Save result :: " << result << std::endl;
+
+						CoTaskMemFree(pszFilePath);
+					}
+					pItem->Release();
+				}
+			}
+			pFileSave->Release();
+		}
+		CoUninitialize();
+	}
+
+	return result;
+}
+
+
+struct ShaderCompilationStatus {
+	GLuint shaderID = -1;
+	BOOL success = FALSE;
+};
+
+// Compiles compute shader and returns shader program ID
+// shaderName defines the name of the shader to display if error occurs
+ShaderCompilationStatus compileComputeShader(const char* computeSource, const char* shaderName = NULL) {
+
+	if (!GLEW_ARB_compute_shader || !GLEW_ARB_shader_image_load_store || !GLEW_ARB_shader_storage_buffer_object) {
+		std::wcout << "Compute shader " << (shaderName == NULL ? "" : shaderName) << " requires OpenGL 4.3, video driver does not support it" << std::endl;
+		MessageBoxA(
+			NULL,
+			"Compute shaders require OpenGL 4.3, video driver does not support it",
+			shaderName == NULL ? "Compute shader compilation error" : ("Compute shader " + std::string(shaderName) + " compilation error").c_str(),
+			MB_ICONERROR | MB_OK
+		);
+
+		return { 0, FALSE };
+	}
+
+	GLuint computeShader = glCreateShader(GL_COMPUTE_SHADER);
+
+	glShaderSource(computeShader, 1, &computeSource, NULL);
+	glCompileShader(computeShader);
+
+	GLint status;
+	glGetShaderiv(computeShader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE) {
+
+		char buffer[8192];
+		glGetShaderInfoLog(computeShader, sizeof(buffer), NULL, buffer);
+		glDeleteShader(computeShader);
+
+		if (shaderName == NULL)
+			std::wcout << "Compute shader compilation error: " << buffer << std::endl;
+		else
+			std::wcout << "Compute shader " << shaderName << " compilation error: " << buffer << std::endl;
+		MessageBoxA(
+			NULL,
+			buffer,
+			shaderName == NULL ? "Compute shader compilation error" : ("Compute shader " + std::string(shaderName) + " compilation error").c_str(),
+			MB_ICONERROR | MB_OK
+		);
+
+		return { 0, FALSE };
+	}
+
+	GLuint shaderProgram = glCreateProgram();
+	glAttachShader(shaderProgram, computeShader);
+	glLinkProgram(shaderProgram);
+
+	glDeleteShader(computeShader);
+
+	return { shaderProgram, TRUE };
+}
+
+// Compiles fragment shader and returns shader program ID
+// Debug only
+// shaderName defines the name of the shader to display if error occurs. For example BufferA or myshader.glsl
+// stage selects compute shader instead of fragment shader, see compileComputeShader()
+// GL_GEOMETRY_SHADER stage adds built-in geometry shader that draws each triangle into all six layers of cubemap,
+//  fragment shader receives face index as "flat in int iCubeFace" and view direction as "in vec3 iRayDirection"
+// GL_VERTEX_SHADER stage compiles given source as vertex shader, built-in fragment shader writes "out vec4 iVertexColor" of it
+ShaderCompilationStatus compileShader(const char* fragmentSource, const char* shaderName = NULL, GLenum stage = GL_FRAGMENT_SHADER) { // const std::wstring& fragmentSource
+
+	if (stage == GL_COMPUTE_SHADER)
+		return compileComputeShader(fragmentSource, shaderName);
+
+	// Default Vertex shader
+	const char* vertexSource = R"glsl(
+		#version 330 core
+
+		in vec2 position;
+
+		void main()
+		{
+			gl_Position = vec4(position, 0.0, 1.0);
+		}
+	)glsl";
+
+	// Vertex pass, color of primitive comes from the pack shader
+	if (stage == GL_VERTEX_SHADER) {
+		vertexSource = fragmentSource;
+		fragmentSource = R"glsl(
+			#version 330 core
+
+			in vec4 iVertexColor;
+			out vec4 out_FragColor;
+
+			void main()
+			{
+				out_FragColor = iVertexColor;
+			}
+		)glsl";
+	}
+
+	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexSource, NULL);
+	glCompileShader(vertexShader);
+
+	GLint status;
+	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE) {
+
+		// TODO: std::vector<char> or std::string buffer
+		char buffer[8192];
+		glGetShaderInfoLog(vertexShader, sizeof(buffer), NULL, buffer);
+		glDeleteShader(vertexShader);
+
+		// Name is known only for vertex pass, default vertex shader has no name
+		if (shaderName == NULL || stage != GL_VERTEX_SHADER)
+			std::wcout << "Vertex shader compilation error: " << buffer << std::endl;
+		else
+			std::wcout << "Vertex shader " << shaderName << " compilation error: " << buffer << std::endl;
+		MessageBoxA(
+			NULL,
+			buffer,
+			shaderName == NULL || stage != GL_VERTEX_SHADER ? "Vertex shader compilation error" : ("Vertex shader " + std::string(shaderName) + " compilation error").c_str(),
+			MB_ICONERROR | MB_OK
+		);
+
+		return { 0, FALSE };
+	}
+
+	// Compile Fragment shader
+	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+	glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+	glCompileShader(fragmentShader);
+
+	status;
+	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE) {
+
+		// TODO: std::vector<char> or std::string buffer
+		char buffer[8192];
+		glGetShaderInfoLog(fragmentShader, 4096, NULL, buffer);
+
+		if (shaderName == NULL)
+			std::wcout << "Fragment shader compilation error: " << buffer << std::endl;
+		else
+			std::wcout << "Fragment shader " << shaderName << " compilation error: " << buffer << std::endl;
+		MessageBoxA(
+			NULL,
+			buffer,
+			shaderName == NULL ? "Fragment shader compilation error" : ("Fragment shader " + std::string(shaderName) + " compilation error").c_str(),
+			MB_ICONERROR | MB_OK
+		);
+
+		return { 0, FALSE };
+	}
+
+	// Cubemap pass, faces follow GL_TEXTURE_CUBE_MAP_POSITIVE_X + N order
+	GLuint geometryShader = 0;
+	if (stage == GL_GEOMETRY_SHADER) {
+		const char* geometrySource = R"glsl(
+			#version 330 core
+
+			layout(triangles) in;
+			layout(triangle_strip, max_vertices = 18) out;
+
+			flat out int iCubeFace;
+			out vec3 iRayDirection;
+
+			vec3 faceDirection(int face, vec2 p) {
+				if (face == 0) return vec3(1.0, -p.y, -p.x);
+				if (face == 1) return vec3(-1.0, -p.y, p.x);
+				if (face == 2) return vec3(p.x, 1.0, p.y);
+				if (face == 3) return vec3(p.x, -1.0, -p.y);
+				if (face == 4) return vec3(p.x, -p.y, 1.0);
+				return vec3(-p.x, -p.y, -1.0);
+			}
+
+			void main()
+			{
+				for (int face = 0; face < 6; ++face) {
+					for (int v = 0; v < 3; ++v) {
+						gl_Layer = face;
+						gl_Position = gl_in[v].gl_Position;
+						iCubeFace = face;
+						iRayDirection = faceDirection(face, gl_in[v].gl_Position.xy);
+						EmitVertex();
+					}
+
+					EndPrimitive();
+				}
+			}
+		)glsl";
+
+		geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+		glShaderSource(geometryShader, 1, &geometrySource, NULL);
+		glCompileShader(geometryShader);
+
+		glGetShaderiv(geometryShader, GL_COMPILE_STATUS, &status);
+
+		if (status != GL_TRUE) {
+
+			char buffer[2048];
+			glGetShaderInfoLog(geometryShader, sizeof(buffer), NULL, buffer);
+			glDeleteShader(geometryShader);
+			glDeleteShader(fragmentShader);
+
+			std::wcout << "Geometry shader compilation error: " << buffer << std::endl;
+			MessageBoxA(
+				NULL,
+				buffer,
+				"Geometry shader compilation error",
+				MB_ICONERROR | MB_OK
+			);
+
+			return { 0, FALSE };
+		}
+	}
+
+	GLuint shaderProgram = glCreateProgram();
+	glAttachShader(shaderProgram, vertexShader);
+	glAttachShader(shaderProgram, fragmentShader);
+	if (geometryShader)
+		glAttachShader(shaderProgram, geometryShader);
+	glLinkProgram(shaderProgram);
+
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	if (geometryShader)
+		glDeleteShader(geometryShader);
+
+
+	return { shaderProgram, TRUE };
+}
+
+// Returns bit mask of iChannelN samplers that are active in linked program
+// Samplers that are declared but never sampled are removed by the linker and not listed as active uniforms
+int queryLiveChannels(GLuint program) {
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+	// Can not introspect, assume everything is used
+	if (linked != GL_TRUE)
+		return (1 << MaxChannels) - 1;
+
+	GLint count = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+	int mask = 0;
+	for (GLint i = 0; i < count; ++i) {
+		char name[256];
+		GLsizei length = 0;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+
+		if (length == 9 && strncmp(name, "iChannel", 8) == 0 && name[8] >= '0' && name[8] < '0' + MaxChannels)
+			mask |= 1 << (name[8] - '0');
+	}
+
+	return mask;
+}
+
+// Inserts defines into shader source right after the #version line (or at the beginning if there is no #version)
+// Followed by #line directive to keep line numbers of compilation errors matching the source file
+std::string injectShaderDefines(const std::string& source, const ShaderDefines& defines) {
+
+	if (defines.size() == 0)
+		return source;
+
+	// Locate #version line, it must be the first directive in source
+	size_t insertPos = 0;
+	int insertLine = 1;
+
+	size_t versionPos = source.find("#version");
+	if (versionPos != std::string::npos) {
+		size_t lineEnd = source.find('\n', versionPos);
+		insertPos = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+		insertLine = (int) std::count(source.begin(), source.begin() + insertPos, '\n') + 1;
+	}
+
+	std::string header;
+	if (insertPos == source.size() && insertPos != 0 && source.back() != '\n')
+		header += '\n';
+
+	for (auto& define : defines)
+		header += "#define " + define.first + " " + define.second + "\n";
+
+	header += "#line " + std::to_string(insertLine) + "\n";
+
+	return source.substr(0, insertPos) + header + source.substr(insertPos);
+}
+
+// Declares iChannelN samplers with bit set in cubeChannels as samplerCube and in volumeChannels as sampler3D instead of sampler2D
+// Shadertoy-style shaders declare all channels as sampler2D, type follows input bound to the channel
+std::string declareChannelSamplers(const std::string& source, int cubeChannels, int volumeChannels) {
+
+	if (!cubeChannels && !volumeChannels)
+		return source;
+
+	auto isIdentifier = [](char c) { return isalnum((unsigned char) c) || c == '_'; };
+
+	std::string result = source;
+	size_t pos = 0;
+
+	while ((pos = result.find("sampler2D", pos)) != std::string::npos) {
+		size_t end = pos + 9;
+
+		if ((pos && isIdentifier(result[pos - 1])) || (end < result.size() && isIdentifier(result[end]))) {
+			pos = end;
+			continue;
+		}
+
+		size_t name = end;
+		while (name < result.size() && isspace((unsigned char) result[name]))
+			++name;
+
+		if (result.compare(name, 8, "iChannel") == 0 && name + 8 < result.size() && result[name + 8] >= '0' && result[name + 8] < '0' + MaxChannels
+			&& (name + 9 == result.size() || !isIdentifier(result[name + 9]))) {
+			int bit = 1 << (result[name + 8] - '0');
+
+			if (cubeChannels & bit)
+				result.replace(pos, 9, "samplerCube");
+			else if (volumeChannels & bit)
+				result.replace(pos, 9, "sampler3D");
+		}
+
+		pos = end;
+	}
+
+	return result;
+}
+
+// Shader program variant cache
+// Each variant is identified by the final source (after defines injection), so the same shader file
+//  with different defines is compiled and cached separately, and unchanged variants are not recompiled on reload.
+// Unreferenced variants are kept alive up to ShaderVariantCacheRetain entries, the oldest ones are deleted first.
+struct ShaderVariant {
+
+	// Variant references amount (auto GC)
+	int refs = 0;
+
+	// Shader program ID
+	GLuint program = 0;
+
+	// Counter value of the last access (used to evict the oldest unreferenced variants)
+	unsigned long long lastUse = 0;
+
+	// Bit mask of live iChannelN samplers, see queryLiveChannels()
+	int liveChannels = 0;
+};
+
+const size_t ShaderVariantCacheRetain = 16;
+
+std::unordered_map<std::string, ShaderVariant> glShaderVariantCache;
+unsigned long long glShaderVariantCacheCounter = 0;
+
+// Deletes oldest unreferenced variants exceeding ShaderVariantCacheRetain
+void trimShaderVariantCache() {
+	while (true) {
+		size_t unreferenced = 0;
+		auto oldest = glShaderVariantCache.end();
+
+		for (auto it = glShaderVariantCache.begin(); it != glShaderVariantCache.end(); ++it) {
+			if (it->second.refs > 0)
+				continue;
+
+			++unreferenced;
+			if (oldest == glShaderVariantCache.end() || it->second.lastUse < oldest->second.lastUse)
+				oldest = it;
+		}
+
+		if (unreferenced <= ShaderVariantCacheRetain)
+			return;
+
+		glDeleteProgram(oldest->second.program);
+		glShaderVariantCache.erase(oldest);
+	}
+}
+
+// Compiles shader source with given defines or returns the cached variant
+// Each successfull call should be paired with releaseShaderVariant()
+ShaderCompilationStatus compileShaderVariant(const std::string& source, const ShaderDefines& defines, const char* shaderName = NULL, GLenum stage = GL_FRAGMENT_SHADER) {
+
+	std::string variantSource = injectShaderDefines(source, defines);
+
+	// The same source compiled as compute shader is a different program
+	std::string variantKey = stage == GL_COMPUTE_SHADER ? "compute:" + variantSource : stage == GL_GEOMETRY_SHADER ? "cube:" + variantSource : stage == GL_VERTEX_SHADER ? "vertex:" + variantSource : variantSource;
+
+	auto it = glShaderVariantCache.find(variantKey);
+	if (it != glShaderVariantCache.end()) {
+		++it->second.refs;
+		it->second.lastUse = ++glShaderVariantCacheCounter;
+		return { it->second.program, TRUE };
+	}
+
+	ShaderCompilationStatus status = compileShader(variantSource.c_str(), shaderName, stage);
+	if (!status.success)
+		return status;
+
+	ShaderVariant& variant = glShaderVariantCache[variantKey];
+	variant.refs = 1;
+	variant.program = status.shaderID;
+	variant.lastUse = ++glShaderVariantCacheCounter;
+	variant.liveChannels = queryLiveChannels(status.shaderID);
+
+	return status;
+}
+
+// Releases shader program acquired with compileShaderVariant()
+void releaseShaderVariant(GLuint program) {
+	for (auto it = glShaderVariantCache.begin(); it != glShaderVariantCache.end(); ++it)
+		if (it->second.program == program) {
+			if (it->second.refs > 0)
+				--it->second.refs;
+
+			trimShaderVariantCache();
+			return;
+		}
+
+	// Not a cached program
+	glDeleteProgram(program);
+}
+
+// Returns live channels mask of the program acquired with compileShaderVariant()
+int getShaderLiveChannels(GLuint program) {
+	for (auto& entry : glShaderVariantCache)
+		if (entry.second.program == program)
+			return entry.second.liveChannels;
+
+	// Not a cached program
+	return queryLiveChannels(program);
+}
+
+// Deletes all cached variants
+void clearShaderVariantCache() {
+	for (auto& entry : glShaderVariantCache)
+		glDeleteProgram(entry.second.program);
+
+	glShaderVariantCache.clear();
+}
+
+// Merges defines of the quality level into shader defines, level defines override shader defines with the same name
+ShaderDefines mergeShaderDefines(const ShaderDefines& defines, const ShaderDefines& levelDefines) {
+	ShaderDefines result = defines;
+
+	for (auto& levelDefine : levelDefines) {
+		auto it = std::find_if(result.begin(), result.end(), [&levelDefine](const std::pair<std::string, std::string>& define) { return define.first == levelDefine.first; });
+
+		if (it != result.end())
+			*it = levelDefine;
+		else
+			result.push_back(levelDefine);
+	}
+
+	return result;
+}
+
+// Releases all variants of the shader
+void releaseShaderVariants(std::vector<GLuint>& variants) {
+	for (GLuint program : variants)
+		releaseShaderVariant(program);
+
+	variants.clear();
+}
+
+// Load shader and then compile with given defines
+// If pack declares quality levels, shader is compiled for each level ahead of time, so switching level never compiles
+// cubeChannels and volumeChannels are masks of channels bound to cubemaps and volumes, see declareChannelSamplers()
+// Returns 0 on success, 1 else
+BOOL compileShaderVariantsFromFile(const std::wstring& path, const ShaderDefines& defines, std::vector<GLuint>& variants, GLenum stage = GL_FRAGMENT_SHADER, int cubeChannels = 0, int volumeChannels = 0) {
+	std::ifstream f(path);
+	std::string str;
+
+	if (!f) {
+
+		std::wcout << "Failed to load Shader file: " << "Failed to load file [" << path << ']' << std::endl;
+		MessageBox(
+			NULL,
+			(L"Failed to load file " + path).c_str(),
+			L"Failed to load Shader file",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	f.seekg(0, std::ios::end);
+	str.reserve(f.tellg());
+	f.seekg(0, std::ios::beg);
+
+	str.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	str = declareChannelSamplers(str, cubeChannels, volumeChannels);
+
+	std::string shaderName = std::filesystem::path(path).filename().string();
+
+	std::vector<GLuint> result;
+
+	if (scQualityLevels.size() == 0) {
+		ShaderCompilationStatus status = compileShaderVariant(str, defines, shaderName.c_str(), stage);
+		if (!status.success)
+			return 1;
+
+		result.push_back(status.shaderID);
+	} else
+		for (size_t level = 0; level < scQualityLevels.size(); ++level) {
+			ShaderCompilationStatus status = compileShaderVariant(str, mergeShaderDefines(defines, scQualityLevels[level]), (shaderName + " (Quality " + std::to_string(level) + ")").c_str(), stage);
+
+			if (!status.success) {
+				releaseShaderVariants(result);
+				return 1;
+			}
+
+			result.push_back(status.shaderID);
+		}
+
+	// Delete previous shader variants only if load successfull
+	releaseShaderVariants(variants);
+	variants = result;
+
+	return 0;
+}
+
+// Returns variant of shader for current quality level
+GLuint selectShaderVariant(const std::vector<GLuint>& variants) {
+	if (variants.size() == 0)
+		return -1;
+
+	if (scQualityLevel < 0 || scQualityLevel >= variants.size())
+		return variants.back();
+
+	return variants[scQualityLevel];
+}
+
+// Selects program of the buffer for current quality level
+void selectBufferShaderVariant(int buffer_id) {
+	glBufferShaderProgramIDs[buffer_id] = selectShaderVariant(glBufferShaderVariants[buffer_id]);
+
+	glBufferShaderLocalSizes[buffer_id][0] = glBufferShaderLocalSizes[buffer_id][1] = glBufferShaderLocalSizes[buffer_id][2] = 1;
+	if (glBufferShaderStages[buffer_id] == GL_COMPUTE_SHADER && glBufferShaderProgramIDs[buffer_id] != -1)
+		glGetProgramiv(glBufferShaderProgramIDs[buffer_id], GL_COMPUTE_WORK_GROUP_SIZE, glBufferShaderLocalSizes[buffer_id]);
+}
+
+// Returns mask of channels bound to cubemap textures or cubemap passes
+int getCubeChannels(const int* inputs) {
+	int mask = 0;
+
+	for (int k = 0; k < MaxChannels; ++k) {
+		if (inputs[k] == -1 || scResources[inputs[k]].empty)
+			continue;
+
+		const SCResource& res = scResources[inputs[k]].resource;
+		if (res.type == CUBEMAP_TEXTURE || (res.type == FRAME_BUFFER && getBufferTarget(res.buffer_id) == GL_TEXTURE_CUBE_MAP))
+			mask |= 1 << k;
+	}
+
+	return mask;
+}
+
+// Returns mask of channels bound to volume textures
+int getVolumeChannels(const int* inputs) {
+	int mask = 0;
+
+	for (int k = 0; k < MaxChannels; ++k)
+		if (inputs[k] != -1 && !scResources[inputs[k]].empty && scResources[inputs[k]].resource.type == VOLUME_TEXTURE)
+			mask |= 1 << k;
+
+	return mask;
+}
+
+// Loads Main shader from file, saves path
+// Samplers of iChannelN are declared by currently bound inputs
+// Returns 0 on success, 1 else
+BOOL loadMainShaderFromFile(const std::wstring& path) {
+	
+	// Set path for main shader in any case
+	glMainShaderPath = path;
+
+	if (scShaderCompilationDeferred)
+		return 0;
+
+	glMainShaderCubeChannels = getCubeChannels(scMainShaderInputs);
+	glMainShaderVolumeChannels = getVolumeChannels(scMainShaderInputs);
+
+	if (compileShaderVariantsFromFile(glMainShaderPath, glMainShaderDefines, glMainShaderVariants, GL_FRAGMENT_SHADER, glMainShaderCubeChannels, glMainShaderVolumeChannels))
+		return 1;
+
+	glMainShaderProgramID = selectShaderVariant(glMainShaderVariants);
+	scRenderGraphDirty = TRUE;
+
+	return 0;
+}
+
+// Reloads Main shader from saved path
+// Returns 0 on success, 1 else
+BOOL reloadMainShader() {
+
+	if (glMainShaderProgramID == -1) { // Not loaded, ignore
+		return 0;
+	} else if (glMainShaderPath == L"") { // Loaded, but no path -> corrupt
+		std::wcout << "Can not load Main shader, Shader path corrupt" << std::endl;
+		return 1;
+	}
+
+	if (compileShaderVariantsFromFile(glMainShaderPath, glMainShaderDefines, glMainShaderVariants, GL_FRAGMENT_SHADER, glMainShaderCubeChannels, glMainShaderVolumeChannels))
+		return 1;
+
+	glMainShaderProgramID = selectShaderVariant(glMainShaderVariants);
+	scRenderGraphDirty = TRUE;
+
+	return 0;
+}
+
+// Unloads Main shader from saved path
+void unloadMainShader() {
+	releaseShaderVariants(glMainShaderVariants);
+	glMainShaderProgramID = -1;
+	scRenderGraphDirty = TRUE;
+
+	glMainShaderPath = L"";
+	glMainShaderDefines.clear();
+}
+
+// Loads Buffer i shader from file, saves path
+// Returns 0 on success, 1 else
+BOOL loadBufferShaderFromFile(const std::wstring& path, int buffer_id) {
+
+	if (buffer_id < 0 || buffer_id >= MaxBuffers) {
+		std::wcout << "Can not load Shader for Buffer " << buffer_id << ", Buffer does not exist, buffer_id corrupt" << std::endl;
+		return 1;
+	}
+
+	// Set path for buffer shader in any case
+	glBufferShaderPath[buffer_id] = path;
+
+	if (scShaderCompilationDeferred)
+		return 0;
+
+	glBufferShaderCubeChannels[buffer_id] = getCubeChannels(scBufferShaderInputs[buffer_id]);
+	glBufferShaderVolumeChannels[buffer_id] = getVolumeChannels(scBufferShaderInputs[buffer_id]);
+
+	if (compileShaderVariantsFromFile(glBufferShaderPath[buffer_id], glBufferShaderDefines[buffer_id], glBufferShaderVariants[buffer_id], glBufferShaderStages[buffer_id], glBufferShaderCubeChannels[buffer_id], glBufferShaderVolumeChannels[buffer_id]))
+		return 1;
+
+	selectBufferShaderVariant(buffer_id);
+	scRenderGraphDirty = TRUE;
+
+	return 0;
+}
+
+// Loads Buffer i shader from saved path
+// Returns 0 on success, 1 else
+BOOL reloadBufferShader(int buffer_id) {
+
+	if (buffer_id < 0 || buffer_id >= MaxBuffers) {
+		std::wcout << "Can not reload Shader for Buffer " << buffer_id << ", Buffer does not exist, buffer_id corrupt" << std::endl;
+		return 1;
+	}
+
+	if (glBufferShaderProgramIDs[buffer_id] == -1) { // Not loaded, ignore
+		return 0;
+	} else if (glBufferShaderPath[buffer_id] == L"") { // Loaded, but no path -> corrupt
+		std::wcout << "Can not reload Shader for " << scBufferNames[buffer_id] << ", Shader path corrupt" << std::endl;
+		return 1;
+	}
+
+	if (compileShaderVariantsFromFile(glBufferShaderPath[buffer_id], glBufferShaderDefines[buffer_id], glBufferShaderVariants[buffer_id], glBufferShaderStages[buffer_id], glBufferShaderCubeChannels[buffer_id], glBufferShaderVolumeChannels[buffer_id]))
+		return 1;
+
+	selectBufferShaderVariant(buffer_id);
+	scRenderGraphDirty = TRUE;
+
+	return 0;
+}
+
+// Unloads Main shader from saved path
+void unloadBufferShader(int buffer_id) {
+	releaseShaderVariants(glBufferShaderVariants[buffer_id]);
+	glBufferShaderProgramIDs[buffer_id] = -1;
+	scRenderGraphDirty = TRUE;
+
+	glBufferShaderPath[buffer_id] = L"";
+	glBufferShaderDefines[buffer_id].clear();
+	// scBufferFrames[bufferId] = 0;
+}
+
+// Drops blocks in flight, stream starts over from the first sample
+void resetSoundReadbacks() {
+	for (int i = 0; i < SoundReadbacks; ++i)
+		if (glSoundReadbackFences[i]) {
+			glDeleteSync(glSoundReadbackFences[i]);
+			glSoundReadbackFences[i] = 0;
+		}
+
+	scSoundReadbackHead = 0;
+	scSoundReadbackCount = 0;
+	scSoundBlock = 0;
+}
+
+// Opens playback device (or WAV file) fed by Sound shader
+// Returns 0 on success, 1 else
+BOOL openSoundOutput() {
+	if (scSoundSink)
+		return 0;
+
+	// Lookahead and one more block always fit, so readback never drops samples
+	scSoundRing = new SoundOutput::SampleRing((size_t) (SoundLookaheadBlocks + 1) * SoundBlockFrames * SoundOutput::Channels);
+
+	if (scSoundWavPath != L"")
+		scSoundSink = new SoundOutput::WavFileSink(scSoundWavPath, (unsigned long long) (scSoundWavSeconds * SoundOutput::SampleRate));
+	else
+		scSoundSink = new SoundOutput::WaveOutSink();
+
+	std::string error;
+	if (scSoundSink->open(scSoundRing, error)) {
+		std::wcout << "Sound output error: " << error.c_str() << std::endl;
+
+		delete scSoundSink;
+		delete scSoundRing;
+		scSoundSink = nullptr;
+		scSoundRing = nullptr;
+		return 1;
+	}
+
+	scSoundSink->setPaused(scPaused);
+	scSoundSink->start();
+
+	return 0;
+}
+
+// Stops playback, queued samples are dropped
+void closeSoundOutput() {
+	if (!scSoundSink)
+		return;
+
+	if (scSoundSink->getUnderruns())
+		std::wcout << "Sound output :: " << scSoundSink->getUnderruns() << " underruns" << std::endl;
+
+	delete scSoundSink;
+	delete scSoundRing;
+	scSoundSink = nullptr;
+	scSoundRing = nullptr;
+}
+
+// Loads Sound shader from file, saves path and opens sound output
+// Returns 0 on success, 1 else
+BOOL loadSoundShaderFromFile(const std::wstring& path) {
+
+	// Set path for sound shader in any case
+	glSoundShaderPath = path;
+
+	if (compileShaderVariantsFromFile(glSoundShaderPath, glSoundShaderDefines, glSoundShaderVariants))
+		return 1;
+
+	glSoundShaderProgramID = selectShaderVariant(glSoundShaderVariants);
+
+	resetSoundReadbacks();
+	closeSoundOutput();
+
+	return openSoundOutput();
+}
+
+// Reloads Sound shader from saved path, playback continues from the current sample
+// Returns 0 on success, 1 else
+BOOL reloadSoundShader() {
+
+	if (glSoundShaderProgramID == -1) { // Not loaded, ignore
+		return 0;
+	} else if (glSoundShaderPath == L"") { // Loaded, but no path -> corrupt
+		std::wcout << "Can not load Sound shader, Shader path corrupt" << std::endl;
+		return 1;
+	}
+
+	if (compileShaderVariantsFromFile(glSoundShaderPath, glSoundShaderDefines, glSoundShaderVariants))
+		return 1;
+
+	glSoundShaderProgramID = selectShaderVariant(glSoundShaderVariants);
+
+	return 0;
+}
+
+// Unloads Sound shader and stops playback
+void unloadSoundShader() {
+	closeSoundOutput();
+	resetSoundReadbacks();
+
+	releaseShaderVariants(glSoundShaderVariants);
+	glSoundShaderProgramID = -1;
+
+	glSoundShaderPath = L"";
+	glSoundShaderDefines.clear();
+}
+
+
+// Switches all shaders to variants compiled for the given quality level
+void applyQualityLevel(int level) {
+	if (scQualityLevels.size() == 0)
+		return;
+
+	scQualityLevel = std::clamp(level, 0, (int) scQualityLevels.size() - 1);
+
+	if (glMainShaderVariants.size())
+		glMainShaderProgramID = selectShaderVariant(glMainShaderVariants);
+
+	for (int i = 0; i < MaxBuffers; ++i)
+		if (glBufferShaderVariants[i].size())
+			selectBufferShaderVariant(i);
+
+	if (glSoundShaderVariants.size())
+		glSoundShaderProgramID = selectShaderVariant(glSoundShaderVariants);
+
+	// Level variants may sample different channels
+	scRenderGraphDirty = TRUE;
+
+	// Timer results of the previous level are still in flight
+	scQualityOverBudget = 0;
+	scQualityUnderBudget = 0;
+	scQualitySettleFrames = PassTimerLatency * 2;
+}
+
+// Removes all quality levels of the pack
+// Shaders should be reloaded after this call to drop variants of removed levels
+void resetQualityLevels() {
+	scQualityLevels.clear();
+	scQualityLevel = -1;
+	scQualityInitialLevel = -1;
+	scQualityGovernorEnabled = TRUE;
+	scQualityFrameTime = 0.0;
+	scQualityOverBudget = 0;
+	scQualityUnderBudget = 0;
+	scQualitySettleFrames = 0;
+	scQualityUpgradeBackoff = 1;
+}
+
+BOOL parseShaderDefinesObject(const nlohmann::json& object, ShaderDefines& defines, const std::wstring& sectionName);
+
+// Parses "defines" entry of the shader section into list of defines
+// "defines" is json:object mapping define name to json:number / json:string / json:bool / json:null (empty define)
+// Returns 0 on success, 1 else
+BOOL parseShaderDefines(const nlohmann::json& section, ShaderDefines& defines, const std::wstring& sectionName) {
+
+	defines.clear();
+
+	if (!section.contains("defines"))
+		return 0;
+
+	if (!section["defines"].is_object()) {
+
+		std::wcout << "JSON :: Defines entry of " << sectionName << " section should be object :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Defines entry of " + sectionName + L" section should be object\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	return parseShaderDefinesObject(section["defines"], defines, sectionName);
+}
+
+// Parses json:object of defines, see parseShaderDefines()
+// Returns 0 on success, 1 else
+BOOL parseShaderDefinesObject(const nlohmann::json& object, ShaderDefines& defines, const std::wstring& sectionName) {
+
+	for (auto& define : object.items()) {
+
+		// Only identifiers are allowed as names
+		bool validName = define.key().size() != 0 && !std::isdigit((unsigned char) define.key()[0]);
+		for (char c : define.key())
+			validName = validName && (std::isalnum((unsigned char) c) || c == '_');
+
+		if (!validName) {
+			std::wstring name = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(define.key());
+
+			std::wcout << "JSON :: Define " << name << " of " << sectionName << " section is not valid identifier :: " << scPackPath << std::endl;
+			MessageBox(
+				NULL,
+				(L"Define " + name + L" of " + sectionName + L" section is not valid identifier\n" + scPackPath).c_str(),
+				L"Failed to setup Pack",
+				MB_ICONERROR | MB_OK
+			);
+
+			return 1;
+		}
+
+		if (define.value().is_string())
+			defines.push_back({ define.key(), define.value().get<std::string>(), define.value() });
+		else if (define.value().is_boolean())
+			defines.push_back({ define.key(), define.value().get<bool>() ? "1" : "0", define.value() });
+		else if (define.value().is_null())
+			defines.push_back({ define.key(), "", define.value() });
+		else if (define.value().is_number())
+			defines.push_back({ define.key(), define.value().dump(), define.value() });
+		else {
+			std::wstring name = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(define.key());
+
+			std::wcout << "JSON :: Define " << name << " of " << sectionName << " section should be number, string, bool or null :: " << scPackPath << std::endl;
+			MessageBox(
+				NULL,
+				(L"Define " + name + L" of " + sectionName + L" section should be number, string, bool or null\n" + scPackPath).c_str(),
+				L"Failed to setup Pack",
+				MB_ICONERROR | MB_OK
+			);
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Parses "Quality" section of the pack into scQualityLevels
+// Section "Quality" in JSON is one of the following types:
+// 1. json:array of levels ordered from the lowest to the highest quality, each level is value of QUALITY define
+//    Most common: { "Quality": [ 0, 1, 2 ] }
+//
+// 2. json:object containing:
+//    1. "levels": json:array (mandatory) of levels ordered from the lowest to the highest quality, each level is one of:
+//       1. json:number / json:string / json:bool: value of define named by "define" key
+//       2. json:object: defines of this level, see "defines" of Main section
+//    2. "define": json:string name of define for non-object levels (optional, default is QUALITY)
+//    3. "initial": json:number index of level used after load (optional, default is the highest)
+//    4. "governor": json:bool select level automatically to hold selected FPS (optional, default is true)
+// Returns 0 on success, 1 else
+BOOL parseQualityLevels(const nlohmann::json& j) {
+
+	resetQualityLevels();
+
+	if (!j.contains("Quality") || j["Quality"].is_null())
+		return 0;
+
+	auto quality = j["Quality"];
+
+	nlohmann::json levels;
+	std::string defineName = "QUALITY";
+
+	if (quality.is_array())
+		levels = quality;
+	else if (quality.is_object() && quality.contains("levels") && quality["levels"].is_array()) {
+		levels = quality["levels"];
+
+		if (quality.contains("define") && quality["define"].is_string())
+			defineName = quality["define"].get<std::string>();
+
+		if (quality.contains("governor") && quality["governor"].is_boolean())
+			scQualityGovernorEnabled = quality["governor"].get<bool>();
+	} else {
+
+		std::wcout << "JSON :: Section Quality should be array of levels or object containing levels array :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Section Quality should be array of levels or object containing levels array\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	for (int i = 0; i < levels.size(); ++i) {
+		ShaderDefines defines;
+
+		// Same rules as for "defines" section
+		nlohmann::json level = levels[i];
+		if (!level.is_object()) {
+			level = nlohmann::json::object();
+			level[defineName] = levels[i];
+		}
+
+		if (parseShaderDefinesObject(level, defines, L"Quality level " + std::to_wstring(i))) {
+			resetQualityLevels();
+			return 1;
+		}
+
+		scQualityLevels.push_back(defines);
+	}
+
+	scQualityLevel = (int) scQualityLevels.size() - 1;
+
+	if (quality.is_object() && quality.contains("initial") && quality["initial"].is_number_integer()) {
+		scQualityInitialLevel = std::clamp(quality["initial"].get<int>(), 0, max((int) scQualityLevels.size() - 1, 0));
+		scQualityLevel = scQualityInitialLevel;
+	}
+
+	std::wcout << "JSON :: Quality levels :: " << scQualityLevels.size() << ", initial level :: " << scQualityLevel << std::endl;
+
+	return 0;
+}
+
+// Parses "Textures" section of the pack
+// Section "Textures" in JSON is json:object containing:
+//    1. "padToPowerOfTwo": json:bool pad still images with transparent pixels to power of two size as older
+//       versions did, iChannelResolution contains padded size (optional, default is false)
+void parseTextureOptions(const nlohmann::json& j) {
+
+	scTexturePadding = FALSE;
+
+	if (!j.contains("Textures") || !j["Textures"].is_object())
+		return;
+
+	auto textures = j["Textures"];
+
+	if (textures.contains("padToPowerOfTwo") && textures["padToPowerOfTwo"].is_boolean())
+		scTexturePadding = textures["padToPowerOfTwo"].get<bool>();
+
+	if (scTexturePadding)
+		std::wcout << "JSON :: Textures :: still images are padded to power of two" << std::endl;
+}
+
+// Parses sampling keys of input json:object
+// Input may contain:
+//    1. "filter": json:string "nearest", "linear" or "mipmap" (optional, default depends on input type)
+//    2. "wrap": json:string "repeat", "clamp" or "mirror" (optional, default depends on input type)
+//    3. "vflip": json:bool images only, show image with the first row at the bottom as shadertoy does (optional, default is true)
+//    4. "output": json:number buffers only, index of the buffer render target to read, below "outputs" of the buffer (optional, default is 0)
+// Returns 0 on success, 1 else
+BOOL parseInputSampler(const nlohmann::json& input, SCResource& res, InputSampler& sampler, const std::wstring& sectionName, int inputID) {
+	static const std::wstring filters[3] = { L"nearest", L"linear", L"mipmap" };
+	static const std::wstring wraps[3] = { L"repeat", L"clamp", L"mirror" };
+
+	std::wstring error;
+
+	if (input.contains("filter")) {
+		std::wstring filter = input["filter"].is_string() ? std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input["filter"].get<std::string>()) : L"";
+		transform(filter.begin(), filter.end(), filter.begin(), ::towlower);
+
+		for (int i = 0; i < 3; ++i)
+			if (filter == filters[i])
+				sampler.filter = (InputFilter) i;
+
+		if (sampler.filter == DEFAULT_FILTER)
+			error = L"should have filter equal to nearest, linear or mipmap";
+	}
+
+	if (input.contains("wrap")) {
+		std::wstring wrap = input["wrap"].is_string() ? std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input["wrap"].get<std::string>()) : L"";
+		transform(wrap.begin(), wrap.end(), wrap.begin(), ::towlower);
+
+		for (int i = 0; i < 3; ++i)
+			if (wrap == wraps[i])
+				sampler.wrap = (InputWrap) i;
+
+		if (sampler.wrap == DEFAULT_WRAP)
+			error = L"should have wrap equal to repeat, clamp or mirror";
+	}
+
+	if (input.contains("vflip")) {
+		if (!input["vflip"].is_boolean())
+			error = L"should have boolean vflip";
+		else if (res.type == IMAGE_TEXTURE)
+			res.vflip = input["vflip"].get<bool>();
+	}
+
+	if (input.contains("output")) {
+		if (!input["output"].is_number_integer() || input["output"].get<int>() < 0 || input["output"].get<int>() >= MaxBufferOutputs)
+			error = L"should have output integer from 0 to " + std::to_wstring(MaxBufferOutputs - 1);
+		else if (res.type == FRAME_BUFFER)
+			res.output = input["output"].get<int>();
+	}
+
+	if (!error.empty()) {
+		std::wcout << "JSON :: Input " << inputID << " of section " << sectionName << " " << error << " :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Input " + std::to_wstring(inputID) + L" of section " + sectionName + L" " + error + L"\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	// Mip chain of image is made once on upload, chain of buffer follows every frame written
+	res.mipmaps = (res.type == IMAGE_TEXTURE || res.type == CUBEMAP_TEXTURE || res.type == VOLUME_TEXTURE) && sampler.filter == MIPMAP_FILTER;
+
+	return 0;
+}
+
+// Writes sampling keys that differ from defaults into input json:object
+void inputSamplerToJSON(nlohmann::json& input, const SCResource& res, const InputSampler& sampler) {
+	static const char* filters[3] = { "nearest", "linear", "mipmap" };
+	static const char* wraps[3] = { "repeat", "clamp", "mirror" };
+
+	if (sampler.filter != DEFAULT_FILTER)
+		input["filter"] = filters[sampler.filter];
+	if (sampler.wrap != DEFAULT_WRAP)
+		input["wrap"] = wraps[sampler.wrap];
+	if (res.type == IMAGE_TEXTURE && !res.vflip)
+		input["vflip"] = false;
+	if (res.type == FRAME_BUFFER && res.output)
+		input["output"] = res.output;
+}
+
+// Parses "faces" key of cubemap input, json:array of six paths (+X, -X, +Y, -Y, +Z, -Z) relative to pack
+// Paths are joined into path of the resource, see splitCubemapPath()
+// Returns 0 on success, 1 else
+BOOL parseCubemapFaces(const nlohmann::json& input, SCResource& res, const std::wstring& sectionName, int inputID) {
+	auto faces = input["faces"];
+	BOOL valid = faces.is_array() && faces.size() == 6;
+
+	for (int f = 0; valid && f < 6; ++f)
+		valid = faces[f].is_string();
+
+	if (!valid) {
+		std::wcout << "JSON :: Input " << inputID << " of section " << sectionName << " should have faces array of six string paths :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Input " + std::to_wstring(inputID) + L" of section " + sectionName + L" should have faces array of six string paths\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	auto parent_path = std::filesystem::path(scPackPath).parent_path();
+
+	res.path.clear();
+	for (int f = 0; f < 6; ++f) {
+		std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(faces[f].get<std::string>());
+		res.path += (f ? L"|" : L"") + std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path)).wstring();
+	}
+
+	std::wcout << "JSON :: " << sectionName << " Shader Input " << inputID << " faces :: " << res.path << std::endl;
+
+	return 0;
+}
+
+// Parses layout of raw volume input, volume without these keys is BIN file with header:
+//    1. "size": json:array of three json:number width, height and depth in voxels
+//    2. "channels": json:number 1 to 4 interleaved channels of voxel (optional, default is 1)
+//    3. "format": json:string channel type "uint8", "uint16", "float16" or "float32" (optional, default is "uint8")
+// Returns 0 on success, 1 else
+BOOL parseVolumeLayout(const nlohmann::json& input, SCResource& res, const std::wstring& sectionName, int inputID) {
+	res.volume = VolumeTexture::Layout();
+
+	if (!input.contains("size") && !input.contains("channels") && !input.contains("format"))
+		return 0;
+
+	BOOL valid = input.contains("size") && input["size"].is_array() && input["size"].size() == 3;
+	for (int d = 0; valid && d < 3; ++d)
+		valid = input["size"][d].is_number_integer() && input["size"][d].get<int>() > 0;
+
+	if (valid) {
+		res.volume.width = input["size"][0].get<int>();
+		res.volume.height = input["size"][1].get<int>();
+		res.volume.depth = input["size"][2].get<int>();
+		res.volume.channels = 1;
+		res.volume.format = VolumeTexture::UINT8;
+	}
+
+	if (valid && input.contains("channels")) {
+		valid = input["channels"].is_number_integer() && input["channels"].get<int>() >= 1 && input["channels"].get<int>() <= 4;
+		if (valid)
+			res.volume.channels = input["channels"].get<int>();
+	}
+
+	if (valid && input.contains("format")) {
+		valid = input["format"].is_string() && VolumeTexture::parseFormat(input["format"].get<std::string>()) != VolumeTexture::UNKNOWN_FORMAT;
+		if (valid)
+			res.volume.format = VolumeTexture::parseFormat(input["format"].get<std::string>());
+	}
+
+	if (!valid) {
+		std::wcout << "JSON :: Input " << inputID << " of section " << sectionName << " should have size array of three positive integers, channels from 1 to 4 and format uint8, uint16, float16 or float32 :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Input " + std::to_wstring(inputID) + L" of section " + sectionName + L" should have size array of three positive integers, channels from 1 to 4 and format uint8, uint16, float16 or float32\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		res.volume = VolumeTexture::Layout();
+		return 1;
+	}
+
+	std::wcout << "JSON :: " << sectionName << " Shader Input " << inputID << " raw volume :: " << res.volume.width << " x " << res.volume.height << " x " << res.volume.depth << ", " << res.volume.channels << " x " << VolumeTexture::formatName(res.volume.format) << std::endl;
+
+	return 0;
+}
+
+// Writes layout of raw volume input, BIN file has none
+void volumeLayoutToJSON(nlohmann::json& input, const VolumeTexture::Layout& layout) {
+	if (layout.empty())
+		return;
+
+	input["size"] = { layout.width, layout.height, layout.depth };
+	if (layout.channels != 1)
+		input["channels"] = layout.channels;
+	if (layout.format != VolumeTexture::UINT8)
+		input["format"] = VolumeTexture::formatName(layout.format);
+}
+
+// Writes path of cubemap input as "path" of cross image or "faces" array relative to pack
+void cubemapPathToJSON(nlohmann::json& input, const std::wstring& path, const std::filesystem::path& basePackPath) {
+	std::vector<std::wstring> files = splitCubemapPath(path);
+
+	if (files.size() == 1) {
+		input["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(files[0]), basePackPath).string();
+		return;
+	}
+
+	input["faces"] = nlohmann::json::array();
+	for (auto& file : files)
+		input["faces"].push_back(std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(file), basePackPath).string());
+}
+
+// Resets clock of buffers together with time of the scene
+// With keepTime only time not simulated yet is dropped, buffers continue from their iTime and iFrame
+void resetSimulationClock(BOOL keepTime = FALSE) {
+	scSimulationAccumulator = 0.0;
+
+	if (keepTime)
+		return;
+
+	scSimulationTime = 0.0;
+	scSimulationFrame = 0;
+}
+
+// Parses "Simulation" section of the pack
+// Section "Simulation" in JSON is json:object containing:
+//    1. "rate": json:number buffer steps per second, buffers are rendered once per frame if missing
+//    2. "maxSteps": json:number limit of steps per frame, time above the limit is dropped (optional, default is 4)
+// Returns 0 on success, 1 else
+BOOL parseSimulationOptions(const nlohmann::json& j) {
+
+	scSimulationRate = 0.0;
+	scSimulationMaxSteps = 4;
+
+	if (!j.contains("Simulation"))
+		return 0;
+
+	auto simulation = j["Simulation"];
+
+	if (!simulation.is_object() || !simulation.contains("rate") || !simulation["rate"].is_number() || simulation["rate"].get<double>() <= 0.0
+		|| (simulation.contains("maxSteps") && (!simulation["maxSteps"].is_number_integer() || simulation["maxSteps"].get<int>() < 1))) {
+
+		std::wcout << "JSON :: Section Simulation should be object containing positive rate and optional positive integer maxSteps :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Section Simulation should be object containing positive rate and optional positive integer maxSteps\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	scSimulationRate = simulation["rate"].get<double>();
+
+	if (simulation.contains("maxSteps"))
+		scSimulationMaxSteps = simulation["maxSteps"].get<int>();
+
+	std::wcout << "JSON :: Simulation :: " << scSimulationRate << " steps per second, at most " << scSimulationMaxSteps << " steps per frame" << std::endl;
+
+	return 0;
+}
+
+// Section "Buffers" in JSON is json:array of named buffer sections (optional), each one is json:object containing
+//  the same entries as "Buffer[A/B/C/D]" section and:
+//    1. "name": json:string unique name of the buffer, used as input type to read the buffer from other passes (mandatory)
+// Named buffers take slots after Buffer D, names are registered before any section is parsed, so any pass can read any buffer
+// Returns 0 on success, 1 else
+BOOL parseBufferNames(const nlohmann::json& j) {
+
+	if (!j.contains("Buffers"))
+		return 0;
+
+	auto buffers = j["Buffers"];
+
+	if (!buffers.is_array() || buffers.size() > MaxBuffers - 4) {
+
+		std::wcout << "JSON :: Section Buffers should be array of at most " << (MaxBuffers - 4) << " buffers :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Section Buffers should be array of at most " + std::to_wstring(MaxBuffers - 4) + L" buffers\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	for (int i = 0; i < buffers.size(); ++i) {
+		std::wstring name;
+
+		if (buffers[i].is_object() && buffers[i].contains("name") && buffers[i]["name"].is_string())
+			name = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(buffers[i]["name"].get<std::string>());
+
+		// Empty name is reserved for empty input
+		if (name.empty() || findBufferByName(name) != -1) {
+
+			std::wcout << "JSON :: Buffer " << i << " of section Buffers should be object containing unique name :: " << scPackPath << std::endl;
+			MessageBox(
+				NULL,
+				(L"Buffer " + std::to_wstring(i) + L" of section Buffers should be object containing unique name\n" + scPackPath).c_str(),
+				L"Failed to setup Pack",
+				MB_ICONERROR | MB_OK
+			);
+
+			return 1;
+		}
+
+		scBufferNames[4 + i] = name;
+	}
+
+	return 0;
+}
+
+// Parses "Sound" section of the pack and loads Sound shader
+// Section "Sound" in JSON is one of the following types:
+// 1. json:string: only path to sound shader
+// 2. json:object containing:
+//    1. "path": json:string path to sound shader file (relative to pack or absolute) (mandatory)
+//    2. "defines": json:object (optional) the same as in Main section
+// Sound shader has no inputs, it writes vec4(left, right, 0, 1) for sample at iSoundOffset + y * iSoundWidth + x
+// Returns 0 on success, 1 else
+BOOL parseSoundSection(const nlohmann::json& j) {
+
+	if (!j.contains("Sound"))
+		return 0;
+
+	auto sound = j["Sound"];
+
+	if (!sound.is_string() && !(sound.is_object() && sound.contains("path") && sound["path"].is_string())) {
+
+		std::wcout << "JSON :: Sound section should be path string or object containing path string :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Sound section should be path string or object containing path string\n" + scPackPath).c_str(),
+			L"Failed to setup Pack",
+			MB_ICONERROR | MB_OK
+		);
+
+		return 1;
+	}
+
+	if (sound.is_object() && parseShaderDefines(sound, glSoundShaderDefines, L"Sound"))
+		return 1;
+
+	// Construct absolute path
+	auto parent_path = std::filesystem::path(scPackPath).parent_path();
+	std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(sound.is_string() ? sound.get<std::string>() : sound["path"].get<std::string>());
+	path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+
+	std::wcout << "JSON :: Sound Shader path :: " << path << std::endl;
+
+	// Failed compilation or missing device is reported and does not prevent the rest of the pack
+	loadSoundShaderFromFile(path);
+
+	return 0;
+}
+
+// Converts list of defines back to "defines" json:object
+// Values are written as they were parsed, so numbers, bools and nulls keep their types
+nlohmann::json shaderDefinesToJSON(const ShaderDefines& defines) {
+	nlohmann::json j = nlohmann::json::object();
+
+	for (auto& define : defines)
+		j[define.first] = define.value;
+
+	return j;
+}
+
+// Checks that buffer inputs read outputs declared by their buffers, called once all buffer sections are parsed
+// Inputs reading missing outputs are unloaded, they would sample incomplete texture
+// Returns 0 on success, 1 else
+BOOL validateBufferOutputs() {
+	BOOL error = FALSE;
+
+	for (int pass = -1; pass < MaxBuffers; ++pass) {
+		int* inputs = pass == -1 ? scMainShaderInputs : scBufferShaderInputs[pass];
+
+		for (int i = 0; i < MaxChannels; ++i) {
+			if (inputs[i] == -1 || scResources[inputs[i]].empty)
+				continue;
+
+			const SCResource& res = scResources[inputs[i]].resource;
+			if (res.type != FRAME_BUFFER || res.output < glBufferShaderOutputs[res.buffer_id])
+				continue;
+
+			std::wstring sectionName = pass == -1 ? L"Main" : pass < 4 ? std::wstring(L"Buffer") + L"ABCD"[pass] : L"Buffer [" + scBufferNames[pass] + L"]";
+			std::wstring message = L"Input " + std::to_wstring(i) + L" of section " + sectionName + L" should have output integer from 0 to " + std::to_wstring(glBufferShaderOutputs[res.buffer_id] - 1) + L", " + resourceToShordDescription(scResources[inputs[i]].resource) + L" declares " + std::to_wstring(glBufferShaderOutputs[res.buffer_id]) + L" outputs";
+
+			std::wcout << "JSON :: " << message << " :: " << scPackPath << std::endl;
+			if (!error)
+				MessageBox(
+					NULL,
+					(message + L"\n" + scPackPath).c_str(),
+					L"Failed to setup Pack",
+					MB_ICONERROR | MB_OK
+				);
+
+			if (pass == -1)
+				unloadMainShaderResource(i);
+			else
+				unloadBufferShaderResource(pass, i);
+
+			error = TRUE;
+		}
+	}
+
+	return error;
+}
+
+// Parses sections of the pack from scPackPath and loads them
+// Stops at the first invalid section, sections loaded before it stay
+void parsePack() {
+	// Read JSON from path & validate
+	std::ifstream f(scPackPath);
+	std::string str;
+
+	if (!f) {
+
+		std::wcout << "JSON :: Failed to open Pack file :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Failed to open file " + scPackPath).c_str(),
+			L"Failed to load Pack file",
+			MB_ICONERROR | MB_OK
+		);
+
+		return;
+	}
+
+	f.seekg(0, std::ios::end);
+	str.reserve(f.tellg());
+	f.seekg(0, std::ios::beg);
+
+	str.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+	try {
+
+		auto j = nlohmann::json::parse(str);
+
+		// Quality levels are required before shaders compilation
+		if (parseQualityLevels(j))
+			return;
+
+		// Texture options are required before inputs load
+		parseTextureOptions(j);
+
+		if (parseSimulationOptions(j))
+			return;
+
+		// Names are required before inputs of any section are parsed
+		if (parseBufferNames(j))
+			return;
+
+		if (parseSoundSection(j))
+			return;
+
+		if (!j.contains("Main")) {
+
+			std::wcout << "JSON :: Missing Main section in Pack file :: " << scPackPath << std::endl;
+			MessageBox(
+				NULL,
+				(L"Missing Main section in Pack file\n" + scPackPath).c_str(),
+				L"Failed to setup Pack",
+				MB_ICONERROR | MB_OK
+			);
+
+			return;
+		}
+
+		auto mainShader = j["Main"];
+
+		// Section "Main" in JSON is one of the following types:
+		// 1. json:string: only path to main shader, does not contain buffers or inputs
+		//    Most common: { "Main": "/home/work/bed/forever.glsl" }
+		//
+		// 2. json:object containing:
+		//    1. "path": json:string path to main shader file (relative to program or absolute) (mandatory)
+		//    2. "inputs": json:array of json:objects (optional) describing shader inputs containing:
+		//       1. "type": json:string one of following (any case) (mandatory):
+		//          1. BufferA
+		// 		    2. BufferB
+		// 		    3. BufferC
+		// 		    4. BufferD
+		// 		       (or name of the buffer from Buffers section)
+		//          5. Image
+		// 		    6. Microphone
+		// 		    7. Webcamera
+		// 		    8. Keyboard
+		// 		    9. Audio
+		// 		    10. Video
+		// 		    11. Cubemap
+		// 		    12. Volume
+		// 	     2. "path": json:string path to file location (relative to program or absolute) (only for Image, Video, Audio, Cubemap and Volume types)
+		// 	        Cubemap path is image of horizontal cross (4 x 3 faces)
+		// 	     3. "faces": json:array of six json:string paths of +X, -X, +Y, -Y, +Z and -Z faces (Cubemap only, replaces path)
+		// 	     4. "size", "channels" and "format": layout of raw volume file without BIN header (Volume only), see parseVolumeLayout()
+		//    3. "defines": json:object (optional) of compile-time constants injected as #define after #version line:
+		//       { "ITERATIONS": 64, "USE_AO": true, "PALETTE": "vec3(0.1, 0.2, 0.3)", "FAST": null }
+
+		if (mainShader.is_string()) {
+
+			// Try to open shader from file and don't care
+			// Preserve old path
+			auto old_path = std::filesystem::current_path();
+			auto parent_path = std::filesystem::path(scPackPath).parent_path();
+			std::filesystem::current_path(parent_path);
+
+			// Construct absolute path
+			std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(mainShader);
+			path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+
+			// Restore old path
+			std::filesystem::current_path(old_path);
+
+			std::wcout << "JSON :: Main Shader path :: " << path << std::endl;
+
+			loadMainShaderFromFile(path);
+
+			return;
+
+		} else if (mainShader.is_object()) {
+
+			// Validate containing Main shader path
+			if (!mainShader.contains("path") || !mainShader["path"].is_string()) {
+
+				std::wcout << "JSON :: Main section should contain path string :: " << scPackPath << std::endl;
+				MessageBox(
+					NULL,
+					(L"Main section should contain path string\n" + scPackPath).c_str(),
+					L"Failed to setup Pack",
+					MB_ICONERROR | MB_OK
+				);
+
+				return;
+			}
+
+			// Try to open shader from file and don't care
+			// Preserve old path
+			auto old_path = std::filesystem::current_path();
+			auto parent_path = std::filesystem::path(scPackPath).parent_path();
+			std::filesystem::current_path(parent_path);
+
+			// Construct absolute path
+			std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(mainShader["path"]);
+			path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+
+			// Restore old path
+			std::filesystem::current_path(old_path);
+
+			std::wcout << "JSON :: Main Shader path :: " << path << std::endl;
+
+			if (parseShaderDefines(mainShader, glMainShaderDefines, L"Main"))
+				return;
+
+			loadMainShaderFromFile(path);
+
+			if (mainShader.contains("inputs")) {
+				if (!mainShader["inputs"].is_array()) {
+
+					std::wcout << "JSON :: Inputs entry of Main section should be array :: " << scPackPath << std::endl;
+					MessageBox(
+						NULL,
+						(L"Inputs entry of Main section should be array\n" + scPackPath).c_str(),
+						L"Failed to setup Pack",
+						MB_ICONERROR | MB_OK
+					);
+
+					return;
+				}
+
+				// Not error, however..
+				if (mainShader["inputs"].size() > MaxChannels)
+					std::wcout << "Warning :: JSON :: Main Shader has " << mainShader["inputs"].size() << " inputs, but at most " << MaxChannels << " supported :: " << scPackPath << std::endl;
+
+				for (int i = 0; i < mainShader["inputs"].size(); ++i) {
+
+					if (i >= MaxChannels)
+						break;
+
+					auto input = mainShader["inputs"][i];
+
+					if (input.is_null()) // Skip null
+						continue;
+
+					if (!input.is_object()) { // Input must be object or string buffer name
+
+						if (!input.is_string()) {
+							std::wcout << "JSON :: Input " << i << " of section Main should be object or string containing input Buffer name :: " << scPackPath << std::endl;
+							MessageBox(
+								NULL,
+								(L"Input " + std::to_wstring(i) + L" of section Main should be object or string containing input Buffer name\n" + scPackPath).c_str(),
+								L"Failed to setup Pack",
+								MB_ICONERROR | MB_OK
+							);
+
+							return;
+						}
+
+						std::wstring type = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input.get<std::string>());
+
+						transform(type.begin(), type.end(), type.begin(), ::towlower);
+
+						SCResource res;
+						res.type = FRAME_BUFFER;
+
+						if (type == L"buffera") // Buffer A input
+							res.buffer_id = 0;
+						else if (type == L"bufferb") // Buffer B input
+							res.buffer_id = 1;
+						else if (type == L"bufferc") // Buffer C input
+							res.buffer_id = 2;
+						else if (type == L"bufferd")  // Buffer D input
+							res.buffer_id = 3;
+						else if (findBufferByName(type) != -1) // Named buffer input
+							res.buffer_id = findBufferByName(type);
+						else if (type == L"")
+							continue;
+						else {
+							std::wcout << "JSON :: Input " << i << " of section Main contains invalid buffer name " << type << " :: " << scPackPath << std::endl;
+							MessageBox(
+								NULL,
+								(L"Input " + std::to_wstring(i) + L" of section Main contains invalid buffer name " + type + L"\n" + scPackPath).c_str(),
+								L"Failed to setup Pack",
+								MB_ICONERROR | MB_OK
+							);
+
+							return;
+						}
+
+						loadMainShaderResource(res, i);
+
+						continue;
+					}
+
+					if (!input.contains("type") || !input["type"].is_string()) {
+
+						std::wcout << "JSON :: Input " << i << " of section Main should have string containing type :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(L"Input " + std::to_wstring(i) + L" of section Main should have string containing type\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
+
+						return;
+					}
+
+					std::wstring type = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input["type"].get<std::string>());
+
+					transform(type.begin(), type.end(), type.begin(), ::towlower);
+
+					SCResource res;
+					bool path_required = false;
+					bool assume_empty = false;
+
+					// 1. BufferA
+					// 2. BufferB
+					// 3. BufferC
+					// 4. BufferD
+					// 5. Image
+					// 6. Microphone
+					// 7. Webcamera
+					// 8. Keyboard
+					// 9. Audio
+					// 10. Video
+					// 11. Cubemap
+					// 12. Volume
+
+					if (type == L"buffera") { // Buffer A input
+						res.type = FRAME_BUFFER;
+						res.buffer_id = 0;
+					} else if (type == L"bufferb") { // Buffer B input
+						res.type = FRAME_BUFFER;
+						res.buffer_id = 1;
+					} else if (type == L"bufferc") { // Buffer C input
+						res.type = FRAME_BUFFER;
+						res.buffer_id = 2;
+					} else if (type == L"bufferd") { // Buffer D input
+						res.type = FRAME_BUFFER;
+						res.buffer_id = 3;
+					} else if (findBufferByName(type) != -1) { // Named buffer input
+						res.type = FRAME_BUFFER;
+						res.buffer_id = findBufferByName(type);
+					} else if (type == L"image") { // Image input
+						res.type = IMAGE_TEXTURE;
+						path_required = true;
+					} else if (type == L"microphone") { // Microphone, optional path of WAV file to replay instead of capture
+						res.type = MIC_TEXTURE;
+						path_required = input.contains("path");
+					} else if (type == L"webcamera") { // Webcamera
+						std::wcout << "Incomplete :: JSON :: Main Shader Input :: Webcamera" << std::endl;
+						assume_empty = true;
+					} else if (type == L"keyboard") { // Keyboard, optional path of key script
+						res.type = KEYBOARD_TEXTURE;
+						path_required = input.contains("path");
+					} else if (type == L"audio") { // Audio
+						res.type = AUDIO_TEXTURE;
+						path_required = true;
+					} else if (type == L"video") { // Video
+						res.type = VIDEO_TEXTURE;
+						path_required = true;
+					} else if (type == L"cubemap") { // Cubemap, cross image or six face images
+						res.type = CUBEMAP_TEXTURE;
+						path_required = !input.contains("faces");
+					} else if (type == L"volume") { // Volume, BIN or raw file
+						res.type = VOLUME_TEXTURE;
+						path_required = true;
+					} else {
+						std::wcout << "JSON :: Input " << i << " of section Main is unsupported type " << type << " :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(L"Input " + std::to_wstring(i) + L" of section Main is unsupported type " + type + L"\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
+
+						return;
+					}
+
+					if (assume_empty)
+						continue;
+
+					if (path_required) {
+						if (!input.contains("path") || !input["path"].is_string()) {
+
+							std::wcout << "JSON :: Input " << i << " of section Main should have string containing path :: " << scPackPath << std::endl;
+							MessageBox(
+								NULL,
+								(L"Input " + std::to_wstring(i) + L" of section Main should have string containing path\n" + scPackPath).c_str(),
+								L"Failed to setup Pack",
+								MB_ICONERROR | MB_OK
+							);
+
+							return;
+						}
+
+						// Try to open shader from file and don't care
+						// Preserve old path
+						auto old_path = std::filesystem::current_path();
+						auto parent_path = std::filesystem::path(scPackPath).parent_path();
+						std::filesystem::current_path(parent_path);
+
+						// Construct absolute path
+						std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input["path"]);
+						path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+
+						// Restore old path
+						std::filesystem::current_path(old_path);
+
+						std::wcout << "JSON :: Main Shader Input " << i << " path :: " << path << std::endl;
+
+						res.path = path;
+					} else if (res.type == CUBEMAP_TEXTURE && parseCubemapFaces(input, res, L"Main", i))
+						return;
+
+					if (res.type == VOLUME_TEXTURE && parseVolumeLayout(input, res, L"Main", i))
+						return;
+
+					InputSampler sampler;
+					if (parseInputSampler(input, res, sampler, L"Main", i))
+						return;
+
+					loadMainShaderResource(res, i, sampler);
+				}
+			}
+
+		} else {
+			std::wcout << "JSON :: Section Main should be object or string path to file :: " << scPackPath << std::endl;
+			MessageBox(
+				NULL,
+				(L"Section Main should be object or string path to file\n" + scPackPath).c_str(),
+				L"Failed to setup Pack",
+				MB_ICONERROR | MB_OK
+			);
+
+			return;
+		}
+
+		// Do the same for each buffer, BufferA..D sections first, then entries of Buffers section
+		for (int k = 0; k < MaxBuffers; ++k) {
+			nlohmann::json bufferShader;
+			std::wstring bufferKeyW;
+
+			if (k < 4) {
+				std::string bufferKey = std::string("Buffer") + "ABCD"[k];
+				bufferKeyW = std::wstring(L"Buffer") + L"ABCD"[k];
+
+				if (!j.contains(bufferKey))
+					continue;
+
+				bufferShader = j[bufferKey];
+			} else {
+				if (scBufferNames[k].empty())
+					break;
+
+				bufferKeyW = L"Buffer [" + scBufferNames[k] + L"]";
+				bufferShader = j["Buffers"][k - 4];
+			}
+
+			if (bufferShader.is_null())
+				continue;
+
+			// Section "Buffer[A/B/C/D]" in JSON (or entry of "Buffers", see parseBufferNames()) is one of the following types:
+			// 1. json:string: only path to Buffer shader, does not have inputs
+			//    Most common: { "BufferA": "/i/love/hedgehogs.glsl" }
+			//
+			// 2. json:object containing:
+			//    1. "path": json:string path to Buffer shader file (relative to program or absolute) (mandatory)
+			//    2. "inputs": json:array of json:objects (optional) describing shader inputs containing:
+			//       1. "type": json:string one of following (any case) (mandatory):
+			//          1. BufferA
+			// 		    2. BufferB
+			// 		    3. BufferC
+			// 		    4. BufferD
+			// 		       (or name of the buffer from Buffers section)
+			//          5. Image
+			// 		    6. Microphone
+			// 		    7. Webcamera
+			// 		    8. Keyboard
+			// 		    9. Audio
+			// 		    10. Video
+			// 		    11. Cubemap
+			// 		    12. Volume
+			// 	     2. "path": json:string path to file location (relative to program or absolute) (only for Image, Video, Audio, Cubemap and Volume types)
+			// 	        Cubemap path is image of horizontal cross (4 x 3 faces)
+			// 	     3. "faces": json:array of six json:string paths of +X, -X, +Y, -Y, +Z and -Z faces (Cubemap only, replaces path)
+			// 	     4. "size", "channels" and "format": layout of raw volume file without BIN header (Volume only), see parseVolumeLayout()
+			//    3. "defines": json:object (optional) of compile-time constants injected as #define after #version line
+			//    4. "format": json:string (optional) render target format of the buffer, one of BufferFormats, RGBA32F by default
+			//    5. "scale": json:number (optional) size of the buffer relative to window size, 1 by default
+			//    6. "size": json:array of two json:number (optional) fixed width and height of the buffer, overrides scale
+			//    7. "outputs": json:number (optional) number of render targets written as layout(location = k) out, 1 by default
+			//    8. "compute": json:bool (optional) shader is compute shader writing outputs as image units 0, 1, ... (requires OpenGL 4.3)
+			//    9. "groups": json:array of one to three json:number (optional, compute only) workgroup grid, covers buffer size by default
+			//    10. "storage": json:number (optional, compute only) size in bytes of shader storage buffer bound to binding point equal to buffer index
+			//    11. "cubemap": json:bool (optional) shader is drawn into six faces of cubemap, size sets face size, single output only
+
+			if (bufferShader.is_string()) {
+
+				// Try to open shader from file and don't care
+				// Preserve old path
+				auto old_path = std::filesystem::current_path();
+				auto parent_path = std::filesystem::path(scPackPath).parent_path();
+				std::filesystem::current_path(parent_path);
+
+				// Construct absolute path
+				std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(bufferShader);
+				path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+
+				// Restore old path
+				std::filesystem::current_path(old_path);
+
+				std::wcout << "JSON :: " << bufferKeyW << " path :: " << path << std::endl;
+
+				loadBufferShaderFromFile(path, k);
+
+				continue;
+
+			} else if (bufferShader.is_object()) {
+
+				// Validate containing Main shader path
+				if (!bufferShader.contains("path") || !bufferShader["path"].is_string()) {
+
+					std::wcout << "JSON :: " << bufferKeyW << " section should contain path string :: " << scPackPath << std::endl;
+					MessageBox(
+						NULL,
+						(bufferKeyW + L" section should contain path string\n" + scPackPath).c_str(),
+						L"Failed to setup Pack",
+						MB_ICONERROR | MB_OK
+					);
+
+					return;
+				}
+
+				// Try to open shader from file and don't care
+				// Preserve old path
+				auto old_path = std::filesystem::current_path();
+				auto parent_path = std::filesystem::path(scPackPath).parent_path();
+				std::filesystem::current_path(parent_path);
+
+				// Construct absolute path
+				std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(bufferShader["path"]);
+				path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+
+				// Restore old path
+				std::filesystem::current_path(old_path);
+
+				std::wcout << "JSON :: " << bufferKeyW << " Shader path :: " << path << std::endl;
+
+				if (parseShaderDefines(bufferShader, glBufferShaderDefines[k], bufferKeyW))
+					return;
+
+				if (bufferShader.contains("format")) {
+					std::string name = bufferShader["format"].is_string() ? bufferShader["format"].get<std::string>() : "";
+					transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+					int format = -1;
+					for (int f = 0; f < BufferFormatCount; ++f)
+						if (name == BufferFormats[f].name)
+							format = f;
+
+					if (format == -1) {
+
+						std::wcout << "JSON :: " << bufferKeyW << " section has unsupported format :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" section has unsupported format, supported formats are RGBA32F, RGBA16F, RGBA8, RGB10_A2, R11F_G11F_B10F, RG32F, RG16F, RG8, R32F, R16F, R8\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
+
+						return;
+					}
+
+					std::wcout << "JSON :: " << bufferKeyW << " format :: " << BufferFormats[format].name << std::endl;
+
+					setBufferFormat(k, format);
+				}
+
+				if (bufferShader.contains("scale") || bufferShader.contains("size")) {
+					float scale = 1.0f;
+					int width = 0;
+					int height = 0;
+
+					BOOL valid = TRUE;
+
+					if (bufferShader.contains("scale")) {
+						valid = bufferShader["scale"].is_number() && bufferShader["scale"].get<float>() > 0.0f;
+						if (valid)
+							scale = bufferShader["scale"].get<float>();
+					}
+
+					if (valid && bufferShader.contains("size")) {
+						auto size = bufferShader["size"];
+						valid = size.is_array() && size.size() == 2 && size[0].is_number_integer() && size[1].is_number_integer() && size[0].get<int>() > 0 && size[1].get<int>() > 0;
+						if (valid) {
+							width = size[0].get<int>();
+							height = size[1].get<int>();
+						}
+					}
+
+					if (!valid) {
+
+						std::wcout << "JSON :: " << bufferKeyW << " section should have positive number scale and size array of two positive integers :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" section should have positive number scale and size array of two positive integers\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
+
+						return;
+					}
+
+					setBufferSize(k, scale, width, height);
+
+					std::wcout << "JSON :: " << bufferKeyW << " size :: " << glBufferShaderWidths[k] << " x " << glBufferShaderHeights[k] << std::endl;
+				}
+
+				if (bufferShader.contains("outputs")) {
+					if (!bufferShader["outputs"].is_number_integer() || bufferShader["outputs"].get<int>() < 1 || bufferShader["outputs"].get<int>() > MaxBufferOutputs) {
+
+						std::wcout << "JSON :: " << bufferKeyW << " section should have outputs integer from 1 to " << MaxBufferOutputs << " :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" section should have outputs integer from 1 to " + std::to_wstring(MaxBufferOutputs) + L"\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
+
+						return;
+					}
+
+					setBufferOutputs(k, bufferShader["outputs"].get<int>());
+
+					std::wcout << "JSON :: " << bufferKeyW << " outputs :: " << glBufferShaderOutputs[k] << std::endl;
+				}
+
+				if (bufferShader.contains("compute") || bufferShader.contains("groups") || bufferShader.contains("storage")) {
+					BOOL valid = !bufferShader.contains("compute") || bufferShader["compute"].is_boolean();
+					BOOL compute = valid && bufferShader.contains("compute") && bufferShader["compute"].get<bool>();
+
+					int groups[3] = { 0, 0, 0 };
+					if (valid && bufferShader.contains("groups")) {
+						auto grid = bufferShader["groups"];
+						valid = compute && grid.is_array() && grid.size() >= 1 && grid.size() <= 3;
+
+						for (int g = 0; valid && g < 3; ++g) {
+							groups[g] = 1;
+
+							if (g < grid.size()) {
+								valid = grid[g].is_number_integer() && grid[g].get<int>() > 0;
+								if (valid)
+									groups[g] = grid[g].get<int>();
+							}
+						}
+					}
+
+					GLsizeiptr storage = 0;
+					if (valid && bufferShader.contains("storage")) {
+						valid = compute && bufferShader["storage"].is_number_integer() && bufferShader["storage"].get<long long>() > 0;
+						if (valid)
+							storage = (GLsizeiptr) bufferShader["storage"].get<long long>();
+					}
+
+					// Binding point of storage is buffer index, driver may only have the minimum of 8 binding points
+					GLint maxBindings = 0;
+					glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &maxBindings);
+
+					if (valid && storage && k >= maxBindings) {
 
-			return;
-		}
+						std::wcout << "JSON :: " << bufferKeyW << " storage binding point " << k << " is not supported by video driver (" << maxBindings << " binding points) :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" storage binding point " + std::to_wstring(k) + L" is not supported by video driver (" + std::to_wstring(maxBindings) + L" binding points), declare storage on one of the first buffers\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
 
-		f.seekg(0, std::ios::end);
-		str.reserve(f.tellg());
-		f.seekg(0, std::ios::beg);
+						return;
+					}
 
-		str.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+					if (!valid) {
 
-		try {
+						std::wcout << "JSON :: " << bufferKeyW << " section should have boolean compute, groups array of one to three positive integers and positive integer storage, groups and storage require compute :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" section should have boolean compute, groups array of one to three positive integers and positive integer storage, groups and storage require compute\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
 
-			auto j = nlohmann::json::parse(str);
+						return;
+					}
 
-			if (!j.contains("Main")) {
+					glBufferShaderStages[k] = compute ? GL_COMPUTE_SHADER : GL_FRAGMENT_SHADER;
+					glBufferShaderComputeGroups[k][0] = groups[0];
+					glBufferShaderComputeGroups[k][1] = groups[1];
+					glBufferShaderComputeGroups[k][2] = groups[2];
+					setBufferStorage(k, storage);
 
-				std::wcout << "JSON :: Missing Main section in Pack file :: " << scPackPath << std::endl;
-				MessageBox(
-					NULL,
-					(L"Missing Main section in Pack file\n" + scPackPath).c_str(),
-					L"Failed to setup Pack",
-					MB_ICONERROR | MB_OK
-				);
+					if (compute)
+						std::wcout << "JSON :: " << bufferKeyW << " compute :: groups " << groups[0] << " x " << groups[1] << " x " << groups[2] << " (0 covers buffer), storage " << glBufferShaderStorageSizes[k] << " bytes" << std::endl;
+				}
 
-				return;
-			}
+				if (bufferShader.contains("cubemap")) {
+					if (!bufferShader["cubemap"].is_boolean() || (bufferShader["cubemap"].get<bool>() && (glBufferShaderStages[k] == GL_COMPUTE_SHADER || glBufferShaderOutputs[k] > 1))) {
 
-			auto mainShader = j["Main"];
+						std::wcout << "JSON :: " << bufferKeyW << " section should have boolean cubemap, cubemap pass can not be compute pass or have multiple outputs :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" section should have boolean cubemap, cubemap pass can not be compute pass or have multiple outputs\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
 
-			// Section "Main" in JSON is one of the following types:
-			// 1. json:string: only path to main shader, does not contain buffers or inputs
-			//    Most common: { "Main": "/home/work/bed/forever.glsl" }
-			//
-			// 2. json:object containing:
-			//    1. "path": json:string path to main shader file (relative to program or absolute) (mandatory)
-			//    2. "inputs": json:array of json:objects (optional) describing shader inputs containing:
-			//       1. "type": json:string one of following (any case) (mandatory):
-			//          1. BufferA
-			// 		    2. BufferB
-			// 		    3. BufferC
-			// 		    4. BufferD
-			//          5. Image
-			// 		    6. Microphone
-			// 		    7. Webcamera
-			// 		    8. Keyboard
-			// 		    9. Audio
-			// 		    10. Video
-			// 	     2. "path": json:string path to file location (relative to program or absolute) (only for Image, Video and Audio types)
+						return;
+					}
 
-			if (mainShader.is_string()) {
+					if (bufferShader["cubemap"].get<bool>()) {
+						glBufferShaderStages[k] = GL_GEOMETRY_SHADER;
 
-				// Try to open shader from file and don't care
-				// Preserve old path
-				auto old_path = std::filesystem::current_path();
-				auto parent_path = std::filesystem::path(scPackPath).parent_path();
-				std::filesystem::current_path(parent_path);
+						std::wcout << "JSON :: " << bufferKeyW << " cubemap" << std::endl;
+					}
+				}
 
-				// Construct absolute path
-				std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(mainShader);
-				path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+				if (bufferShader.contains("vertices") || bufferShader.contains("instances") || bufferShader.contains("primitive") || bufferShader.contains("blend")) {
+					BOOL valid = bufferShader.contains("vertices") && bufferShader["vertices"].is_number_integer() && bufferShader["vertices"].get<int>() > 0
+						&& glBufferShaderStages[k] == GL_FRAGMENT_SHADER && glBufferShaderOutputs[k] == 1;
 
-				// Restore old path
-				std::filesystem::current_path(old_path);
+					int instances = 1;
+					if (valid && bufferShader.contains("instances")) {
+						valid = bufferShader["instances"].is_number_integer() && bufferShader["instances"].get<int>() > 0;
+						if (valid)
+							instances = bufferShader["instances"].get<int>();
+					}
 
-				std::wcout << "JSON :: Main Shader path :: " << path << std::endl;
+					int primitive = 0;
+					if (valid && bufferShader.contains("primitive")) {
+						std::string name = bufferShader["primitive"].is_string() ? bufferShader["primitive"].get<std::string>() : "";
+						transform(name.begin(), name.end(), name.begin(), ::tolower);
 
-				loadMainShaderFromFile(path);
+						primitive = -1;
+						for (int p = 0; p < VertexPrimitiveCount; ++p)
+							if (name == VertexPrimitives[p].name)
+								primitive = p;
 
-				return;
+						valid = primitive != -1;
+					}
 
-			} else if (mainShader.is_object()) {
+					int blend = 0;
+					if (valid && bufferShader.contains("blend")) {
+						std::string name = bufferShader["blend"].is_string() ? bufferShader["blend"].get<std::string>() : "";
+						transform(name.begin(), name.end(), name.begin(), ::tolower);
 
-				// Validate containing Main shader path
-				if (!mainShader.contains("path") || !mainShader["path"].is_string()) {
+						blend = -1;
+						for (int b = 0; b < BlendModeCount; ++b)
+							if (name == BlendModes[b].name)
+								blend = b;
 
-					std::wcout << "JSON :: Main section should contain path string :: " << scPackPath << std::endl;
-					MessageBox(
-						NULL,
-						(L"Main section should contain path string\n" + scPackPath).c_str(),
-						L"Failed to setup Pack",
-						MB_ICONERROR | MB_OK
-					);
+						valid = blend != -1;
+					}
 
-					return;
-				}
+					if (!valid) {
 
-				// Try to open shader from file and don't care
-				// Preserve old path
-				auto old_path = std::filesystem::current_path();
-				auto parent_path = std::filesystem::path(scPackPath).parent_path();
-				std::filesystem::current_path(parent_path);
+						std::wcout << "JSON :: " << bufferKeyW << " section should have positive integer vertices, optional positive integer instances, primitive and blend, vertex pass can not be compute or cubemap pass or have multiple outputs :: " << scPackPath << std::endl;
+						MessageBox(
+							NULL,
+							(bufferKeyW + L" section should have positive integer vertices, optional positive integer instances, primitive (points, lines, line_strip, line_loop, triangles, triangle_strip, triangle_fan) and blend (alpha, additive, none), vertex pass can not be compute or cubemap pass or have multiple outputs\n" + scPackPath).c_str(),
+							L"Failed to setup Pack",
+							MB_ICONERROR | MB_OK
+						);
 
-				// Construct absolute path
-				std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(mainShader["path"]);
-				path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+						return;
+					}
 
-				// Restore old path
-				std::filesystem::current_path(old_path);
+					glBufferShaderStages[k] = GL_VERTEX_SHADER;
+					glBufferShaderVertexCounts[k] = bufferShader["vertices"].get<int>();
+					glBufferShaderInstanceCounts[k] = instances;
+					glBufferShaderPrimitives[k] = primitive;
+					glBufferShaderBlends[k] = blend;
 
-				std::wcout << "JSON :: Main Shader path :: " << path << std::endl;
+					std::wcout << "JSON :: " << bufferKeyW << " vertex pass :: " << instances << " x " << glBufferShaderVertexCounts[k] << " vertices of " << VertexPrimitives[primitive].name << ", " << BlendModes[blend].name << " blend" << std::endl;
+				}
 
-				loadMainShaderFromFile(path);
+				loadBufferShaderFromFile(path, k);
 
-				if (mainShader.contains("inputs")) {
-					if (!mainShader["inputs"].is_array()) {
+				if (bufferShader.contains("inputs")) {
+					if (!bufferShader["inputs"].is_array()) {
 
-						std::wcout << "JSON :: Inputs entry of Main section should be array :: " << scPackPath << std::endl;
+						std::wcout << "JSON :: Inputs entry of " << bufferKeyW << " section should be array :: " << scPackPath << std::endl;
 						MessageBox(
 							NULL,
-							(L"Inputs entry of Main section should be array\n" + scPackPath).c_str(),
+							(L"Inputs entry of " + bufferKeyW + L" section should be array\n" + scPackPath).c_str(),
 							L"Failed to setup Pack",
 							MB_ICONERROR | MB_OK
 						);
@@ -1173,16 +4521,15 @@ void reloadPack() {
 						return;
 					}
 
-					// Not error, however..
-					if (mainShader["inputs"].size() < 4 || mainShader["inputs"].size() > 4)
-						std::wcout << "Warning :: JSON :: Main Shader has " << mainShader["inputs"].size() << " inputs, but 4 required :: " << scPackPath << std::endl;
+					if (bufferShader["inputs"].size() > MaxChannels)
+						std::wcout << "Warning :: JSON :: " << bufferKeyW << " Shader has " << bufferShader["inputs"].size() << " inputs, but at most " << MaxChannels << " supported :: " << scPackPath << std::endl;
 
-					for (int i = 0; i < mainShader["inputs"].size(); ++i) {
+					for (int i = 0; i < bufferShader["inputs"].size(); ++i) {
 
-						if (i >= 4)
+						if (i >= MaxChannels)
 							break;
 
-						auto input = mainShader["inputs"][i];
+						auto input = bufferShader["inputs"][i];
 
 						if (input.is_null()) // Skip null
 							continue;
@@ -1190,10 +4537,10 @@ void reloadPack() {
 						if (!input.is_object()) { // Input must be object or string buffer name
 
 							if (!input.is_string()) {
-								std::wcout << "JSON :: Input " << i << " of section Main should be object or string containing input Buffer name :: " << scPackPath << std::endl;
+								std::wcout << "JSON :: Input " << std::to_wstring(i) << " of section " << bufferKeyW << " should be object or string containing input Buffer name" << scPackPath << std::endl;
 								MessageBox(
 									NULL,
-									(L"Input " + std::to_wstring(i) + L" of section Main should be object or string containing input Buffer name\n" + scPackPath).c_str(),
+									(bufferKeyW + L" Shader Input " + std::to_wstring(i) + L" should be object or string containing input Buffer name\n" + scPackPath).c_str(),
 									L"Failed to setup Pack",
 									MB_ICONERROR | MB_OK
 								);
@@ -1216,13 +4563,15 @@ void reloadPack() {
 								res.buffer_id = 2;
 							else if (type == L"bufferd")  // Buffer D input
 								res.buffer_id = 3;
+							else if (findBufferByName(type) != -1) // Named buffer input
+								res.buffer_id = findBufferByName(type);
 							else if (type == L"")
 								continue;
 							else {
-								std::wcout << "JSON :: Input " << i << " of section Main contains invalid buffer name " << type << " :: " << scPackPath << std::endl;
+								std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " contains invalid buffer name " << type << " :: " << scPackPath << std::endl;
 								MessageBox(
 									NULL,
-									(L"Input " + std::to_wstring(i) + L" of section Main contains invalid buffer name " + type + L"\n" + scPackPath).c_str(),
+									(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" contains invalid buffer name " + type + L"\n" + scPackPath).c_str(),
 									L"Failed to setup Pack",
 									MB_ICONERROR | MB_OK
 								);
@@ -1230,17 +4579,17 @@ void reloadPack() {
 								return;
 							}
 
-							loadMainShaderResource(res, i);
+							loadBufferShaderResource(res, k, i);
 
 							continue;
 						}
 
 						if (!input.contains("type") || !input["type"].is_string()) {
 
-							std::wcout << "JSON :: Input " << i << " of section Main should have string containing type :: " << scPackPath << std::endl;
+							std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " should have string containing type :: " << scPackPath << std::endl;
 							MessageBox(
 								NULL,
-								(L"Input " + std::to_wstring(i) + L" of section Main should have string containing type\n" + scPackPath).c_str(),
+								(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" should have string containing type\n" + scPackPath).c_str(),
 								L"Failed to setup Pack",
 								MB_ICONERROR | MB_OK
 							);
@@ -1266,6 +4615,8 @@ void reloadPack() {
 						// 8. Keyboard
 						// 9. Audio
 						// 10. Video
+						// 11. Cubemap
+						// 12. Volume
 
 						if (type == L"buffera") { // Buffer A input
 							res.type = FRAME_BUFFER;
@@ -1279,29 +4630,38 @@ void reloadPack() {
 						} else if (type == L"bufferd") { // Buffer D input
 							res.type = FRAME_BUFFER;
 							res.buffer_id = 3;
+						} else if (findBufferByName(type) != -1) { // Named buffer input
+							res.type = FRAME_BUFFER;
+							res.buffer_id = findBufferByName(type);
 						} else if (type == L"image") { // Image input
 							res.type = IMAGE_TEXTURE;
 							path_required = true;
-						} else if (type == L"microphone") { // Microphone
-							std::wcout << "Incomplete :: JSON :: Main Shader Input :: Microphone" << std::endl;
-							assume_empty = true;
+						} else if (type == L"microphone") { // Microphone, optional path of WAV file to replay instead of capture
+							res.type = MIC_TEXTURE;
+							path_required = input.contains("path");
 						} else if (type == L"webcamera") { // Webcamera
-							std::wcout << "Incomplete :: JSON :: Main Shader Input :: Webcamera" << std::endl;
-							assume_empty = true;
-						} else if (type == L"keyboard") { // Keyboard
-							std::wcout << "Incomplete :: JSON :: Main Shader Input :: Keyboard" << std::endl;
+							std::wcout << "Incomplete :: JSON :: " << bufferKeyW << " Shader Input :: Webcamera" << std::endl;
 							assume_empty = true;
+						} else if (type == L"keyboard") { // Keyboard, optional path of key script
+							res.type = KEYBOARD_TEXTURE;
+							path_required = input.contains("path");
 						} else if (type == L"audio") { // Audio
-							std::wcout << "Incomplete :: JSON :: Main Shader Input :: Audio" << std::endl;
-							assume_empty = true;
+							res.type = AUDIO_TEXTURE;
+							path_required = true;
 						} else if (type == L"video") { // Video
-							std::wcout << "Incomplete :: JSON :: Main Shader Input :: Video" << std::endl;
-							assume_empty = true;
+							res.type = VIDEO_TEXTURE;
+							path_required = true;
+						} else if (type == L"cubemap") { // Cubemap, cross image or six face images
+							res.type = CUBEMAP_TEXTURE;
+							path_required = !input.contains("faces");
+						} else if (type == L"volume") { // Volume, BIN or raw file
+							res.type = VOLUME_TEXTURE;
+							path_required = true;
 						} else {
-							std::wcout << "JSON :: Input " << i << " of section Main is unsupported type " << type << " :: " << scPackPath << std::endl;
+							std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " is unsupported type " << type << " :: " << scPackPath << std::endl;
 							MessageBox(
 								NULL,
-								(L"Input " + std::to_wstring(i) + L" of section Main is unsupported type " + type + L"\n" + scPackPath).c_str(),
+								(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" is unsupported type " + type + L"\n" + scPackPath).c_str(),
 								L"Failed to setup Pack",
 								MB_ICONERROR | MB_OK
 							);
@@ -1315,10 +4675,10 @@ void reloadPack() {
 						if (path_required) {
 							if (!input.contains("path") || !input["path"].is_string()) {
 
-								std::wcout << "JSON :: Input " << i << " of section Main should have string containing path :: " << scPackPath << std::endl;
+								std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " should have string containing path :: " << scPackPath << std::endl;
 								MessageBox(
 									NULL,
-									(L"Input " + std::to_wstring(i) + L" of section Main should have string containing path\n" + scPackPath).c_str(),
+									(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" should have string containing path\n" + scPackPath).c_str(),
 									L"Failed to setup Pack",
 									MB_ICONERROR | MB_OK
 								);
@@ -1339,336 +4699,118 @@ void reloadPack() {
 							// Restore old path
 							std::filesystem::current_path(old_path);
 
-							std::wcout << "JSON :: Main Shader Input " << i << " path :: " << path << std::endl;
+							std::wcout << "JSON :: " << bufferKeyW << " Shader Input " << i << " path :: " << path << std::endl;
 
 							res.path = path;
-						}
+						} else if (res.type == CUBEMAP_TEXTURE && parseCubemapFaces(input, res, bufferKeyW, i))
+							return;
 
-						loadMainShaderResource(res, i);
+						if (res.type == VOLUME_TEXTURE && parseVolumeLayout(input, res, bufferKeyW, i))
+							return;
+
+						InputSampler sampler;
+						if (parseInputSampler(input, res, sampler, bufferKeyW, i))
+							return;
+
+						loadBufferShaderResource(res, k, i, sampler);
 					}
 				}
 
 			} else {
-				std::wcout << "JSON :: Section Main should be object or string path to file :: " << scPackPath << std::endl;
+				std::wcout << "Failed to parse Pack file :: Main Shader should be string path to file or object :: " << scPackPath << std::endl;
 				MessageBox(
 					NULL,
-					(L"Section Main should be object or string path to file\n" + scPackPath).c_str(),
+					(L"Main Shader should be string path to file or object\n" + scPackPath).c_str(),
 					L"Failed to setup Pack",
 					MB_ICONERROR | MB_OK
 				);
 
 				return;
 			}
+		}
 
-			// Do the same for each buffer
-			for (int k = 0; k < 4; ++k) {
-				std::string bufferKey = std::string("Buffer") + "ABCD"[k];
-				std::wstring bufferKeyW = std::wstring(L"Buffer") + L"ABCD"[k];
-
-				if (!j.contains(bufferKey))
-					continue;
-
-				auto bufferShader = j[bufferKey];
-
-				if (bufferShader.is_null())
-					continue;
-
-				// Section "Buffer[A/B/C/D]" in JSON is one of the following types:
-				// 1. json:string: only path to Buffer shader, does not have inputs
-				//    Most common: { "BufferA": "/i/love/hedgehogs.glsl" }
-				//
-				// 2. json:object containing:
-				//    1. "path": json:string path to Buffer shader file (relative to program or absolute) (mandatory)
-				//    2. "inputs": json:array of json:objects (optional) describing shader inputs containing:
-				//       1. "type": json:string one of following (any case) (mandatory):
-				//          1. BufferA
-				// 		    2. BufferB
-				// 		    3. BufferC
-				// 		    4. BufferD
-				//          5. Image
-				// 		    6. Microphone
-				// 		    7. Webcamera
-				// 		    8. Keyboard
-				// 		    9. Audio
-				// 		    10. Video
-				// 	     2. "path": json:string path to file location (relative to program or absolute) (only for Image, Video and Audio types)
-
-				if (bufferShader.is_string()) {
-
-					// Try to open shader from file and don't care
-					// Preserve old path
-					auto old_path = std::filesystem::current_path();
-					auto parent_path = std::filesystem::path(scPackPath).parent_path();
-					std::filesystem::current_path(parent_path);
-
-					// Construct absolute path
-					std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(bufferShader);
-					path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
-
-					// Restore old path
-					std::filesystem::current_path(old_path);
-
-					std::wcout << "JSON :: " << bufferKeyW << " path :: " << path << std::endl;
-
-					loadMainShaderFromFile(path);
-
-					continue;
-
-				} else if (bufferShader.is_object()) {
-
-					// Validate containing Main shader path
-					if (!bufferShader.contains("path") || !bufferShader["path"].is_string()) {
-
-						std::wcout << "JSON :: " << bufferKeyW << " section should contain path string :: " << scPackPath << std::endl;
-						MessageBox(
-							NULL,
-							(bufferKeyW + L" section should contain path string\n" + scPackPath).c_str(),
-							L"Failed to setup Pack",
-							MB_ICONERROR | MB_OK
-						);
-
-						return;
-					}
-
-					// Try to open shader from file and don't care
-					// Preserve old path
-					auto old_path = std::filesystem::current_path();
-					auto parent_path = std::filesystem::path(scPackPath).parent_path();
-					std::filesystem::current_path(parent_path);
-
-					// Construct absolute path
-					std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(bufferShader["path"]);
-					path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
-
-					// Restore old path
-					std::filesystem::current_path(old_path);
-
-					std::wcout << "JSON :: " << bufferKeyW << " Shader path :: " << path << std::endl;
-
-					loadBufferShaderFromFile(path, k);
-
-					if (bufferShader.contains("inputs")) {
-						if (!bufferShader["inputs"].is_array()) {
-
-							std::wcout << "JSON :: Inputs entry of " << bufferKeyW << " section should be array :: " << scPackPath << std::endl;
-							MessageBox(
-								NULL,
-								(L"Inputs entry of " + bufferKeyW + L" section should be array\n" + scPackPath).c_str(),
-								L"Failed to setup Pack",
-								MB_ICONERROR | MB_OK
-							);
-
-							return;
-						}
-
-						if (bufferShader["inputs"].size() < 4 || bufferShader["inputs"].size() > 4)
-							std::wcout << "Warning :: JSON :: " << bufferKeyW << " Shader has " << bufferShader["inputs"].size() << " inputs, but 4 required :: " << scPackPath << std::endl;
-
-						for (int i = 0; i < bufferShader["inputs"].size(); ++i) {
-
-							if (i >= 4)
-								break;
-
-							auto input = bufferShader["inputs"][i];
-
-							if (input.is_null()) // Skip null
-								continue;
-
-							if (!input.is_object()) { // Input must be object or string buffer name
-
-								if (!input.is_string()) {
-									std::wcout << "JSON :: Input " << std::to_wstring(i) << " of section " << bufferKeyW << " should be object or string containing input Buffer name" << scPackPath << std::endl;
-									MessageBox(
-										NULL,
-										(bufferKeyW + L" Shader Input " + std::to_wstring(i) + L" should be object or string containing input Buffer name\n" + scPackPath).c_str(),
-										L"Failed to setup Pack",
-										MB_ICONERROR | MB_OK
-									);
-
-									return;
-								}
-
-								std::wstring type = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input.get<std::string>());
-
-								transform(type.begin(), type.end(), type.begin(), ::towlower);
-
-								SCResource res;
-								res.type = FRAME_BUFFER;
-
-								if (type == L"buffera") // Buffer A input
-									res.buffer_id = 0;
-								else if (type == L"bufferb") // Buffer B input
-									res.buffer_id = 1;
-								else if (type == L"bufferc") // Buffer C input
-									res.buffer_id = 2;
-								else if (type == L"bufferd")  // Buffer D input
-									res.buffer_id = 3;
-								else if (type == L"")
-									continue;
-								else {
-									std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " contains invalid buffer name " << type << " :: " << scPackPath << std::endl;
-									MessageBox(
-										NULL,
-										(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" contains invalid buffer name " + type + L"\n" + scPackPath).c_str(),
-										L"Failed to setup Pack",
-										MB_ICONERROR | MB_OK
-									);
-
-									return;
-								}
-
-								loadBufferShaderResource(res, k, i);
-
-								continue;
-							}
-
-							if (!input.contains("type") || !input["type"].is_string()) {
-
-								std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " should have string containing type :: " << scPackPath << std::endl;
-								MessageBox(
-									NULL,
-									(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" should have string containing type\n" + scPackPath).c_str(),
-									L"Failed to setup Pack",
-									MB_ICONERROR | MB_OK
-								);
-
-								return;
-							}
-
-							std::wstring type = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input["type"].get<std::string>());
-
-							transform(type.begin(), type.end(), type.begin(), ::towlower);
-
-							SCResource res;
-							bool path_required = false;
-							bool assume_empty = false;
-
-							// 1. BufferA
-							// 2. BufferB
-							// 3. BufferC
-							// 4. BufferD
-							// 5. Image
-							// 6. Microphone
-							// 7. Webcamera
-							// 8. Keyboard
-							// 9. Audio
-							// 10. Video
-
-							if (type == L"buffera") { // Buffer A input
-								res.type = FRAME_BUFFER;
-								res.buffer_id = 0;
-							} else if (type == L"bufferb") { // Buffer B input
-								res.type = FRAME_BUFFER;
-								res.buffer_id = 1;
-							} else if (type == L"bufferc") { // Buffer C input
-								res.type = FRAME_BUFFER;
-								res.buffer_id = 2;
-							} else if (type == L"bufferd") { // Buffer D input
-								res.type = FRAME_BUFFER;
-								res.buffer_id = 3;
-							} else if (type == L"image") { // Image input
-								res.type = IMAGE_TEXTURE;
-								path_required = true;
-							} else if (type == L"microphone") { // Microphone
-								std::wcout << "Incomplete :: JSON :: " << bufferKeyW << " Shader Input :: Microphone" << std::endl;
-								assume_empty = true;
-							} else if (type == L"webcamera") { // Webcamera
-								std::wcout << "Incomplete :: JSON :: " << bufferKeyW << " Shader Input :: Webcamera" << std::endl;
-								assume_empty = true;
-							} else if (type == L"keyboard") { // Keyboard
-								std::wcout << "Incomplete :: JSON :: " << bufferKeyW << " Shader Input :: Keyboard" << std::endl;
-								assume_empty = true;
-							} else if (type == L"audio") { // Audio
-								std::wcout << "Incomplete :: JSON :: " << bufferKeyW << " Shader Input :: Audio" << std::endl;
-								assume_empty = true;
-							} else if (type == L"video") { // Video
-								std::wcout << "Incomplete :: JSON :: " << bufferKeyW << " Shader Input :: Video" << std::endl;
-								assume_empty = true;
-							} else {
-								std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " is unsupported type " << type << " :: " << scPackPath << std::endl;
-								MessageBox(
-									NULL,
-									(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" is unsupported type " + type + L"\n" + scPackPath).c_str(),
-									L"Failed to setup Pack",
-									MB_ICONERROR | MB_OK
-								);
-
-								return;
-							}
-
-							if (assume_empty)
-								continue;
-
-							if (path_required) {
-								if (!input.contains("path") || !input["path"].is_string()) {
+	} catch (const nlohmann::json::exception& ex) { // Catch JSON exceptions
 
-									std::wcout << "JSON :: Input " << i << " of section " << bufferKeyW << " should have string containing path :: " << scPackPath << std::endl;
-									MessageBox(
-										NULL,
-										(L"Input " + std::to_wstring(i) + L" of section " + bufferKeyW + L" should have string containing path\n" + scPackPath).c_str(),
-										L"Failed to setup Pack",
-										MB_ICONERROR | MB_OK
-									);
+		std::wcout << "JSON :: Failed to parse Pack JSON :: " << ex.what() << " :: " << scPackPath << std::endl;
+		std::string what = ex.what();
+		std::wstring wwhatt/*!!??*/ = std::wstring(what.begin(), what.end());
+		MessageBox(
+			NULL,
+			(L"Failed to parse Pack JSON:\n" + wwhatt + L"\n" + scPackPath).c_str(),
+			L"Failed to parse Pack",
+			MB_ICONERROR | MB_OK
+		);
+	} catch (...) { // Catch other exceptions
 
-									return;
-								}
+		std::wcout << "Failed to parse Pack with Unresolved exception :: " << scPackPath << std::endl;
+		MessageBox(
+			NULL,
+			(L"Failed to parse Pack with Unresolved exception\n" + scPackPath).c_str(),
+			L"Failed to parse Pack",
+			MB_ICONERROR | MB_OK
+		);
+	}
+}
 
-								// Try to open shader from file and don't care
-								// Preserve old path
-								auto old_path = std::filesystem::current_path();
-								auto parent_path = std::filesystem::path(scPackPath).parent_path();
-								std::filesystem::current_path(parent_path);
+// Reloads Shader Pack from scPackPath
+void reloadPack() {
+	if (scPackPath != L"") {
+		// unload previous shaders & resources
+		unloadMainShader();
+		unloadSoundShader();
 
-								// Construct absolute path
-								std::wstring path = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(input["path"]);
-								path = std::filesystem::weakly_canonical(parent_path / std::filesystem::path(path));
+		for (int i = 0; i < MaxBuffers; ++i)
+			if (glBufferShaderProgramIDs[i] != -1)
+				unloadBufferShader(i);
 
-								// Restore old path
-								std::filesystem::current_path(old_path);
+		unloadResources();
 
-								std::wcout << "JSON :: " << bufferKeyW << " Shader Input " << i << " path :: " << path << std::endl;
+		resetQualityLevels();
 
-								res.path = path;
-							}
+		// Release buffers, pack declares names, formats and sizes again
+		for (int i = 0; i < MaxBuffers; ++i) {
+			releaseBufferTextures(i);
+			setBufferFormat(i, DefaultBufferFormat);
+			setBufferSize(i, 1.0f, 0, 0);
+			setBufferOutputs(i, 1);
+			setBufferStorage(i, 0);
 
-							loadBufferShaderResource(res, k, i);
-						}
-					}
+			glBufferShaderStages[i] = GL_FRAGMENT_SHADER;
+			glBufferShaderComputeGroups[i][0] = glBufferShaderComputeGroups[i][1] = glBufferShaderComputeGroups[i][2] = 0;
+			glBufferShaderVertexCounts[i] = 0;
+			glBufferShaderInstanceCounts[i] = 0;
+			glBufferShaderPrimitives[i] = 0;
+			glBufferShaderBlends[i] = 0;
 
-				} else {
-					std::wcout << "Failed to parse Pack file :: Main Shader should be string path to file or object :: " << scPackPath << std::endl;
-					MessageBox(
-						NULL,
-						(L"Main Shader should be string path to file or object\n" + scPackPath).c_str(),
-						L"Failed to setup Pack",
-						MB_ICONERROR | MB_OK
-					);
+			scBufferFrames[i] = 0;
+			glBufferShaderPath[i] = L"";
 
-					return;
-				}
-			}
+			if (i >= 4)
+				scBufferNames[i] = L"";
+		}
 
-		} catch (const nlohmann::json::exception& ex) { // Catch JSON exceptions
+		glViewport(0, 0, glWidth, glHeight);
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
 
-			std::wcout << "JSON :: Failed to parse Pack JSON :: " << ex.what() << " :: " << scPackPath << std::endl;
-			std::string what = ex.what();
-			std::wstring wwhatt/*!!??*/ = std::wstring(what.begin(), what.end());
-			MessageBox(
-				NULL,
-				(L"Failed to parse Pack JSON:\n" + wwhatt + L"\n" + scPackPath).c_str(),
-				L"Failed to parse Pack",
-				MB_ICONERROR | MB_OK
-			);
-		} catch (...) { // Catch other exceptions
+		// Reset time & frame
+		glfwSetTime(0.0);
+		scTimestamp = 0.0;
+		scFrames = 0;
+		resetSimulationClock();
 
-			std::wcout << "Failed to parse Pack with Unresolved exception :: " << scPackPath << std::endl;
-			MessageBox(
-				NULL,
-				(L"Failed to parse Pack with Unresolved exception\n" + scPackPath).c_str(),
-				L"Failed to parse Pack",
-				MB_ICONERROR | MB_OK
-			);
-		}
+		// Shaders are compiled once inputs of all sections are known, cube and volume channels change their samplers
+		scShaderCompilationDeferred = TRUE;
+		parsePack();
+		validateBufferOutputs();
+		scShaderCompilationDeferred = FALSE;
+
+		if (glMainShaderPath != L"")
+			loadMainShaderFromFile(glMainShaderPath);
+
+		for (int i = 0; i < MaxBuffers; ++i)
+			if (glBufferShaderPath[i] != L"")
+				loadBufferShaderFromFile(glBufferShaderPath[i], i);
 	}
 }
 
@@ -1702,7 +4844,10 @@ void savePack() {
 
 		j["Main"]["inputs"] = nlohmann::json::array();
 
-		for (int i = 0; i < 4; ++i) {
+		if (glMainShaderDefines.size())
+			j["Main"]["defines"] = shaderDefinesToJSON(glMainShaderDefines);
+
+		for (int i = 0; i < MaxChannels; ++i) {
 			if (scMainShaderInputs[i] == -1)
 				continue;
 			//j["Main"]["inputs"][i] = nullptr;
@@ -1717,18 +4862,35 @@ void savePack() {
 							break;
 						}
 
-						case AUDIO_TEXTURE: { // TODO: Save media resources
-							std::wcout << "To JSON :: Main Shader :: Incomplete :: Audio" << std::endl;
+						case AUDIO_TEXTURE: {
+							j["Main"]["inputs"][i]["type"] = "Audio";
+							j["Main"]["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scMainShaderInputs[i]].resource.path), basePackPath).string();
 							break;
 						}
 
 						case VIDEO_TEXTURE: {
-							std::wcout << "To JSON :: Main Shader :: Incomplete :: Video" << std::endl;
+							j["Main"]["inputs"][i]["type"] = "Video";
+							j["Main"]["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scMainShaderInputs[i]].resource.path), basePackPath).string();
+							break;
+						}
+
+						case CUBEMAP_TEXTURE: {
+							j["Main"]["inputs"][i]["type"] = "Cubemap";
+							cubemapPathToJSON(j["Main"]["inputs"][i], scResources[scMainShaderInputs[i]].resource.path, basePackPath);
+							break;
+						}
+
+						case VOLUME_TEXTURE: {
+							j["Main"]["inputs"][i]["type"] = "Volume";
+							j["Main"]["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scMainShaderInputs[i]].resource.path), basePackPath).string();
+							volumeLayoutToJSON(j["Main"]["inputs"][i], scResources[scMainShaderInputs[i]].resource.volume);
 							break;
 						}
 
 						case MIC_TEXTURE: {
-							std::wcout << "To JSON :: Main Shader :: Incomplete :: Microphone" << std::endl;
+							j["Main"]["inputs"][i]["type"] = "Microphone";
+							if (!scResources[scMainShaderInputs[i]].resource.path.empty())
+								j["Main"]["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scMainShaderInputs[i]].resource.path), basePackPath).string();
 							break;
 						}
 
@@ -1738,79 +4900,186 @@ void savePack() {
 						}
 
 						case KEYBOARD_TEXTURE: {
-							std::wcout << "To JSON :: Main Shader :: Incomplete :: Keyboard" << std::endl;
+							j["Main"]["inputs"][i]["type"] = "Keyboard";
+							if (!scResources[scMainShaderInputs[i]].resource.path.empty())
+								j["Main"]["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scMainShaderInputs[i]].resource.path), basePackPath).string();
 							break;
 						}
 
 						case FRAME_BUFFER: {
-							j["Main"]["inputs"][i]["type"] = std::string("Buffer") + "ABCD"[scResources[scMainShaderInputs[i]].resource.buffer_id];
+							j["Main"]["inputs"][i]["type"] = std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scBufferNames[scResources[scMainShaderInputs[i]].resource.buffer_id]);
 							break;
 						}
 					}
+
+					if (j["Main"]["inputs"][i].is_object())
+						inputSamplerToJSON(j["Main"]["inputs"][i], scResources[scMainShaderInputs[i]].resource, scMainShaderSamplers[i]);
 				}
 			}
 		}
 	}
 
+	if (glSoundShaderPath != L"") {
+		std::string path = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(glSoundShaderPath), basePackPath).string();
+
+		if (glSoundShaderDefines.size()) {
+			j["Sound"]["path"] = path;
+			j["Sound"]["defines"] = shaderDefinesToJSON(glSoundShaderDefines);
+		} else
+			j["Sound"] = path;
+	}
+
 	// Do the same for buffers
-	for (int k = 0; k < 4; ++k) {
+	for (int k = 0; k < MaxBuffers; ++k) {
 
 		if (glBufferShaderPath[k] == L"")
 			continue;
 
-		std::string bufferKey = std::string("Buffer") + "ABCD"[k];
+		// BufferA..D are stored as own sections, the rest as named entries of Buffers section
+		nlohmann::json section;
+
+		section["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(glBufferShaderPath[k]), basePackPath).string();
+		section["inputs"] = nlohmann::json::array();
+
+		if (glBufferShaderDefines[k].size())
+			section["defines"] = shaderDefinesToJSON(glBufferShaderDefines[k]);
+
+		if (glBufferShaderFormats[k] != DefaultBufferFormat)
+			section["format"] = BufferFormats[glBufferShaderFormats[k]].name;
+
+		if (glBufferShaderFixedSizes[k][0] && glBufferShaderFixedSizes[k][1])
+			section["size"] = { glBufferShaderFixedSizes[k][0], glBufferShaderFixedSizes[k][1] };
+		else if (glBufferShaderScales[k] != 1.0f)
+			section["scale"] = glBufferShaderScales[k];
+
+		if (glBufferShaderOutputs[k] != 1)
+			section["outputs"] = glBufferShaderOutputs[k];
+
+		if (glBufferShaderStages[k] == GL_COMPUTE_SHADER) {
+			section["compute"] = true;
+
+			if (glBufferShaderComputeGroups[k][0])
+				section["groups"] = { glBufferShaderComputeGroups[k][0], glBufferShaderComputeGroups[k][1], glBufferShaderComputeGroups[k][2] };
 
-		j[bufferKey]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(glBufferShaderPath[k]), basePackPath).string();
-		j[bufferKey]["inputs"] = nlohmann::json::array();
+			if (glBufferShaderStorageSizes[k])
+				section["storage"] = (long long) glBufferShaderStorageSizes[k];
+		}
+
+		if (glBufferShaderStages[k] == GL_GEOMETRY_SHADER)
+			section["cubemap"] = true;
+
+		if (glBufferShaderStages[k] == GL_VERTEX_SHADER) {
+			section["vertices"] = glBufferShaderVertexCounts[k];
+
+			if (glBufferShaderInstanceCounts[k] != 1)
+				section["instances"] = glBufferShaderInstanceCounts[k];
 
-		for (int i = 0; i < 4; ++i) {
+			if (glBufferShaderPrimitives[k])
+				section["primitive"] = VertexPrimitives[glBufferShaderPrimitives[k]].name;
+
+			if (glBufferShaderBlends[k])
+				section["blend"] = BlendModes[glBufferShaderBlends[k]].name;
+		}
+
+		for (int i = 0; i < MaxChannels; ++i) {
 			if (scBufferShaderInputs[k][i] == -1)
 				continue;
-				//j[bufferKey]["inputs"][i] = nullptr;
+				//section["inputs"][i] = nullptr;
 			else {
 				if (scResources[scBufferShaderInputs[k][i]].empty)
-					std::wcout << "To JSON :: Buffer " << ("ABCD"[k]) << " Shader input " << i << " is empty, scResources corrupt" << std::endl;
+					std::wcout << "To JSON :: " << scBufferNames[k] << " Shader input " << i << " is empty, scResources corrupt" << std::endl;
 				else {
 					switch (scResources[scBufferShaderInputs[k][i]].resource.type) {
 						case IMAGE_TEXTURE: {
-							j[bufferKey]["inputs"][i]["type"] = "Image";
-							j[bufferKey]["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
+							section["inputs"][i]["type"] = "Image";
+							section["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
 							break;
 						}
 
-						case AUDIO_TEXTURE: { // TODO: Save media resources
-							std::wcout << "To JSON :: Buffer " << ("ABCD"[k]) << " Shader :: Incomplete :: Audio" << std::endl;
+						case AUDIO_TEXTURE: {
+							section["inputs"][i]["type"] = "Audio";
+							section["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
 							break;
 						}
 
 						case VIDEO_TEXTURE: {
-							std::wcout << "To JSON :: Buffer " << ("ABCD"[k]) << " Shader :: Incomplete :: Video" << std::endl;
+							section["inputs"][i]["type"] = "Video";
+							section["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
+							break;
+						}
+
+						case CUBEMAP_TEXTURE: {
+							section["inputs"][i]["type"] = "Cubemap";
+							cubemapPathToJSON(section["inputs"][i], scResources[scBufferShaderInputs[k][i]].resource.path, basePackPath);
+							break;
+						}
+
+						case VOLUME_TEXTURE: {
+							section["inputs"][i]["type"] = "Volume";
+							section["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
+							volumeLayoutToJSON(section["inputs"][i], scResources[scBufferShaderInputs[k][i]].resource.volume);
 							break;
 						}
 
 						case MIC_TEXTURE: {
-							std::wcout << "To JSON :: Buffer " << ("ABCD"[k]) << " Shader :: Incomplete :: Microphone" << std::endl;
+							section["inputs"][i]["type"] = "Microphone";
+							if (!scResources[scBufferShaderInputs[k][i]].resource.path.empty())
+								section["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
 							break;
 						}
 
 						case WEB_TEXTURE: {
-							std::wcout << "To JSON :: Buffer " << ("ABCD"[k]) << " Shader :: Incomplete :: Webcam" << std::endl;
+							std::wcout << "To JSON :: " << scBufferNames[k] << " Shader :: Incomplete :: Webcam" << std::endl;
 							break;
 						}
 
 						case KEYBOARD_TEXTURE: {
-							std::wcout << "To JSON :: Buffer " << ("ABCD"[i]) << " Shader :: Incomplete :: Keyboard" << std::endl;
+							section["inputs"][i]["type"] = "Keyboard";
+							if (!scResources[scBufferShaderInputs[k][i]].resource.path.empty())
+								section["inputs"][i]["path"] = std::filesystem::relative(std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scResources[scBufferShaderInputs[k][i]].resource.path), basePackPath).string();
 							break;
 						}
 
 						case FRAME_BUFFER: {
-							j[bufferKey]["inputs"][i]["type"] = std::string("Buffer") + "ABCD"[scResources[scBufferShaderInputs[k][i]].resource.buffer_id];
+							section["inputs"][i]["type"] = std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scBufferNames[scResources[scBufferShaderInputs[k][i]].resource.buffer_id]);
 							break;
 						}
 					}
+
+					if (section["inputs"][i].is_object())
+						inputSamplerToJSON(section["inputs"][i], scResources[scBufferShaderInputs[k][i]].resource, scBufferShaderSamplers[k][i]);
 				}
 			}
 		}
+
+		if (k < 4)
+			j[std::string("Buffer") + "ABCD"[k]] = section;
+		else {
+			section["name"] = std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(scBufferNames[k]);
+			j["Buffers"].push_back(section);
+		}
+	}
+
+	// Quality levels
+	if (scQualityLevels.size()) {
+		j["Quality"]["levels"] = nlohmann::json::array();
+
+		for (auto& level : scQualityLevels)
+			j["Quality"]["levels"].push_back(shaderDefinesToJSON(level));
+
+		// Level selected at runtime is not saved, only the declared one
+		if (scQualityInitialLevel != -1)
+			j["Quality"]["initial"] = scQualityInitialLevel;
+		j["Quality"]["governor"] = (bool) scQualityGovernorEnabled;
+	}
+
+	// Texture options
+	if (scTexturePadding)
+		j["Textures"]["padToPowerOfTwo"] = true;
+
+	if (scSimulationRate > 0.0) {
+		j["Simulation"]["rate"] = scSimulationRate;
+		j["Simulation"]["maxSteps"] = scSimulationMaxSteps;
 	}
 
 	// Save pack file
@@ -1860,124 +5129,620 @@ void repaintDesktop() {
 	//::RedrawWindow(::GetDesktopWindow(), &rect, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_ALLCHILDREN);
 }
 
-// Initialize the OpenGL scene
-void initSC() {
+// Initialize the OpenGL scene
+void initSC() {
+
+	// Buffers and inputs are not set
+	for (int i = 0; i < MaxBuffers; ++i) {
+		glBufferShaderProgramIDs[i] = -1;
+		glBufferShaderFormats[i] = DefaultBufferFormat;
+		glBufferShaderScales[i] = 1.0f;
+		glBufferShaderOutputs[i] = 1;
+		glBufferShaderStages[i] = GL_FRAGMENT_SHADER;
+		glBufferShaderVertexCounts[i] = 0;
+		glBufferShaderInstanceCounts[i] = 0;
+		glBufferShaderPrimitives[i] = 0;
+		glBufferShaderBlends[i] = 0;
+
+		for (int k = 0; k < MaxChannels; ++k)
+			scBufferShaderInputs[i][k] = -1;
+	}
+
+	for (int k = 0; k < MaxChannels; ++k)
+		scMainShaderInputs[k] = -1;
+
+	// Here be dragons
+	glViewport(0, 0, glWidth, glHeight);
+	glClearColor(0, 0, 0, 0);
+
+	glfwSetTime(0.0);
+
+	// Cool GL stuff (c)
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_BLEND);
+	glDisable(GL_ALPHA_TEST);
+
+	// Reference for stupid me: https://open.gl/drawing
+
+	// Generate Array buffer with vertices of square
+	const float squareVertices[] = {
+		 1.0f,  1.0f,
+		 1.0f, -1.0f,
+		-1.0f, -1.0f,
+		-1.0f,  1.0f
+	};
+
+	const GLuint squareIndices[] = {
+		0, 1, 2,
+		2, 3, 0
+	};
+
+	glGenVertexArrays(1, &glSquareVAO);
+	glGenBuffers(1, &glSquareVBO);
+	glGenBuffers(1, &glSquareEBO);
+
+	glBindVertexArray(glSquareVAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, glSquareVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(squareVertices), squareVertices, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glSquareEBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(squareIndices), squareIndices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*) 0);
+	glEnableVertexAttribArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	// Vertex pass draws without attributes, but core profile still requires bound vertex array
+	glGenVertexArrays(1, &glEmptyVAO);
+
+	// Vertex pass sets gl_PointSize of points
+	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	// Timer queries for each pass
+	glGenQueries(PassTimerLatency * PassTimerCount, &glPassTimerQueries[0][0]);
+	for (int i = 0; i < PassTimerLatency; ++i)
+		for (int k = 0; k < PassTimerCount; ++k)
+			glPassTimerIssued[i][k] = FALSE;
+
+	// Sampler objects for inputs with declared filter or wrap
+	{
+		const GLint minFilters[3] = { GL_NEAREST, GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR };
+		const GLint magFilters[3] = { GL_NEAREST, GL_LINEAR, GL_LINEAR };
+		const GLint wraps[3] = { GL_REPEAT, GL_CLAMP_TO_EDGE, GL_MIRRORED_REPEAT };
+
+		glGenSamplers(9, &glInputSamplers[0][0]);
+		for (int f = 0; f < 3; ++f)
+			for (int w = 0; w < 3; ++w) {
+				glSamplerParameteri(glInputSamplers[f][w], GL_TEXTURE_MIN_FILTER, minFilters[f]);
+				glSamplerParameteri(glInputSamplers[f][w], GL_TEXTURE_MAG_FILTER, magFilters[f]);
+				glSamplerParameteri(glInputSamplers[f][w], GL_TEXTURE_WRAP_S, wraps[w]);
+				glSamplerParameteri(glInputSamplers[f][w], GL_TEXTURE_WRAP_T, wraps[w]);
+				glSamplerParameteri(glInputSamplers[f][w], GL_TEXTURE_WRAP_R, wraps[w]);
+			}
+	}
+
+
+	// Create buffer and texture for all buffers (MaxBuffers in total), storage is allocated once buffer is used
+	glGenFramebuffers(MaxBuffers, glBufferShaderFramebuffers[0]);
+	glGenFramebuffers(MaxBuffers, glBufferShaderFramebuffers[1]);
+	glGenTextures(MaxBuffers, glBufferShaderFramebufferTextures[0]);
+	glGenTextures(MaxBuffers, glBufferShaderFramebufferTextures[1]);
+
+	for (int i = 0; i < MaxBuffers; ++i) {
+		// First
+		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[0][i]);
+		glViewport(0, 0, glWidth, glHeight);
+
+		glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[0][i]);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, glBufferShaderFramebufferTextures[0][i], 0);
+
+		// Second
+		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[1][i]);
+		glViewport(0, 0, glWidth, glHeight);
+
+		glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[1][i]);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, glBufferShaderFramebufferTextures[1][i], 0);
+	}
+
+	// Cube textures of cubemap passes, sampled without seams between faces
+	glGenTextures(2 * MaxBuffers, &glBufferShaderCubeTextures[0][0]);
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+	for (int f = 0; f < 2; ++f)
+		for (int i = 0; i < MaxBuffers; ++i) {
+			glBindTexture(GL_TEXTURE_CUBE_MAP, glBufferShaderCubeTextures[f][i]);
+
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+	// Additional outputs, attached by allocateBufferTextures() if buffer declares them
+	glGenTextures(2 * MaxBuffers * (MaxBufferOutputs - 1), &glBufferShaderOutputTextures[0][0][0]);
+
+	for (int f = 0; f < 2; ++f)
+		for (int i = 0; i < MaxBuffers; ++i)
+			for (int o = 0; o < MaxBufferOutputs - 1; ++o) {
+				glBindTexture(GL_TEXTURE_2D, glBufferShaderOutputTextures[f][i][o]);
+
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			}
+
+	// Target of Sound shader blocks and buffers to read blocks back, small enough to exist without Sound shader
+	glGenFramebuffers(1, &glSoundFramebuffer);
+	glGenTextures(1, &glSoundTexture);
+
+	glBindTexture(GL_TEXTURE_2D, glSoundTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, SoundBlockWidth, SoundBlockHeight, 0, GL_RG, GL_FLOAT, NULL);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, glSoundFramebuffer);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, glSoundTexture, 0);
+
+	glGenBuffers(SoundReadbacks, glSoundReadbackBuffers);
+	for (int i = 0; i < SoundReadbacks; ++i) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, glSoundReadbackBuffers[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, SoundBlockFrames * SoundOutput::Channels * sizeof(float), NULL, GL_STREAM_READ);
+		glSoundReadbackFences[i] = 0;
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
+
+// Resize the OpenGL Scene
+// values automatically calculated from [currentWindowDimensions]
+void resizeSC() {
+	glWidth = currentWindowDimensions.right - currentWindowDimensions.left;
+	glHeight = currentWindowDimensions.bottom - currentWindowDimensions.top;
+
+	glViewport(0, 0, glWidth, glHeight);
+
+	// Resize all buffer textures in use
+	for (int i = 0; i < MaxBuffers; ++i)
+		if (glBufferShaderWidths[i])
+			allocateBufferTextures(i);
+}
+
+// Finds buffers required to render Main shader
+// Walks from Main shader through live channels bound to buffers, so buffer that is bound only to
+//  dead channels (or to the other unused buffers) is not rendered at all
+void updateRenderGraph() {
+
+	// Channels switched between 2D, cube and volume inputs change sampler declarations
+	// Shader is loaded again from it's path, previous compilation may have failed with old declarations
+	if (glMainShaderPath != L"" && (getCubeChannels(scMainShaderInputs) != glMainShaderCubeChannels || getVolumeChannels(scMainShaderInputs) != glMainShaderVolumeChannels))
+		loadMainShaderFromFile(glMainShaderPath);
+
+	for (int i = 0; i < MaxBuffers; ++i)
+		if (glBufferShaderPath[i] != L"" && (getCubeChannels(scBufferShaderInputs[i]) != glBufferShaderCubeChannels[i] || getVolumeChannels(scBufferShaderInputs[i]) != glBufferShaderVolumeChannels[i]))
+			loadBufferShaderFromFile(glBufferShaderPath[i], i);
+
+	glMainShaderLiveChannels = glMainShaderProgramID != -1 ? getShaderLiveChannels(glMainShaderProgramID) : 0;
+
+	for (int i = 0; i < MaxBuffers; ++i) {
+		glBufferShaderLiveChannels[i] = glBufferShaderProgramIDs[i] != -1 ? getShaderLiveChannels(glBufferShaderProgramIDs[i]) : 0;
+		glBufferShaderShouldBeRendered[i] = FALSE;
+		glBufferShaderMipmapped[i] = FALSE;
+	}
+
+	std::vector<int> pending;
+
+	// Marks buffers bound to live channels of the pass
+	auto visit = [&pending](const int* inputs, const InputSampler* samplers, int liveChannels) {
+		for (int k = 0; k < MaxChannels; ++k) {
+			if (!(liveChannels & (1 << k)) || inputs[k] == -1 || scResources[inputs[k]].empty)
+				continue;
+
+			if (scResources[inputs[k]].resource.type != FRAME_BUFFER)
+				continue;
+
+			int bufferID = scResources[inputs[k]].resource.buffer_id;
+
+			if (samplers[k].filter == MIPMAP_FILTER)
+				glBufferShaderMipmapped[bufferID] = TRUE;
+
+			if (!glBufferShaderShouldBeRendered[bufferID]) {
+				glBufferShaderShouldBeRendered[bufferID] = TRUE;
+				pending.push_back(bufferID);
+			}
+		}
+	};
+
+	visit(scMainShaderInputs, scMainShaderSamplers, glMainShaderLiveChannels);
+
+	// Reads of storage buffers can not be tracked, passes owning storage are always rendered
+	for (int i = 0; i < MaxBuffers; ++i)
+		if (glBufferShaderStorage[i] && !glBufferShaderShouldBeRendered[i]) {
+			glBufferShaderShouldBeRendered[i] = TRUE;
+			pending.push_back(i);
+		}
+
+	while (pending.size()) {
+		int bufferID = pending.back();
+		pending.pop_back();
+
+		visit(scBufferShaderInputs[bufferID], scBufferShaderSamplers[bufferID], glBufferShaderLiveChannels[bufferID]);
+	}
+
+	glBufferRenderList.clear();
+
+	for (int i = 0; i < MaxBuffers; ++i) {
+		if (!glBufferShaderShouldBeRendered[i])
+			continue;
+
+		// Sampled buffer needs storage even if it has no shader
+		if (!glBufferShaderWidths[i])
+			allocateBufferTextures(i);
+
+		if (glBufferShaderProgramIDs[i] != -1)
+			glBufferRenderList.push_back(i);
+	}
+
+	std::wcout << "Render graph :: Main channels " << glMainShaderLiveChannels;
+	for (int i = 0; i < MaxBuffers; ++i)
+		if (glBufferShaderShouldBeRendered[i] || glBufferShaderProgramIDs[i] != -1)
+			std::wcout << ", " << scBufferNames[i] << (glBufferShaderShouldBeRendered[i] && glBufferShaderProgramIDs[i] != -1 ? (glBufferShaderMipmapped[i] ? " rendered with mipmaps" : " rendered") : " skipped");
+	std::wcout << std::endl;
+
+	scRenderGraphDirty = FALSE;
+}
+
+// Draws vertex pass of the buffer into texture of given frame parity, program is already in use
+// Cost depends on number of vertices instead of number of pixels
+void drawVertexPass(int bufferID, int written) {
+	const BlendMode& blend = BlendModes[glBufferShaderBlends[bufferID]];
+	GLuint program = glBufferShaderProgramIDs[bufferID];
+
+	// Primitives are blended over the target, so it should never hold older frames (ping-pong texture holds frame before previous)
+	glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[written][bufferID]);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glUniform1i(glGetUniformLocation(program, "iVertexCount"), glBufferShaderVertexCounts[bufferID]);
+	glUniform1i(glGetUniformLocation(program, "iInstanceCount"), glBufferShaderInstanceCounts[bufferID]);
+
+	if (blend.enabled)
+		glBlendFunc(blend.source, blend.destination);
+	else
+		glDisable(GL_BLEND);
+
+	glBindVertexArray(glEmptyVAO);
+	glDrawArraysInstanced(VertexPrimitives[glBufferShaderPrimitives[bufferID]].mode, 0, glBufferShaderVertexCounts[bufferID], glBufferShaderInstanceCounts[bufferID]);
+	glBindVertexArray(0);
+
+	// Other passes blend as set by initSC()
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// Runs compute pass of the buffer writing outputs of given frame parity
+// Outputs are bound as image units 0, 1, ... (layout(binding = N) writeonly uniform image2D), program is already in use
+void dispatchComputePass(int bufferID, int written) {
+	const BufferFormat& format = BufferFormats[glBufferShaderFormats[bufferID]];
+
+	for (int o = 0; o < glBufferShaderOutputs[bufferID]; ++o)
+		glBindImageTexture(o, getBufferTexture(written, bufferID, o), 0, GL_FALSE, 0, GL_WRITE_ONLY, format.internalFormat);
+
+	GLuint groups[3] = { (GLuint) glBufferShaderComputeGroups[bufferID][0], (GLuint) glBufferShaderComputeGroups[bufferID][1], (GLuint) glBufferShaderComputeGroups[bufferID][2] };
+
+	// Cover the whole buffer with workgroups declared by the shader
+	if (!groups[0]) {
+		const GLint* localSize = glBufferShaderLocalSizes[bufferID];
+
+		groups[0] = (glBufferShaderWidths[bufferID] + localSize[0] - 1) / localSize[0];
+		groups[1] = (glBufferShaderHeights[bufferID] + localSize[1] - 1) / localSize[1];
+		groups[2] = 1;
+	}
+
+	glDispatchCompute(groups[0], groups[1], groups[2]);
+
+	// Image stores and storage writes become visible to sampling, image loads, storage reads, mip generation and framebuffer writes of later passes
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+
+	for (int o = 0; o < glBufferShaderOutputs[bufferID]; ++o)
+		glBindImageTexture(o, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, format.internalFormat);
+}
+
+// Returns sample rate of the first live audio input of the pass, rate of Sound shader or 0 if pass has no audio inputs
+float getInputsSampleRate(const int* inputs, int liveChannels) {
+	for (int k = 0; k < MaxChannels; ++k) {
+		if (!(liveChannels & (1 << k)) || inputs[k] == -1 || scResources[inputs[k]].empty)
+			continue;
+
+		if (scResources[inputs[k]].resource.type == AUDIO_TEXTURE || scResources[inputs[k]].resource.type == MIC_TEXTURE)
+			return (float) scResources[inputs[k]].resource.sampleRate;
+	}
+
+	// Rate of Sound shader output, so visuals can follow it
+	if (glSoundShaderProgramID != -1)
+		return (float) SoundOutput::SampleRate;
+
+	return 0;
+}
+
+// Starts GPU timer of the pass in the current frame
+// Only one pass timer can be active at the same time
+void beginPassTimer(int pass) {
+	int slot = scFrames % PassTimerLatency;
+
+	glBeginQuery(GL_TIME_ELAPSED, glPassTimerQueries[slot][pass]);
+	glPassTimerIssued[slot][pass] = TRUE;
+}
+
+// Stops active GPU timer
+void endPassTimer() {
+	glEndQuery(GL_TIME_ELAPSED);
+}
+
+// Collects results of timers issued PassTimerLatency frames ago
+// Should be called before any pass of the current frame is rendered because the same queries are reused
+void collectPassTimers() {
+	int slot = scFrames % PassTimerLatency;
+
+	double frameTime = 0.0;
+	BOOL collected = FALSE;
+
+	for (int pass = 0; pass < PassTimerCount; ++pass) {
+		if (!glPassTimerIssued[slot][pass]) {
+			scPassGPUTime[pass] = 0.0;
+			continue;
+		}
+
+		glPassTimerIssued[slot][pass] = FALSE;
+
+		// Result is still not ready (GPU is far behind), drop it instead of waiting
+		GLint available = 0;
+		glGetQueryObjectiv(glPassTimerQueries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			continue;
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(glPassTimerQueries[slot][pass], GL_QUERY_RESULT, &elapsed);
+
+		double passTime = (double) elapsed / 1000000.0;
+
+		// Only the first simulation step of buffer is measured
+		if (pass != PassTimerMain)
+			passTime *= scSimulationSteps[slot];
+
+		scPassGPUTime[pass] += (passTime - scPassGPUTime[pass]) * 0.1;
+
+		frameTime += passTime;
+		collected = TRUE;
+	}
+
+	if (collected)
+		scFrameGPUTime += (frameTime - scFrameGPUTime) * 0.1;
+}
+
+// Returns number of buffer steps to render in this frame
+// Always 1 without fixed rate, else number of whole steps fitting into time passed since the previous frame
+int advanceSimulationClock() {
+	if (scSimulationRate <= 0.0)
+		return 1;
+
+	double step = 1.0 / scSimulationRate;
+	scSimulationAccumulator += max(glfwGetTime() - scTimestamp, 0.0);
+
+	int steps = (int) (scSimulationAccumulator / step);
+
+	// Steps take longer than they simulate, catching up would only make it worse
+	if (steps > scSimulationMaxSteps) {
+		steps = scSimulationMaxSteps;
+		scSimulationAccumulator = 0.0;
+	} else
+		scSimulationAccumulator -= steps * step;
+
+	return steps;
+}
+
+// Selects quality level based on measured frame time, called after each rendered frame
+// Level is lowered fast when frame does not fit into budget of scFPSMode and raised slowly when it fits with big margin
+void updateQualityGovernor() {
+	if (!scQualityGovernorEnabled || scQualityLevels.size() < 2)
+		return;
+
+	if (scQualitySettleFrames > 0) {
+		--scQualitySettleFrames;
+		return;
+	}
+
+	// GPU time is not included into CPU time unless driver blocks on swap, so take the worst of them
+	scQualityFrameTime = max(scFrameCPUTime, scFrameGPUTime);
+	double budget = 1000.0 / scFPSMode;
 
-	// Here be dragons
-	glViewport(0, 0, glWidth, glHeight);
-	glClearColor(0, 0, 0, 0);
+	if (scQualityFrameTime > budget * 0.9) {
+		++scQualityOverBudget;
+		scQualityUnderBudget = 0;
+	} else if (scQualityFrameTime < budget * 0.6) {
+		++scQualityUnderBudget;
+		scQualityOverBudget = 0;
+	} else {
+		scQualityOverBudget = 0;
+		scQualityUnderBudget = 0;
+	}
 
-	glfwSetTime(0.0);
+	// Half a second over the budget
+	if (scQualityLevel > 0 && scQualityOverBudget >= max(scFPSMode / 2, 2)) {
+		std::wcout << "Quality :: " << scQualityFrameTime << "ms over budget " << budget << "ms, level " << scQualityLevel << " -> " << (scQualityLevel - 1) << std::endl;
 
-	// Cool GL stuff (c)
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_BLEND);
-	glDisable(GL_ALPHA_TEST);
+		applyQualityLevel(scQualityLevel - 1);
 
-	// Reference for stupid me: https://open.gl/drawing
+		// Prevent oscillation between two levels
+		scQualityUpgradeBackoff = min(scQualityUpgradeBackoff * 2, 16);
 
-	// Generate Array buffer with vertices of square
-	const float squareVertices[] = {
-		 1.0f,  1.0f,
-		 1.0f, -1.0f,
-		-1.0f, -1.0f,
-		-1.0f,  1.0f
-	};
+		return;
+	}
 
-	const GLuint squareIndices[] = {
-		0, 1, 2,
-		2, 3, 0
-	};
+	// Three seconds well under the budget
+	if (scQualityLevel < (int) scQualityLevels.size() - 1 && scQualityUnderBudget >= max(scFPSMode * 3, 4) * scQualityUpgradeBackoff) {
+		std::wcout << "Quality :: " << scQualityFrameTime << "ms under budget " << budget << "ms, level " << scQualityLevel << " -> " << (scQualityLevel + 1) << std::endl;
 
-	glGenVertexArrays(1, &glSquareVAO);
-	glGenBuffers(1, &glSquareVBO);
-	glGenBuffers(1, &glSquareEBO);
+		applyQualityLevel(scQualityLevel + 1);
+	}
+}
 
-	glBindVertexArray(glSquareVAO);
+// Queues completed sound blocks to the output and renders new blocks until lookahead is full
+// Never waits for GPU: block is copied only once it's fence is signalled, the rest waits for the next frame
+void updateSoundPass() {
+	if (!scSoundSink)
+		return;
 
-	glBindBuffer(GL_ARRAY_BUFFER, glSquareVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(squareVertices), squareVertices, GL_STATIC_DRAW);
+	// WAV file is complete, leave through the same path as Exit menu item
+	if (scSoundSink->finished()) {
+		if (!scSoundWavDone) {
+			std::wcout << "Sound output :: " << scSoundSink->getPlayed() << " frames written to " << scSoundWavPath << std::endl;
+			PostMessage(trayWindow, WM_CLOSE, 0, 0);
+			scSoundWavDone = TRUE;
+		}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glSquareEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(squareIndices), squareIndices, GL_STATIC_DRAW);
+		return;
+	}
 
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*) 0);
-	glEnableVertexAttribArray(0);
+	const GLsizeiptr blockSize = SoundBlockFrames * SoundOutput::Channels * sizeof(float);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	// Collect finished readbacks, in order
+	while (scSoundReadbackCount) {
+		int slot = scSoundReadbackHead;
 
+		GLenum status = glClientWaitSync(glSoundReadbackFences[slot], 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
 
-	// Create buffer and texture for all buffers (4 in total)
-	glGenFramebuffers(4, glBufferShaderFramebuffers[0]);
-	glGenFramebuffers(4, glBufferShaderFramebuffers[1]);
-	glGenTextures(4, glBufferShaderFramebufferTextures[0]);
-	glGenTextures(4, glBufferShaderFramebufferTextures[1]);
+		glDeleteSync(glSoundReadbackFences[slot]);
+		glSoundReadbackFences[slot] = 0;
 
-	for (int i = 0; i < 4; ++i) {
-		// First
-		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[0][i]);
-		glViewport(0, 0, glWidth, glHeight);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, glSoundReadbackBuffers[slot]);
+		const float* samples = (const float*) glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, blockSize, GL_MAP_READ_BIT);
+		if (samples) {
+			scSoundRing->write(samples, SoundBlockFrames * SoundOutput::Channels);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
 
-		glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[0][i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, glWidth, glHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		scSoundReadbackHead = (scSoundReadbackHead + 1) % SoundReadbacks;
+		--scSoundReadbackCount;
+	}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// Frames queued ahead of playback, including blocks still in flight
+	size_t queued = scSoundRing->size() / SoundOutput::Channels + (size_t) scSoundReadbackCount * SoundBlockFrames;
+	int blocks = 0;
 
-		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, glBufferShaderFramebufferTextures[0][i], 0);
+	while (blocks < SoundBlocksPerFrame && scSoundReadbackCount < SoundReadbacks && queued + SoundBlockFrames <= (size_t) SoundLookaheadBlocks * SoundBlockFrames) {
+		if (!blocks) {
+			glBindFramebuffer(GL_FRAMEBUFFER, glSoundFramebuffer);
+			glViewport(0, 0, SoundBlockWidth, SoundBlockHeight);
+			glDisable(GL_BLEND);
 
-		// Second
-		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[1][i]);
-		glViewport(0, 0, glWidth, glHeight);
+			glUseProgram(glSoundShaderProgramID);
+			glUniform3f(glGetUniformLocation(glSoundShaderProgramID, "iResolution"), (float) SoundBlockWidth, (float) SoundBlockHeight, 0.0);
+			glUniform1f(glGetUniformLocation(glSoundShaderProgramID, "iSampleRate"), (float) SoundOutput::SampleRate);
+			glUniform1i(glGetUniformLocation(glSoundShaderProgramID, "iSoundWidth"), SoundBlockWidth);
 
-		glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[1][i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, glWidth, glHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+			glBindVertexArray(glSquareVAO);
+			glReadBuffer(GL_COLOR_ATTACHMENT0);
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// Sample index is int in shader, wraps after ~13 hours of playback
+		glUniform1i(glGetUniformLocation(glSoundShaderProgramID, "iSoundOffset"), scSoundBlock * SoundBlockFrames);
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, glBufferShaderFramebufferTextures[1][i], 0);
-	}
+		// Copy is asynchronous, buffer is mapped once fence is signalled
+		int slot = (scSoundReadbackHead + scSoundReadbackCount) % SoundReadbacks;
 
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, glSoundReadbackBuffers[slot]);
+		glReadPixels(0, 0, SoundBlockWidth, SoundBlockHeight, GL_RG, GL_FLOAT, 0);
+		glSoundReadbackFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
-// Resize the OpenGL Scene
-// values automatically calculated from [currentWindowDimensions]
-void resizeSC() {
-	glWidth = currentWindowDimensions.right - currentWindowDimensions.left;
-	glHeight = currentWindowDimensions.bottom - currentWindowDimensions.top;
+		++scSoundReadbackCount;
+		scSoundBlock = (scSoundBlock + 1) % (INT_MAX / SoundBlockFrames);
+		queued += SoundBlockFrames;
+		++blocks;
+	}
 
-	glViewport(0, 0, glWidth, glHeight);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-	// Resize all buffer textures
-	for (int i = 0; i < 4; ++i) {
-		// First
-		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[0][i]);
+	if (blocks) {
+		glEnable(GL_BLEND);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, glWidth, glHeight);
+	}
+}
 
-		glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[0][i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, glWidth, glHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+// Sets iChannelResolution and iChannelTime of the channel bound to resource resID (-1 if none) without binding it's texture
+// Channel that is never sampled is not bound, but shader may still read it's size or time
+void setChannelUniforms(GLuint program, const char* resolutionUniform, const char* timeUniform, int resID) {
+	GLfloat resolution[3] = { 0, 0, 0 };
+	GLfloat time = 0;
 
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	if (resID != -1 && !scResources[resID].empty) {
+		const SCResource& res = scResources[resID].resource;
 
-		// Second
-		glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[1][i]);
-		glViewport(0, 0, glWidth, glHeight);
+		switch (res.type) {
+			case IMAGE_TEXTURE:
+			case AUDIO_TEXTURE:
+			case MIC_TEXTURE:
+			case VIDEO_TEXTURE: {
+				resolution[0] = (GLfloat) res.width;
+				resolution[1] = (GLfloat) res.height;
+				time = (GLfloat) res.time;
+				break;
+			}
 
-		glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[1][i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, glWidth, glHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+			case CUBEMAP_TEXTURE:
+			case KEYBOARD_TEXTURE: {
+				resolution[0] = (GLfloat) res.width;
+				resolution[1] = (GLfloat) res.height;
+				break;
+			}
 
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+			case VOLUME_TEXTURE: {
+				resolution[0] = (GLfloat) res.width;
+				resolution[1] = (GLfloat) res.height;
+				resolution[2] = (GLfloat) res.depth;
+				break;
+			}
+
+			case FRAME_BUFFER: {
+				resolution[0] = (GLfloat) glBufferShaderWidths[res.buffer_id];
+				resolution[1] = (GLfloat) glBufferShaderHeights[res.buffer_id];
+				time = (GLfloat) scTimestamp;
+				break;
+			}
+
+			default:
+				break;
+		}
 	}
+
+	glUniform3f(glGetUniformLocation(program, resolutionUniform), resolution[0], resolution[1], resolution[2]);
+	glUniform1f(glGetUniformLocation(program, timeUniform), time);
 }
 
 // Render single frame of the Scene
@@ -2041,15 +5806,40 @@ void renderSC() {
 					continue;
 
 				switch (scResources[i].resource.type) {
-					case AUDIO_TEXTURE: { // TODO: Evaluate dynamic resources media resources
+					case IMAGE_TEXTURE: {
+						if (scResources[i].resource.image)
+							updateImageInput(scResources[i].resource);
+						break;
+					}
+
+					case AUDIO_TEXTURE:
+					case MIC_TEXTURE: {
+
+						// Upload only the newest frame of analysis thread
+						if (scResources[i].resource.audio && scResources[i].resource.audio->frames.update()) {
+							const AudioTexture::Frame& frame = scResources[i].resource.audio->frames.readSlot();
+
+							glBindTexture(GL_TEXTURE_2D, scResources[i].resource.bind);
+							glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+							glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, AudioTexture::TextureWidth, AudioTexture::TextureHeight, GL_RED, GL_UNSIGNED_BYTE, frame.texels);
+							glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+							glBindTexture(GL_TEXTURE_2D, 0);
+
+							scResources[i].resource.time = frame.time;
+							scResources[i].resource.sampleRate = frame.sampleRate;
+						}
+
 						break;
 					}
 
 					case VIDEO_TEXTURE: {
+						updateVideoInput(scResources[i].resource);
 						break;
 					}
 
-					case MIC_TEXTURE: {
+					case CUBEMAP_TEXTURE: {
+						if (scResources[i].resource.cubemap)
+							updateCubemapInput(scResources[i].resource);
 						break;
 					}
 
@@ -2058,159 +5848,316 @@ void renderSC() {
 					}
 
 					case KEYBOARD_TEXTURE: {
+						KeyboardTexture::Rect rect;
+
+						// Apply key events of the frame, upload only rectangle of changed texels
+						if (scResources[i].resource.keyboard->update(rect)) {
+							const unsigned char* texels = scResources[i].resource.keyboard->getTexels();
+
+							glBindTexture(GL_TEXTURE_2D, scResources[i].resource.bind);
+							glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+							glPixelStorei(GL_UNPACK_ROW_LENGTH, KeyboardTexture::TextureWidth);
+							glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x0, rect.y0, rect.x1 - rect.x0, rect.y1 - rect.y0, GL_RED, GL_UNSIGNED_BYTE, texels + rect.y0 * KeyboardTexture::TextureWidth + rect.x0);
+							glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+							glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+							glBindTexture(GL_TEXTURE_2D, 0);
+						}
+
 						break;
 					}
 				}
 			}
 
+			// Keep sound samples queued ahead of playback
+			if (glSoundShaderProgramID != -1)
+				updateSoundPass();
+
 			// Evaluate buffers
 			// Constant names for optimize speed:
-			const char* const iChannelResolutionUniforms[4] = {
+			// Shader declares as many channels as it uses (iChannel0..7, iChannelResolution[8], ...), missing uniforms are ignored
+			const char* const iChannelResolutionUniforms[MaxChannels] = {
 				"iChannelResolution[0]",
 				"iChannelResolution[1]",
 				"iChannelResolution[2]",
-				"iChannelResolution[3]"
+				"iChannelResolution[3]",
+				"iChannelResolution[4]",
+				"iChannelResolution[5]",
+				"iChannelResolution[6]",
+				"iChannelResolution[7]"
 			};
 
-			const char* const iChannelTimeUniforms[4] = {
+			const char* const iChannelTimeUniforms[MaxChannels] = {
 				"iChannelTime[0]",
 				"iChannelTime[1]",
 				"iChannelTime[2]",
-				"iChannelTime[3]"
+				"iChannelTime[3]",
+				"iChannelTime[4]",
+				"iChannelTime[5]",
+				"iChannelTime[6]",
+				"iChannelTime[7]"
 			};
 
-			const char* const iChannelUniforms[4] = {
+			const char* const iChannelUniforms[MaxChannels] = {
 				"iChannel0",
 				"iChannel1",
 				"iChannel2",
-				"iChannel3"
+				"iChannel3",
+				"iChannel4",
+				"iChannel5",
+				"iChannel6",
+				"iChannel7"
 			};
 
-			// Render all buffers
-			// TODO: Asynchronous buffer & main shader rendering
-			for (int i = 0; i < 4; ++i) {
+			// Read back GPU time of passes rendered few frames ago
+			collectPassTimers();
 
-				// Require both conditions to complete in order to render
-				if (glBufferShaderShouldBeRendered[i] && glBufferShaderProgramIDs[i] != -1) {
+			// Shaders or inputs changed since last frame
+			if (scRenderGraphDirty)
+				updateRenderGraph();
 
-					glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[(scBufferFrames[i] + 1) & 1][i]);
-					glViewport(0, 0, glWidth, glHeight);
-					glClearColor(0, 0, 0, 0);
-					glClear(GL_COLOR_BUFFER_BIT);
-
-					glUseProgram(glBufferShaderProgramIDs[i]);
+			// Render all buffers
+			// TODO: Asynchronous buffer & main shader rendering
+			int steps = advanceSimulationClock();
+			scSimulationSteps[scFrames % PassTimerLatency] = steps;
 
-					// Load all Basic inputs
-					glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iResolution"), (float) glWidth, (float) glHeight, 0.0);
-					glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iTime"), (float) glfwGetTime());
-					glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iTimeDelta"), (float) (glfwGetTime() - scTimestamp));
-					glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], "iFrame"), scFrames); // TODO: Should we pass actual buffer frames or global scFrames is enough?
+			for (int step = 0; step < steps; ++step) {
+				for (int i : glBufferRenderList) {
 
-					// TODO: Validate iMouse.zw data
-					if (scMouseEnabled) 
-						glUniform4f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iMouse"), (GLfloat) currentMouse.x, (GLfloat) currentMouse.y, (GLfloat) scMouse.x, (GLfloat) scMouse.y);
-					else
-						glUniform4f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iMouse"), (GLfloat) scMouse.x, (GLfloat) scMouse.y, 0, 0);
+					// Require both conditions to complete in order to render
+					if (glBufferShaderShouldBeRendered[i] && glBufferShaderProgramIDs[i] != -1) {
 
-					glUniform4f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iDate"), (GLfloat) iDate_year, (GLfloat) iDate_month, (GLfloat) iDate_day, (GLfloat) iDate_time);
+						if (!step)
+							beginPassTimer(i);
 
-					// Default value for SampleRate
-					// TODO: Should evaluate from inputs
-					glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iSampleRate"), 0);
+						glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[(scBufferFrames[i] + 1) & 1][i]);
+						glViewport(0, 0, glBufferShaderWidths[i], glBufferShaderHeights[i]);
 
-					// Bind iChannel data
-					for (int k = 0; k < 4; ++k) {
-						if (scBufferShaderInputs[i][k] == -1) {
-							glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
-							glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
-							glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 0); // GL_TEXTURE0 which is unused
-							continue;
+						// Vertex pass clears it's target right before the draw, see drawVertexPass()
+						if (glBufferShaderStages[i] != GL_VERTEX_SHADER) {
+							glClearColor(0, 0, 0, 0);
+							glClear(GL_COLOR_BUFFER_BIT);
 						}
 
-						if (scResources[scBufferShaderInputs[i][k]].empty) {
-							std::wcout << "Can not configure iChannelResolution for input " << k << " in Buffer " << i << ", input points to empty resource, scResources corrupt" << std::endl;
-							glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
-							glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
-							glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 0); // GL_TEXTURE0 which is unused
-							continue;
+						glUseProgram(glBufferShaderProgramIDs[i]);
+
+						// Load all Basic inputs
+						glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iResolution"), (float) glBufferShaderWidths[i], (float) glBufferShaderHeights[i], 0.0);
+						if (scSimulationRate > 0.0) {
+							glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iTime"), (float) scSimulationTime);
+							glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iTimeDelta"), (float) (1.0 / scSimulationRate));
+							glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], "iFrame"), scSimulationFrame);
+						} else {
+							glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iTime"), (float) glfwGetTime());
+							glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iTimeDelta"), (float) (glfwGetTime() - scTimestamp));
+							glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], "iFrame"), scFrames); // TODO: Should we pass actual buffer frames or global scFrames is enough?
 						}
 
-						switch (scResources[scBufferShaderInputs[i][k]].resource.type) {
-							case IMAGE_TEXTURE: {
+						// TODO: Validate iMouse.zw data
+						if (scMouseEnabled) 
+							glUniform4f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iMouse"), (GLfloat) currentMouse.x, (GLfloat) currentMouse.y, (GLfloat) scMouse.x, (GLfloat) scMouse.y);
+						else
+							glUniform4f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iMouse"), (GLfloat) scMouse.x, (GLfloat) scMouse.y, 0, 0);
 
-								// Bind texture
-								// TODO: Support for Sampler3D (requires shader recompile), e.t.c.
-								glActiveTexture(GL_TEXTURE5 + i * 4 + k);
-								glBindTexture(GL_TEXTURE_2D, scResources[scBufferShaderInputs[i][k]].resource.bind);
-								glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 5 + i * 4 + k);
+						glUniform4f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iDate"), (GLfloat) iDate_year, (GLfloat) iDate_month, (GLfloat) iDate_day, (GLfloat) iDate_time);
 
-								// Width & Height 
-								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) 0);
+						glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], "iSampleRate"), getInputsSampleRate(scBufferShaderInputs[i], glBufferShaderLiveChannels[i]));
 
-								// Timestamp 0
-								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+						// Bind iChannel data
+						for (int k = 0; k < MaxChannels; ++k) {
 
+							// Channel is never sampled by the shader, only it's size and time are set
+							if (!(glBufferShaderLiveChannels[i] & (1 << k))) {
+								setChannelUniforms(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k], iChannelTimeUniforms[k], scBufferShaderInputs[i][k]);
 								continue;
 							}
 
-							case AUDIO_TEXTURE: { // TODO: Compute input dimensions
+							if (scBufferShaderInputs[i][k] == -1) {
 								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
 								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+								glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 0); // GL_TEXTURE0 which is unused
 								continue;
 							}
 
-							case VIDEO_TEXTURE: {
+							if (scResources[scBufferShaderInputs[i][k]].empty) {
+								std::wcout << "Can not configure iChannelResolution for input " << k << " in Buffer " << i << ", input points to empty resource, scResources corrupt" << std::endl;
 								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
 								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+								glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 0); // GL_TEXTURE0 which is unused
 								continue;
 							}
 
-							case MIC_TEXTURE: {
-								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
-								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
-								continue;
-							}
+							bindInputSampler(1 + k, scResources[scBufferShaderInputs[i][k]].resource, scBufferShaderSamplers[i][k]);
 
-							case WEB_TEXTURE: {
-								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
-								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
-								continue;
-							}
+							switch (scResources[scBufferShaderInputs[i][k]].resource.type) {
+								case IMAGE_TEXTURE: {
 
-							case KEYBOARD_TEXTURE: {
-								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
-								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
-								continue;
-							}
+									// Bind texture
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(GL_TEXTURE_2D, scResources[scBufferShaderInputs[i][k]].resource.bind);
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
 
-							case FRAME_BUFFER: { // Buffer size always match the viewport size
-								
-								// Bind texture
-								glActiveTexture(GL_TEXTURE5 + i * 4 + k);
-								glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[scBufferFrames[scResources[scBufferShaderInputs[i][k]].resource.buffer_id] & 1][scResources[scBufferShaderInputs[i][k]].resource.buffer_id]);
-								glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 5 + i * 4 + k);
+									// Width & Height 
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) 0);
+
+									// Playback time of animated image, 0 for static
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.time);
+
+									continue;
+								}
+
+								case AUDIO_TEXTURE:
+								case MIC_TEXTURE: {
+
+									// Bind texture
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(GL_TEXTURE_2D, scResources[scBufferShaderInputs[i][k]].resource.bind);
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
+
+									// Width & Height 
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) 0);
+
+									// Playback time of the stream
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.time);
+
+									continue;
+								}
+
+								case VIDEO_TEXTURE: {
+
+									// Bind texture
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(GL_TEXTURE_2D, scResources[scBufferShaderInputs[i][k]].resource.bind);
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
 
-								// Width & Height 
-								glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) glWidth, (GLfloat) glHeight, (GLfloat) 0);
+									// Width & Height 
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) 0);
+
+									// Playback time of the shown frame
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.time);
+
+									continue;
+								}
+
+								case CUBEMAP_TEXTURE: {
+
+									// Bind texture, shader declares the channel as samplerCube, see declareChannelSamplers()
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(GL_TEXTURE_CUBE_MAP, scResources[scBufferShaderInputs[i][k]].resource.bind);
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
+
+									// Size of the face
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) 0);
+
+									// Timestamp 0
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+
+									continue;
+								}
+
+								case VOLUME_TEXTURE: {
+
+									// Bind texture, shader declares the channel as sampler3D, see declareChannelSamplers()
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(GL_TEXTURE_3D, scResources[scBufferShaderInputs[i][k]].resource.bind);
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
+
+									// Width, height & depth
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.depth);
+
+									// Timestamp 0
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+
+									continue;
+								}
+
+								case WEB_TEXTURE: {
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+									continue;
+								}
+
+								case KEYBOARD_TEXTURE: {
+
+									// Bind texture
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(GL_TEXTURE_2D, scResources[scBufferShaderInputs[i][k]].resource.bind);
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
+
+									// Width & Height 
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.width, (GLfloat) scResources[scBufferShaderInputs[i][k]].resource.height, (GLfloat) 0);
+
+									// Timestamp 0
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) 0);
+
+									continue;
+								}
+
+								case FRAME_BUFFER: {
+								
+									// Bind texture
+									glActiveTexture(GL_TEXTURE1 + k);
+									glBindTexture(getBufferTarget(scResources[scBufferShaderInputs[i][k]].resource.buffer_id), getBufferTexture(scBufferFrames[scResources[scBufferShaderInputs[i][k]].resource.buffer_id] & 1, scResources[scBufferShaderInputs[i][k]].resource.buffer_id, scResources[scBufferShaderInputs[i][k]].resource.output));
+									glUniform1i(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelUniforms[k]), 1 + k);
+
+									// Width & Height 
+									int bufferID = scResources[scBufferShaderInputs[i][k]].resource.buffer_id;
+									glUniform3f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelResolutionUniforms[k]), (GLfloat) glBufferShaderWidths[bufferID], (GLfloat) glBufferShaderHeights[bufferID], (GLfloat) 0);
 								
-								// Timestamp of previous buffer frame
-								glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) scTimestamp);
+									// Timestamp of previous buffer frame
+									glUniform1f(glGetUniformLocation(glBufferShaderProgramIDs[i], iChannelTimeUniforms[k]), (GLfloat) scTimestamp);
 
-								continue;
+									continue;
+								}
 							}
 						}
-					}
 
-					// Render Buffer i
-					glBindVertexArray(glSquareVAO);
-					glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-					glBindVertexArray(0);
-					glBindFramebuffer(GL_FRAMEBUFFER, 0);
-					glFlush();
+						int written = (scBufferFrames[i] + 1) & 1;
+
+						// Render Buffer i
+						if (glBufferShaderStages[i] == GL_COMPUTE_SHADER)
+							dispatchComputePass(i, written);
+						else if (glBufferShaderStages[i] == GL_VERTEX_SHADER)
+							drawVertexPass(i, written);
+						else {
+							glBindVertexArray(glSquareVAO);
+							glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+							glBindVertexArray(0);
+						}
+
+						glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+						// Mip chain of the written texture, only if some pass samples it with mipmap filter
+						glBufferShaderFramebufferMipmaps[written][i] = glBufferShaderMipmapped[i];
+
+						if (glBufferShaderMipmapped[i]) {
+							for (int o = 0; o < glBufferShaderOutputs[i]; ++o) {
+								glBindTexture(getBufferTarget(i), getBufferTexture(written, i, o));
+								glGenerateMipmap(getBufferTarget(i));
+								glBindTexture(getBufferTarget(i), 0);
+							}
+						}
+
+						if (!step)
+							endPassTimer();
+
+						glFlush();
+					}
 				}
+
+				if (scSimulationRate <= 0.0)
+					continue;
+
+				// Next step reads output of this step
+				for (int i : glBufferRenderList)
+					++scBufferFrames[i];
+
+				scSimulationTime += 1.0 / scSimulationRate;
+				++scSimulationFrame;
 			}
 			
 			// Render Main Shader
+			beginPassTimer(PassTimerMain);
+
 			glBindFramebuffer(GL_FRAMEBUFFER, 0);
 			glViewport(0, 0, glWidth, glHeight);
 			glClearColor(0, 0, 0, 0);
@@ -2232,12 +6179,17 @@ void renderSC() {
 
 			glUniform4f(glGetUniformLocation(glMainShaderProgramID, "iDate"), (GLfloat) iDate_year, (GLfloat) iDate_month, (GLfloat) iDate_day, (GLfloat) iDate_time);
 
-			// Default value for SampleRate
-			// TODO: Should evaluate from inputs
-			glUniform1f(glGetUniformLocation(glMainShaderProgramID, "iSampleRate"), 0);
+			glUniform1f(glGetUniformLocation(glMainShaderProgramID, "iSampleRate"), getInputsSampleRate(scMainShaderInputs, glMainShaderLiveChannels));
 
 			// Bind iChannel data
-			for (int k = 0; k < 4; ++k) {
+			for (int k = 0; k < MaxChannels; ++k) {
+
+				// Channel is never sampled by the shader, only it's size and time are set
+				if (!(glMainShaderLiveChannels & (1 << k))) {
+					setChannelUniforms(glMainShaderProgramID, iChannelResolutionUniforms[k], iChannelTimeUniforms[k], scMainShaderInputs[k]);
+					continue;
+				}
+
 				if (scMainShaderInputs[k] == -1) {
 					glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
 					glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) 0);
@@ -2253,11 +6205,12 @@ void renderSC() {
 					continue;
 				}
 
+				bindInputSampler(1 + k, scResources[scMainShaderInputs[k]].resource, scMainShaderSamplers[k]);
+
 				switch (scResources[scMainShaderInputs[k]].resource.type) {
 					case IMAGE_TEXTURE: {
 
 						// Bind texture
-						// TODO: Support for Sampler3D (requires shader recompile), e.t.c.
 						glActiveTexture(GL_TEXTURE1 + k);
 						glBindTexture(GL_TEXTURE_2D, scResources[scMainShaderInputs[k]].resource.bind);
 						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
@@ -2265,27 +6218,74 @@ void renderSC() {
 						// Width & Height 
 						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.width, (GLfloat) scResources[scMainShaderInputs[k]].resource.height, (GLfloat) 0);
 
-						// Timestamp 0
-						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) 0);
+						// Playback time of animated image, 0 for static
+						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.time);
 
 						continue;
 					}
 
-					case AUDIO_TEXTURE: { // TODO: Compute input dimensions
-						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
-						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) 0);
+					case AUDIO_TEXTURE:
+					case MIC_TEXTURE: {
+
+						// Bind texture
+						glActiveTexture(GL_TEXTURE1 + k);
+						glBindTexture(GL_TEXTURE_2D, scResources[scMainShaderInputs[k]].resource.bind);
+						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
+
+						// Width & Height 
+						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.width, (GLfloat) scResources[scMainShaderInputs[k]].resource.height, (GLfloat) 0);
+
+						// Playback time of the stream
+						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.time);
+
 						continue;
 					}
 
 					case VIDEO_TEXTURE: {
-						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
+
+						// Bind texture
+						glActiveTexture(GL_TEXTURE1 + k);
+						glBindTexture(GL_TEXTURE_2D, scResources[scMainShaderInputs[k]].resource.bind);
+						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
+
+						// Width & Height 
+						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.width, (GLfloat) scResources[scMainShaderInputs[k]].resource.height, (GLfloat) 0);
+
+						// Playback time of the shown frame
+						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.time);
+
+						continue;
+					}
+
+					case CUBEMAP_TEXTURE: {
+
+						// Bind texture, shader declares the channel as samplerCube, see declareChannelSamplers()
+						glActiveTexture(GL_TEXTURE1 + k);
+						glBindTexture(GL_TEXTURE_CUBE_MAP, scResources[scMainShaderInputs[k]].resource.bind);
+						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
+
+						// Size of the face
+						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.width, (GLfloat) scResources[scMainShaderInputs[k]].resource.height, (GLfloat) 0);
+
+						// Timestamp 0
 						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) 0);
+
 						continue;
 					}
 
-					case MIC_TEXTURE: {
-						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
+					case VOLUME_TEXTURE: {
+
+						// Bind texture, shader declares the channel as sampler3D, see declareChannelSamplers()
+						glActiveTexture(GL_TEXTURE1 + k);
+						glBindTexture(GL_TEXTURE_3D, scResources[scMainShaderInputs[k]].resource.bind);
+						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
+
+						// Width, height & depth
+						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.width, (GLfloat) scResources[scMainShaderInputs[k]].resource.height, (GLfloat) scResources[scMainShaderInputs[k]].resource.depth);
+
+						// Timestamp 0
 						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) 0);
+
 						continue;
 					}
 
@@ -2296,20 +6296,31 @@ void renderSC() {
 					}
 
 					case KEYBOARD_TEXTURE: {
-						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) 0, (GLfloat) 0, (GLfloat) 0);
+
+						// Bind texture
+						glActiveTexture(GL_TEXTURE1 + k);
+						glBindTexture(GL_TEXTURE_2D, scResources[scMainShaderInputs[k]].resource.bind);
+						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
+
+						// Width & Height 
+						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) scResources[scMainShaderInputs[k]].resource.width, (GLfloat) scResources[scMainShaderInputs[k]].resource.height, (GLfloat) 0);
+
+						// Timestamp 0
 						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) 0);
+
 						continue;
 					}
 
-					case FRAME_BUFFER: { // Buffer size always match the viewport size
+					case FRAME_BUFFER: {
 
 						// Bind texture
 						glActiveTexture(GL_TEXTURE1 + k);
-						glBindTexture(GL_TEXTURE_2D, glBufferShaderFramebufferTextures[scBufferFrames[scResources[scMainShaderInputs[k]].resource.buffer_id] & 1][scResources[scMainShaderInputs[k]].resource.buffer_id]);
+						glBindTexture(getBufferTarget(scResources[scMainShaderInputs[k]].resource.buffer_id), getBufferTexture(scBufferFrames[scResources[scMainShaderInputs[k]].resource.buffer_id] & 1, scResources[scMainShaderInputs[k]].resource.buffer_id, scResources[scMainShaderInputs[k]].resource.output));
 						glUniform1i(glGetUniformLocation(glMainShaderProgramID, iChannelUniforms[k]), 1 + k);
 
 						// Width & Height 
-						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) glWidth, (GLfloat) glHeight, (GLfloat) 0);
+						int bufferID = scResources[scMainShaderInputs[k]].resource.buffer_id;
+						glUniform3f(glGetUniformLocation(glMainShaderProgramID, iChannelResolutionUniforms[k]), (GLfloat) glBufferShaderWidths[bufferID], (GLfloat) glBufferShaderHeights[bufferID], (GLfloat) 0);
 
 						// Timestamp of previous buffer frame
 						glUniform1f(glGetUniformLocation(glMainShaderProgramID, iChannelTimeUniforms[k]), (GLfloat) scTimestamp);
@@ -2324,6 +6335,8 @@ void renderSC() {
 			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 			glBindVertexArray(0);
 
+			endPassTimer();
+
 			glFlush();
 			SwapBuffers(glDevice);
 
@@ -2331,9 +6344,9 @@ void renderSC() {
 			scTimestamp = (float) glfwGetTime();
 			++scFrames;
 
-			// Tick framebuffer frames count only if framebuffer shader was active
-			for (int i = 0; i < 4; ++i)
-				if (glBufferShaderShouldBeRendered[i] && glBufferShaderProgramIDs[i] != -1)
+			// Tick framebuffer frames count only if framebuffer shader was active, fixed rate steps tick on their own
+			if (scSimulationRate <= 0.0)
+				for (int i : glBufferRenderList)
 					++scBufferFrames[i];
 
 			// Update mouse location
@@ -2380,6 +6393,13 @@ void startRenderThread() {
 
 				// Acquire context back
 				wglMakeCurrent(glDevice, glContext);
+
+				// Time spent under the lock is not simulated, else buffers would burst through it in the next frame
+				// Paused clock is restored from scTimestamp on resume, keep it
+				if (!scPaused) {
+					scTimestamp = glfwGetTime();
+					resetSimulationClock(TRUE);
+				}
 			}
 
 			// Check if render exit was requested
@@ -2402,7 +6422,12 @@ void startRenderThread() {
 				EndPaint(glWindow, &ps);
 
 				b = std::chrono::system_clock::now();
-				auto work_time = std::chrono::duration_cast<std::chrono::milliseconds>(a - b);
+				auto work_time = std::chrono::duration_cast<std::chrono::milliseconds>(b - a);
+
+				// Feed quality governor with measured frame time
+				double frameTime = std::chrono::duration<double, std::milli>(b - a).count();
+				scFrameCPUTime += (frameTime - scFrameCPUTime) * 0.1;
+				updateQualityGovernor();
 
 				if (work_time.count() < scMinFrameTime)
 					std::this_thread::sleep_for(std::chrono::milliseconds(scMinFrameTime - work_time.count()));
@@ -2419,19 +6444,36 @@ void dispose() {
 
 	// Unlink all shaders & buffers
 	unloadMainShader();
+	unloadSoundShader();
 
-	for (int i = 0; i < 4; ++i) 
+	for (int i = 0; i < MaxBuffers; ++i) 
 		if (glBufferShaderProgramIDs[i] != -1)
-			glDeleteProgram(glBufferShaderProgramIDs[i]);
+			unloadBufferShader(i);
+
+	clearShaderVariantCache();
 
 	// Buffer i buffer & texture
-	glDeleteTextures(4, glBufferShaderFramebufferTextures[0]);
-	glDeleteTextures(4, glBufferShaderFramebufferTextures[1]);
-	glDeleteBuffers(4, glBufferShaderFramebuffers[0]);
-	glDeleteBuffers(4, glBufferShaderFramebuffers[1]);
+	glDeleteTextures(MaxBuffers, glBufferShaderFramebufferTextures[0]);
+	glDeleteTextures(MaxBuffers, glBufferShaderFramebufferTextures[1]);
+	glDeleteTextures(2 * MaxBuffers * (MaxBufferOutputs - 1), &glBufferShaderOutputTextures[0][0][0]);
+	glDeleteTextures(2 * MaxBuffers, &glBufferShaderCubeTextures[0][0]);
+
+	for (int i = 0; i < MaxBuffers; ++i)
+		setBufferStorage(i, 0);
+	glDeleteFramebuffers(MaxBuffers, glBufferShaderFramebuffers[0]);
+	glDeleteFramebuffers(MaxBuffers, glBufferShaderFramebuffers[1]);
+
+	// Sound blocks
+	glDeleteTextures(1, &glSoundTexture);
+	glDeleteFramebuffers(1, &glSoundFramebuffer);
+	glDeleteBuffers(SoundReadbacks, glSoundReadbackBuffers);
 
 	// Square buffer
+	glDeleteQueries(PassTimerLatency * PassTimerCount, &glPassTimerQueries[0][0]);
+	glDeleteSamplers(9, &glInputSamplers[0][0]);
+
 	glDeleteVertexArrays(1, &glSquareVAO);
+	glDeleteVertexArrays(1, &glEmptyVAO);
 	glDeleteBuffers(1, &glSquareVBO);
 	glDeleteBuffers(1, &glSquareEBO);
 
@@ -2814,9 +6856,10 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 							appLockRequested = TRUE;
 							renderMutex.lock();
 
-							// Restore timestamp
+							// Restore timestamp, buffers continue without catching up the pause
 							wglMakeCurrent(glDevice, glContext);
 							glfwSetTime(scTimestamp);
+							resetSimulationClock(TRUE);
 							wglMakeCurrent(NULL, NULL);
 
 							appLockRequested = FALSE;
@@ -2824,6 +6867,7 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						}
 
 						scPaused = !scPaused;
+						pauseResources(scPaused);
 					});
 					if (scPaused)
 						CheckMenuItem(trayMainMenu, menuId, MF_CHECKED);
@@ -2837,29 +6881,14 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						wglMakeCurrent(glDevice, glContext);
 
 						// Clear buffers
-						for (int i = 0; i < 4; ++i) {
-
-							// First
-							glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[0][i]);
-							glViewport(0, 0, glWidth, glHeight);
-							glClearColor(0, 0, 0, 0);
-							glClear(GL_COLOR_BUFFER_BIT);
-
-							// Second
-							glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[1][i]);
-							glViewport(0, 0, glWidth, glHeight);
-							glClearColor(0, 0, 0, 0);
-							glClear(GL_COLOR_BUFFER_BIT);
-
-							glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-							scBufferFrames[i] = 0;
-						}
+						for (int i = 0; i < MaxBuffers; ++i)
+							clearBufferTextures(i);
 
 						// Reset time & frame
 						glfwSetTime(0.0);
 						scTimestamp = 0.0;
 						scFrames = 0;
+						resetSimulationClock();
 						// for (int i = 0; i < 4; ++i)
 						// 	++scBufferFrames[i];
 
@@ -2877,21 +6906,8 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						wglMakeCurrent(glDevice, glContext);
 
 						// Bind each buffer and do glClearColor
-						for (int i = 0; i < 4; ++i) {
-							glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[0][i]);
-							glViewport(0, 0, glWidth, glHeight);
-							glClearColor(0, 0, 0, 0);
-							glClear(GL_COLOR_BUFFER_BIT);
-
-							glBindFramebuffer(GL_FRAMEBUFFER, glBufferShaderFramebuffers[1][i]);
-							glViewport(0, 0, glWidth, glHeight);
-							glClearColor(0, 0, 0, 0);
-							glClear(GL_COLOR_BUFFER_BIT);
-
-							glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-							scBufferFrames[i] = 0;
-						}
+						for (int i = 0; i < MaxBuffers; ++i)
+							clearBufferTextures(i);
 
 						wglMakeCurrent(NULL, NULL);
 						appLockRequested = FALSE;
@@ -2912,15 +6928,15 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 					});
 
 					bool inputs_exist = false;
-					for (int i = 0; i < 4; ++i) 
+					for (int i = 0; i < MaxChannels; ++i) 
 						if (scMainShaderInputs[i] != -1) {
 							inputs_exist = true;
 							break;
 						}
 
 					if (!inputs_exist)
-						for (int k = 0; k < 4; ++k)
-							for (int i = 0; i < 4; ++i) {
+						for (int k = 0; k < MaxChannels; ++k)
+							for (int i = 0; i < MaxBuffers; ++i) {
 								if (scBufferShaderInputs[i][k] != -1) {
 									inputs_exist = true;
 									break;
@@ -2958,6 +6974,7 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						reloadBufferShader(1);
 						reloadBufferShader(2);
 						reloadBufferShader(3);
+						reloadSoundShader();
 
 						wglMakeCurrent(NULL, NULL);
 						appLockRequested = FALSE;
@@ -3026,6 +7043,56 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						CheckMenuItem(trayFPSSelectMenu, menuId - 1, MF_CHECKED);
 					}
 
+					// Quality levels of the pack (if any)
+					if (scQualityLevels.size()) {
+						HMENU trayQualitySelectMenu = CreatePopupMenu();
+
+						InsertMenu(trayQualitySelectMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId, _T("Automatic"));
+						trayMenuHandlers.push_back([]() {
+							appLockRequested = TRUE;
+							renderMutex.lock();
+
+							scQualityGovernorEnabled = !scQualityGovernorEnabled;
+							scQualityOverBudget = 0;
+							scQualityUnderBudget = 0;
+							scQualityUpgradeBackoff = 1;
+
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+						if (scQualityGovernorEnabled)
+							CheckMenuItem(trayQualitySelectMenu, menuId, MF_CHECKED);
+						++menuId;
+
+						InsertMenu(trayQualitySelectMenu, 0xFFFFFFFF, MF_SEPARATOR, IDM_SEP, _T("SEP"));
+
+						for (int level = 0; level < scQualityLevels.size(); ++level) {
+
+							// Level description is it's defines
+							std::wstring levelDesc = L"Level " + std::to_wstring(level);
+							for (size_t k = 0; k < scQualityLevels[level].size(); ++k)
+								levelDesc += (k == 0 ? L" (" : L", ") + std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(scQualityLevels[level][k].first + "=" + scQualityLevels[level][k].second) + (k + 1 == scQualityLevels[level].size() ? L")" : L"");
+
+							InsertMenu(trayQualitySelectMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId, levelDesc.c_str());
+							trayMenuHandlers.push_back([level]() {
+								appLockRequested = TRUE;
+								renderMutex.lock();
+
+								// Manual selection disables governor
+								scQualityGovernorEnabled = FALSE;
+								applyQualityLevel(level);
+
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+							if (scQualityLevel == level)
+								CheckMenuItem(trayQualitySelectMenu, menuId, MF_CHECKED);
+							++menuId;
+						}
+
+						InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayQualitySelectMenu, (L"Quality (" + std::to_wstring(scQualityLevel) + (scQualityGovernorEnabled ? L", Automatic)" : L")")).c_str());
+					}
+
 					//
 					InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_SEPARATOR, IDM_SEP, _T("SEP"));
 					//
@@ -3104,8 +7171,9 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 
 							// Unload everything
 							unloadMainShader();
+							unloadSoundShader();
 
-							for (int i = 0; i < 4; ++i)
+							for (int i = 0; i < MaxBuffers; ++i)
 								if (glBufferShaderProgramIDs[i] != -1)
 									unloadBufferShader(i);
 
@@ -3117,6 +7185,8 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 
 							unloadResources();
 
+							resetQualityLevels();
+
 							wglMakeCurrent(NULL, NULL);
 							appLockRequested = FALSE;
 							renderMutex.unlock();
@@ -3325,7 +7395,7 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						renderMutex.lock();
 						wglMakeCurrent(glDevice, glContext);
 
-						for (int i = 0; i < 4; ++i)
+						for (int i = 0; i < MaxChannels; ++i)
 							unloadMainShaderResource(i);
 
 						wglMakeCurrent(NULL, NULL);
@@ -3333,15 +7403,15 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						renderMutex.unlock();
 					});
 
-					for (int i = 0; i < 4; ++i) {
+					for (int i = 0; i < MaxChannels; ++i) {
 						if (scMainShaderInputs[i] != -1)
 							break;
 
-						if (i == 3)
+						if (i == MaxChannels - 1)
 							EnableMenuItem(trayMainShaderMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
 					}
 					
-					for (int inputId = 0; inputId < 4; ++inputId) {
+					for (int inputId = 0; inputId < MaxChannels; ++inputId) {
 
 						HMENU trayMainInputTypeMenu = CreatePopupMenu();
 
@@ -3370,23 +7440,232 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 							input.type = FRAME_BUFFER;
 							input.buffer_id = 0;
 
-							loadMainShaderResource(input, inputId);
+							loadMainShaderResource(input, inputId);
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer B"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							SCResource input;
+							input.type = FRAME_BUFFER;
+							input.buffer_id = 1;
+
+							loadMainShaderResource(input, inputId);
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer C"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							SCResource input;
+							input.type = FRAME_BUFFER;
+							input.buffer_id = 2;
+
+							loadMainShaderResource(input, inputId);
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer D"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							SCResource input;
+							input.type = FRAME_BUFFER;
+							input.buffer_id = 3;
+
+							loadMainShaderResource(input, inputId);
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						// Named buffers of the pack
+						for (int bufferId = 4; bufferId < MaxBuffers && !scBufferNames[bufferId].empty(); ++bufferId) {
+							InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, (L"Buffer [" + scBufferNames[bufferId] + L"]").c_str());
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								SCResource input;
+								input.type = FRAME_BUFFER;
+								input.buffer_id = bufferId;
+
+								loadMainShaderResource(input, inputId);
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+						}
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Image"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							COMDLG_FILTERSPEC fileTypes[] = {
+								{ L"Images", L"*.png;*.apng;*.gif;*.jpg;*.jpeg;*.dds;*.ktx2" }
+							};
+
+							std::wstring imagePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							if (imagePath.size() != 0) {
+
+								SCResource input;
+								input.type = IMAGE_TEXTURE;
+								input.path = imagePath;
+
+								loadMainShaderResource(input, inputId);
+							}
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Cubemap (cross image)"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							COMDLG_FILTERSPEC fileTypes[] = {
+								{ L"Images", L"*.png;*.apng;*.gif;*.jpg;*.jpeg" }
+							};
+
+							std::wstring imagePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							if (imagePath.size() != 0) {
+
+								SCResource input;
+								input.type = CUBEMAP_TEXTURE;
+								input.path = imagePath;
+
+								loadMainShaderResource(input, inputId);
+							}
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Volume (BIN)"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							COMDLG_FILTERSPEC fileTypes[] = {
+								{ L"Volumes", L"*.bin" }
+							};
+
+							std::wstring volumePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							if (volumePath.size() != 0) {
+
+								SCResource input;
+								input.type = VOLUME_TEXTURE;
+								input.path = volumePath;
+
+								loadMainShaderResource(input, inputId);
+							}
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Audio file"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							COMDLG_FILTERSPEC fileTypes[] = {
+								{ L"WAV files", L"*.wav" }
+							};
+
+							std::wstring audioPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							if (audioPath.size() != 0) {
+
+								SCResource input;
+								input.type = AUDIO_TEXTURE;
+								input.path = audioPath;
+
+								loadMainShaderResource(input, inputId);
+							}
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Video file"));
+						trayMenuHandlers.push_back([inputId]() {
+
+							COMDLG_FILTERSPEC fileTypes[] = {
+								{ L"Video files", L"*.mp4;*.m4v;*.mov;*.wmv;*.avi;*.mkv" },
+								{ L"Any files", L"*" }
+							};
+
+							std::wstring videoPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							if (videoPath.size() != 0) {
+
+								SCResource input;
+								input.type = VIDEO_TEXTURE;
+								input.path = videoPath;
+
+								loadMainShaderResource(input, inputId);
+							}
 
 							wglMakeCurrent(NULL, NULL);
 							appLockRequested = FALSE;
 							renderMutex.unlock();
 						});
 
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer B"));
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Keyboard"));
 						trayMenuHandlers.push_back([inputId]() {
-
 							appLockRequested = TRUE;
 							renderMutex.lock();
 							wglMakeCurrent(glDevice, glContext);
 
 							SCResource input;
-							input.type = FRAME_BUFFER;
-							input.buffer_id = 1;
+							input.type = KEYBOARD_TEXTURE;
 
 							loadMainShaderResource(input, inputId);
 
@@ -3395,34 +7674,42 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 							renderMutex.unlock();
 						});
 
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer C"));
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Keyboard script"));
 						trayMenuHandlers.push_back([inputId]() {
 
+							COMDLG_FILTERSPEC fileTypes[] = {
+								{ L"Key scripts", L"*.txt" },
+								{ L"Any files", L"*" }
+							};
+
+							std::wstring scriptPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
 							appLockRequested = TRUE;
 							renderMutex.lock();
 							wglMakeCurrent(glDevice, glContext);
 
-							SCResource input;
-							input.type = FRAME_BUFFER;
-							input.buffer_id = 2;
+							if (scriptPath.size() != 0) {
 
-							loadMainShaderResource(input, inputId);
+								SCResource input;
+								input.type = KEYBOARD_TEXTURE;
+								input.path = scriptPath;
+
+								loadMainShaderResource(input, inputId);
+							}
 
 							wglMakeCurrent(NULL, NULL);
 							appLockRequested = FALSE;
 							renderMutex.unlock();
 						});
 
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer D"));
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Microphone"));
 						trayMenuHandlers.push_back([inputId]() {
-
 							appLockRequested = TRUE;
 							renderMutex.lock();
 							wglMakeCurrent(glDevice, glContext);
 
 							SCResource input;
-							input.type = FRAME_BUFFER;
-							input.buffer_id = 3;
+							input.type = MIC_TEXTURE;
 
 							loadMainShaderResource(input, inputId);
 
@@ -3431,24 +7718,24 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 							renderMutex.unlock();
 						});
 
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Image"));
+						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Microphone replay"));
 						trayMenuHandlers.push_back([inputId]() {
 
 							COMDLG_FILTERSPEC fileTypes[] = {
-								{ L"PNG images", L"*.png" }
+								{ L"WAV files", L"*.wav" }
 							};
 
-							std::wstring imagePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+							std::wstring replayPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
 
 							appLockRequested = TRUE;
 							renderMutex.lock();
 							wglMakeCurrent(glDevice, glContext);
 
-							if (imagePath.size() != 0) {
+							if (replayPath.size() != 0) {
 
 								SCResource input;
-								input.type = IMAGE_TEXTURE;
-								input.path = imagePath;
+								input.type = MIC_TEXTURE;
+								input.path = replayPath;
 
 								loadMainShaderResource(input, inputId);
 							}
@@ -3460,30 +7747,6 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 
 						// TODO: Support other input types
 						/*
-						
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Keyboard"));
-						EnableMenuItem(trayMainInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-						trayMenuHandlers.push_back([inputId]() {
-							std::wcout << "Incomplete :: Main Shader :: Set input " << inputId << " :: Keyboard" << std::endl;
-						});
-
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Microphone"));
-						EnableMenuItem(trayMainInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-						trayMenuHandlers.push_back([inputId]() {
-							std::wcout << "Incomplete :: Main Shader :: Set input " << inputId << " :: Nicrophone" << std::endl;
-						});
-
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Audio file"));
-						EnableMenuItem(trayMainInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-						trayMenuHandlers.push_back([inputId]() {
-							std::wcout << "Incomplete :: Main Shader :: Set input " << inputId << " :: Audio" << std::endl;
-						});
-
-						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Video file"));
-						EnableMenuItem(trayMainInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-						trayMenuHandlers.push_back([inputId]() {
-							std::wcout << "Incomplete :: Main Shader :: Set input " << inputId << " :: Video" << std::endl;
-						});
 
 						InsertMenu(trayMainInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Webcam"));
 						EnableMenuItem(trayMainInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
@@ -3507,7 +7770,11 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 						InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayMainShaderMenu, L"Main shader");
 					
 					// Create menu for each Buffer Shader
-					for (int bufferId = 0; bufferId < 4; ++bufferId) {
+					for (int bufferId = 0; bufferId < MaxBuffers; ++bufferId) {
+
+						// Named slots exist only while pack declares them
+						if (bufferId >= 4 && scBufferNames[bufferId].empty())
+							break;
 						
 						HMENU trayBufferShaderMenu = CreatePopupMenu();
 
@@ -3571,129 +7838,339 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 								L"BufferD"
 							};
 
-							std::wstring shaderPath = saveFile(ARRAYSIZE(fileTypes), fileTypes, fileNames[bufferId]);
+							std::wstring shaderPath = saveFile(ARRAYSIZE(fileTypes), fileTypes, fileNames[bufferId]);
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							if (shaderPath.size() != 0) {
+
+								// Default Buffer shader
+								std::ofstream out(shaderPath.c_str());
+								if (!out) {
+									std::wcout << "New :: Failed to create " << bufferNames[bufferId] << " Shader file :: " << shaderPath << std::endl;
+
+									MessageBox(
+										NULL,
+										(L"Failed to create " + bufferNames[bufferId] + L" Shader file " + shaderPath).c_str(),
+										L"Failed to create file",
+										MB_ICONERROR | MB_OK
+									);
+
+									wglMakeCurrent(NULL, NULL);
+									appLockRequested = FALSE;
+									renderMutex.unlock();
+									return;
+								}
+								out << defaultBufferShader;
+								out.close();
+
+								// Obviously, open this shader
+								loadBufferShaderFromFile(shaderPath, bufferId);
+							}
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+						
+						InsertMenu(trayBufferShaderMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Remove")); // TODO: Change to "Enabled" and "Paused"? because if it is paused, it is not evaluated on each frame and if it is not enabled, it is removed from pack
+						trayMenuHandlers.push_back([bufferId]() {
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							unloadBufferShader(bufferId);
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+						if (glBufferShaderPath[bufferId] == L"")
+							EnableMenuItem(trayBufferShaderMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
+
+						// Display only if at least one input is used
+						InsertMenu(trayBufferShaderMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Clear inputs"));
+						trayMenuHandlers.push_back([bufferId]() {
+
+							appLockRequested = TRUE;
+							renderMutex.lock();
+							wglMakeCurrent(glDevice, glContext);
+
+							for (int i = 0; i < MaxChannels; ++i)
+								unloadBufferShaderResource(bufferId, i);
+
+							wglMakeCurrent(NULL, NULL);
+							appLockRequested = FALSE;
+							renderMutex.unlock();
+						});
+
+						for (int i = 0; i < MaxChannels; ++i) {
+							if (scBufferShaderInputs[bufferId][i] != -1)
+								break;
+							
+							if (i == MaxChannels - 1)
+								EnableMenuItem(trayBufferShaderMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
+						}
+
+						for (int inputId = 0; inputId < MaxChannels; ++inputId) {
+
+							HMENU trayBufferInputTypeMenu = CreatePopupMenu();
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("None"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								unloadBufferShaderResource(bufferId, inputId);
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer A"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								SCResource input;
+								input.type = FRAME_BUFFER;
+								input.buffer_id = 0;
+
+								loadBufferShaderResource(input, bufferId, inputId);
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer B"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								SCResource input;
+								input.type = FRAME_BUFFER;
+								input.buffer_id = 1;
+
+								loadBufferShaderResource(input, bufferId, inputId);
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer C"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								SCResource input;
+								input.type = FRAME_BUFFER;
+								input.buffer_id = 2;
+
+								loadBufferShaderResource(input, bufferId, inputId);
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer D"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								SCResource input;
+								input.type = FRAME_BUFFER;
+								input.buffer_id = 3;
+
+								loadBufferShaderResource(input, bufferId, inputId);
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+
+							// Named buffers of the pack
+							for (int inputBufferId = 4; inputBufferId < MaxBuffers && !scBufferNames[inputBufferId].empty(); ++inputBufferId) {
+								InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, (L"Buffer [" + scBufferNames[inputBufferId] + L"]").c_str());
+								trayMenuHandlers.push_back([bufferId, inputId, inputBufferId]() {
+
+									appLockRequested = TRUE;
+									renderMutex.lock();
+									wglMakeCurrent(glDevice, glContext);
+
+									SCResource input;
+									input.type = FRAME_BUFFER;
+									input.buffer_id = inputBufferId;
+
+									loadBufferShaderResource(input, bufferId, inputId);
+
+									wglMakeCurrent(NULL, NULL);
+									appLockRequested = FALSE;
+									renderMutex.unlock();
+								});
+							}
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Image"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
+
+								COMDLG_FILTERSPEC fileTypes[] = {
+									{ L"Images", L"*.png;*.apng;*.gif;*.jpg;*.jpeg;*.dds;*.ktx2" }
+								};
+
+								std::wstring imagePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
+
+								if (imagePath.size() != 0) {
+
+									SCResource input;
+									input.type = IMAGE_TEXTURE;
+									input.path = imagePath;
+
+									loadBufferShaderResource(input, bufferId, inputId);
+								}
+
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
+
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Cubemap (cross image)"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
 
-							appLockRequested = TRUE;
-							renderMutex.lock();
-							wglMakeCurrent(glDevice, glContext);
+								COMDLG_FILTERSPEC fileTypes[] = {
+									{ L"Images", L"*.png;*.apng;*.gif;*.jpg;*.jpeg" }
+								};
 
-							if (shaderPath.size() != 0) {
+								std::wstring imagePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
 
-								// Default Buffer shader
-								std::ofstream out(shaderPath.c_str());
-								if (!out) {
-									std::wcout << "New :: Failed to create " << bufferNames[bufferId] << " Shader file :: " << shaderPath << std::endl;
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
 
-									MessageBox(
-										NULL,
-										(L"Failed to create " + bufferNames[bufferId] + L" Shader file " + shaderPath).c_str(),
-										L"Failed to create file",
-										MB_ICONERROR | MB_OK
-									);
+								if (imagePath.size() != 0) {
 
-									wglMakeCurrent(NULL, NULL);
-									appLockRequested = FALSE;
-									renderMutex.unlock();
-									return;
-								}
-								out << defaultBufferShader;
-								out.close();
+									SCResource input;
+									input.type = CUBEMAP_TEXTURE;
+									input.path = imagePath;
 
-								// Obviously, open this shader
-								loadBufferShaderFromFile(shaderPath, bufferId);
-							}
+									loadBufferShaderResource(input, bufferId, inputId);
+								}
 
-							wglMakeCurrent(NULL, NULL);
-							appLockRequested = FALSE;
-							renderMutex.unlock();
-						});
-						
-						InsertMenu(trayBufferShaderMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Remove")); // TODO: Change to "Enabled" and "Paused"? because if it is paused, it is not evaluated on each frame and if it is not enabled, it is removed from pack
-						trayMenuHandlers.push_back([bufferId]() {
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
 
-							appLockRequested = TRUE;
-							renderMutex.lock();
-							wglMakeCurrent(glDevice, glContext);
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Volume (BIN)"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
 
-							unloadBufferShader(bufferId);
+								COMDLG_FILTERSPEC fileTypes[] = {
+									{ L"Volumes", L"*.bin" }
+								};
 
-							wglMakeCurrent(NULL, NULL);
-							appLockRequested = FALSE;
-							renderMutex.unlock();
-						});
-						if (glBufferShaderPath[bufferId] == L"")
-							EnableMenuItem(trayBufferShaderMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
+								std::wstring volumePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
 
-						// Display only if at least one input is used
-						InsertMenu(trayBufferShaderMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Clear inputs"));
-						trayMenuHandlers.push_back([bufferId]() {
+								appLockRequested = TRUE;
+								renderMutex.lock();
+								wglMakeCurrent(glDevice, glContext);
 
-							appLockRequested = TRUE;
-							renderMutex.lock();
-							wglMakeCurrent(glDevice, glContext);
+								if (volumePath.size() != 0) {
 
-							for (int i = 0; i < 4; ++i)
-								unloadBufferShaderResource(bufferId, i);
+									SCResource input;
+									input.type = VOLUME_TEXTURE;
+									input.path = volumePath;
 
-							wglMakeCurrent(NULL, NULL);
-							appLockRequested = FALSE;
-							renderMutex.unlock();
-						});
+									loadBufferShaderResource(input, bufferId, inputId);
+								}
 
-						for (int i = 0; i < 4; ++i) {
-							if (scBufferShaderInputs[bufferId][i] != -1)
-								break;
-							
-							if (i == 3)
-								EnableMenuItem(trayBufferShaderMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-						}
+								wglMakeCurrent(NULL, NULL);
+								appLockRequested = FALSE;
+								renderMutex.unlock();
+							});
 
-						for (int inputId = 0; inputId < 4; ++inputId) {
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Audio file"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
 
-							HMENU trayBufferInputTypeMenu = CreatePopupMenu();
+								COMDLG_FILTERSPEC fileTypes[] = {
+									{ L"WAV files", L"*.wav" }
+								};
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("None"));
-							trayMenuHandlers.push_back([bufferId, inputId]() {
+								std::wstring audioPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
 
 								appLockRequested = TRUE;
 								renderMutex.lock();
 								wglMakeCurrent(glDevice, glContext);
 
-								unloadBufferShaderResource(bufferId, inputId);
+								if (audioPath.size() != 0) {
+
+									SCResource input;
+									input.type = AUDIO_TEXTURE;
+									input.path = audioPath;
+
+									loadBufferShaderResource(input, bufferId, inputId);
+								}
 
 								wglMakeCurrent(NULL, NULL);
 								appLockRequested = FALSE;
 								renderMutex.unlock();
 							});
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer A"));
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Video file"));
 							trayMenuHandlers.push_back([bufferId, inputId]() {
 
+								COMDLG_FILTERSPEC fileTypes[] = {
+									{ L"Video files", L"*.mp4;*.m4v;*.mov;*.wmv;*.avi;*.mkv" },
+									{ L"Any files", L"*" }
+								};
+
+								std::wstring videoPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
 								appLockRequested = TRUE;
 								renderMutex.lock();
 								wglMakeCurrent(glDevice, glContext);
 
-								SCResource input;
-								input.type = FRAME_BUFFER;
-								input.buffer_id = 0;
+								if (videoPath.size() != 0) {
 
-								loadBufferShaderResource(input, bufferId, inputId);
+									SCResource input;
+									input.type = VIDEO_TEXTURE;
+									input.path = videoPath;
+
+									loadBufferShaderResource(input, bufferId, inputId);
+								}
 
 								wglMakeCurrent(NULL, NULL);
 								appLockRequested = FALSE;
 								renderMutex.unlock();
 							});
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer B"));
-							trayMenuHandlers.push_back([bufferId, inputId]() {
 
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Keyboard"));
+							trayMenuHandlers.push_back([bufferId, inputId]() {
 								appLockRequested = TRUE;
 								renderMutex.lock();
 								wglMakeCurrent(glDevice, glContext);
 
 								SCResource input;
-								input.type = FRAME_BUFFER;
-								input.buffer_id = 1;
+								input.type = KEYBOARD_TEXTURE;
 
 								loadBufferShaderResource(input, bufferId, inputId);
 
@@ -3702,34 +8179,42 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 								renderMutex.unlock();
 							});
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer C"));
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Keyboard script"));
 							trayMenuHandlers.push_back([bufferId, inputId]() {
 
+								COMDLG_FILTERSPEC fileTypes[] = {
+									{ L"Key scripts", L"*.txt" },
+									{ L"Any files", L"*" }
+								};
+
+								std::wstring scriptPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+
 								appLockRequested = TRUE;
 								renderMutex.lock();
 								wglMakeCurrent(glDevice, glContext);
 
-								SCResource input;
-								input.type = FRAME_BUFFER;
-								input.buffer_id = 2;
+								if (scriptPath.size() != 0) {
 
-								loadBufferShaderResource(input, bufferId, inputId);
+									SCResource input;
+									input.type = KEYBOARD_TEXTURE;
+									input.path = scriptPath;
+
+									loadBufferShaderResource(input, bufferId, inputId);
+								}
 
 								wglMakeCurrent(NULL, NULL);
 								appLockRequested = FALSE;
 								renderMutex.unlock();
 							});
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Buffer D"));
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Microphone"));
 							trayMenuHandlers.push_back([bufferId, inputId]() {
-
 								appLockRequested = TRUE;
 								renderMutex.lock();
 								wglMakeCurrent(glDevice, glContext);
 
 								SCResource input;
-								input.type = FRAME_BUFFER;
-								input.buffer_id = 3;
+								input.type = MIC_TEXTURE;
 
 								loadBufferShaderResource(input, bufferId, inputId);
 
@@ -3738,24 +8223,24 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 								renderMutex.unlock();
 							});
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Image"));
+							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Microphone replay"));
 							trayMenuHandlers.push_back([bufferId, inputId]() {
 
 								COMDLG_FILTERSPEC fileTypes[] = {
-									{ L"PNG images", L"*.png" }
+									{ L"WAV files", L"*.wav" }
 								};
 
-								std::wstring imagePath = openFile(ARRAYSIZE(fileTypes), fileTypes);
+								std::wstring replayPath = openFile(ARRAYSIZE(fileTypes), fileTypes);
 
 								appLockRequested = TRUE;
 								renderMutex.lock();
 								wglMakeCurrent(glDevice, glContext);
 
-								if (imagePath.size() != 0) {
+								if (replayPath.size() != 0) {
 
 									SCResource input;
-									input.type = IMAGE_TEXTURE;
-									input.path = imagePath;
+									input.type = MIC_TEXTURE;
+									input.path = replayPath;
 
 									loadBufferShaderResource(input, bufferId, inputId);
 								}
@@ -3765,34 +8250,9 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 								renderMutex.unlock();
 							});
 
-
 							// TODO: Support other input types
 							/*
 
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Keyboard"));
-							EnableMenuItem(trayBufferInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-							trayMenuHandlers.push_back([bufferId, inputId]() {
-								std::wcout << "Incomplete :: Buffer " << bufferId << " :: Set input " << inputId << " :: Keyboard" << std::endl;
-							});
-
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Microphone"));
-							EnableMenuItem(trayBufferInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-							trayMenuHandlers.push_back([bufferId, inputId]() {
-								std::wcout << "Incomplete :: Buffer " << bufferId << " :: Set input " << inputId << " :: Microphone" << std::endl;
-							});
-
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Audio file"));
-							EnableMenuItem(trayBufferInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-							trayMenuHandlers.push_back([bufferId, inputId]() {
-								std::wcout << "Incomplete :: Buffer " << bufferId << " :: Set input " << inputId << " :: Audio" << std::endl;
-							});
-
-							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Video file"));
-							EnableMenuItem(trayBufferInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
-							trayMenuHandlers.push_back([bufferId, inputId]() {
-								std::wcout << "Incomplete :: Buffer " << bufferId << " :: Set input " << inputId << " :: Video" << std::endl;
-							});
-
 							InsertMenu(trayBufferInputTypeMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING, menuId++, _T("Webcam"));
 							EnableMenuItem(trayBufferInputTypeMenu, menuId - 1, MF_DISABLED | MF_GRAYED); // Disabled
 							trayMenuHandlers.push_back([bufferId, inputId]() {
@@ -3807,25 +8267,13 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 								InsertMenu(trayBufferShaderMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayBufferInputTypeMenu, (std::wstring(L"Input ") + std::to_wstring(inputId) + L": " + resourceToShordDescription(scResources[scBufferShaderInputs[bufferId][inputId]].resource)).c_str());
 						}
 
-						const wchar_t* menuEntry[4] = {
-							L"Buffer A Shader",
-							L"Buffer B Shader",
-							L"Buffer C Shader",
-							L"Buffer D Shader"
-						};
-
-						const wchar_t* menuEntryColon[4] = {
-							L"Buffer A Shader: ",
-							L"Buffer B Shader: ",
-							L"Buffer C Shader: ",
-							L"Buffer D Shader: "
-						};
+						std::wstring menuEntry = bufferId < 4 ? std::wstring(L"Buffer ") + L"ABCD"[bufferId] + L" Shader" : L"Buffer [" + scBufferNames[bufferId] + L"] Shader";
 
 						// Insert that menu, no
 						if (glBufferShaderPath[bufferId] != L"")
-							InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayBufferShaderMenu, (menuEntryColon[bufferId] + std::filesystem::path(glBufferShaderPath[bufferId]).filename().wstring()).c_str());
+							InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayBufferShaderMenu, (menuEntry + L": " + std::filesystem::path(glBufferShaderPath[bufferId]).filename().wstring()).c_str());
 						else
-							InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayBufferShaderMenu, menuEntry[bufferId]);
+							InsertMenu(trayMainMenu, 0xFFFFFFFF, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR) trayBufferShaderMenu, menuEntry.c_str());
 					}
 
 					//
@@ -3893,6 +8341,12 @@ LRESULT CALLBACK trayWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 			return DefWindowProc(hWnd, wmId, wParam, lParam);
 		}
 		
+		// Background keyboard input for keyboard texture
+		case WM_INPUT: {
+			KeyboardTexture::RawInputSource::handleInput(lParam);
+			return DefWindowProc(hWnd, uMsg, wParam, lParam);
+		}
+		
 		case WM_DESTROY: {
 			PostQuitMessage(0);
 			return TRUE;
@@ -4188,6 +8642,30 @@ bool cmdOptionExists(wchar_t** begin, wchar_t** end, const std::wstring& option)
 	return std::find(begin, end, option) != end;
 }
 
+// Parses value of input option: image:path or buffer (a, b, c, d or name of the pack buffer)
+// Returns 0 on success, 1 else
+BOOL parseCmdInput(const std::wstring& arg, SCResource& input) {
+	if (arg.rfind(L"image:", 0) == 0) {
+		try {
+			input.type = IMAGE_TEXTURE;
+			input.path = std::filesystem::absolute(arg.substr(6)); // XXX: hardcoded constant
+		} catch (...) {
+			return 1;
+		}
+
+		return 0;
+	}
+
+	int bufferID = arg.size() == 1 && arg[0] >= L'a' && arg[0] <= L'd' ? arg[0] - L'a' : findBufferByName(arg);
+	if (bufferID == -1)
+		return 1;
+
+	input.type = FRAME_BUFFER;
+	input.buffer_id = bufferID;
+
+	return 0;
+}
+
 
 // Entry
 int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ PWSTR pCmdLine, _In_ int nCmdShow) {
@@ -4251,37 +8729,19 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
 		// Shader properties (Override pack)
 		std::wcout << " --main             main shader location" << std::endl;
-		std::wcout << " --main:0           main shader Input 0 (type:path), exmaple: image:shrek.png" << std::endl;
-		std::wcout << " --main:1           main shader Input 1 (type:path)" << std::endl;
-		std::wcout << " --main:2           main shader Input 2 (type:path)" << std::endl;
-		std::wcout << " --main:3           main shader Input 3 (type:path)" << std::endl;
-
-		std::wcout << " --a                Buffer A shader location" << std::endl;
-		std::wcout << " --a:0              Buffer A Input 0 (type:path)" << std::endl;
-		std::wcout << " --a:1              Buffer A Input 1 (type:path)" << std::endl;
-		std::wcout << " --a:2              Buffer A Input 2 (type:path)" << std::endl;
-		std::wcout << " --a:3              Buffer A Input 3 (type:path)" << std::endl;
-
-		std::wcout << " --b                Buffer B shader location" << std::endl;
-		std::wcout << " --b:0              Buffer B Input 0 (type:path)" << std::endl;
-		std::wcout << " --b:1              Buffer B Input 1 (type:path)" << std::endl;
-		std::wcout << " --b:2              Buffer B Input 2 (type:path)" << std::endl;
-		std::wcout << " --b:3              Buffer B Input 3 (type:path)" << std::endl;
-
-		std::wcout << " --c                Buffer C shader location" << std::endl;
-		std::wcout << " --c:0              Buffer C Input 0 (type:path)" << std::endl;
-		std::wcout << " --c:1              Buffer C Input 1 (type:path)" << std::endl;
-		std::wcout << " --c:2              Buffer C Input 2 (type:path)" << std::endl;
-		std::wcout << " --c:3              Buffer C Input 3 (type:path)" << std::endl;
-
-		std::wcout << " --d                Buffer D shader location" << std::endl;
-		std::wcout << " --d:0              Buffer D Input 0 (type:path)" << std::endl;
-		std::wcout << " --d:1              Buffer D Input 1 (type:path)" << std::endl;
-		std::wcout << " --d:2              Buffer D Input 2 (type:path)" << std::endl;
-		std::wcout << " --d:3              Buffer D Input 3 (type:path)" << std::endl;
+		std::wcout << " --main:<k>         main shader Input k (0-" << MaxChannels - 1 << ", type:path), exmaple: --main:0 image:shrek.png" << std::endl;
+
+		std::wcout << " --a                Buffer A shader location, same for --b, --c, --d" << std::endl;
+		std::wcout << " --a:<k>            Buffer A Input k (0-" << MaxChannels - 1 << ", type:path), same for --b, --c, --d" << std::endl;
+		std::wcout << " --<name>           shader location of buffer named by pack (with --pack)" << std::endl;
+		std::wcout << " --<name>:<k>       Input k of buffer named by pack (with --pack)" << std::endl;
 
 		// Debug properties
 		std::wcout << " --debug            enable debug output" << std::endl;
+		std::wcout << " --analyze-audio <wav> <png>" << std::endl;
+		std::wcout << "                    write audio input texture of each frame (at --fps) into png and exit" << std::endl;
+		std::wcout << " --sound-wav <wav> <seconds>" << std::endl;
+		std::wcout << "                    write output of pack Sound shader into wav instead of playing it and exit" << std::endl;
 
 		// DEBUG:
 		// system("PAUSE");
@@ -4295,6 +8755,44 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 	// Index of argument
 	size_t argi = 0;
 
+	// Audio analysis without render context
+	if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, L"--analyze-audio")) {
+		if (argi + 2 >= __argc) {
+			std::wcout << "Expected wav and png path arguments" << std::endl;
+
+			if (useDebugConsole)
+				system("PAUSE");
+
+			exit(0);
+		}
+
+		int fps = 30;
+		if (size_t fpsi = getCmdOptionIndex(__wargv, __wargv + __argc, L"--fps"))
+			if (fpsi + 1 < __argc)
+				fps = std::clamp(_wtoi(__wargv[fpsi + 1]), 1, 240);
+
+		std::vector<unsigned char> image;
+		unsigned height = 0;
+		std::string error;
+
+		if (AudioTexture::analyzeFile(__wargv[argi + 1], fps, image, height, error)) {
+			std::wcout << "Audio analysis error: " << error.c_str() << std::endl;
+		} else {
+			std::string pngPath = std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(__wargv[argi + 2]);
+			unsigned pngError = lodepng::encode(pngPath, image, AudioTexture::TextureWidth, height, LCT_GREY, 8);
+
+			if (pngError)
+				std::wcout << "Audio analysis error: " << lodepng_error_text(pngError) << std::endl;
+			else
+				std::wcout << "Audio analysis: " << height / AudioTexture::TextureHeight << " frames written to " << __wargv[argi + 2] << std::endl;
+		}
+
+		if (useDebugConsole)
+			system("PAUSE");
+
+		return 0;
+	}
+
 	// Display ID
 	if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, L"--display")) {
 		if (argi + 1 >= __argc) {
@@ -4358,6 +8856,35 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 	// Moise input
 	scMouseEnabled = cmdOptionExists(__wargv, __wargv + __argc, L"--mouse");
 
+	// Sound shader output into file, required before pack is loaded
+	if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, L"--sound-wav")) {
+		if (argi + 2 >= __argc) {
+			std::wcout << "Expected wav path and seconds arguments" << std::endl;
+
+			if (useDebugConsole)
+				system("PAUSE");
+
+			exit(0);
+		}
+
+		try {
+			scSoundWavSeconds = std::stod(__wargv[argi + 2]);
+		} catch (...) {
+			scSoundWavSeconds = 0.0;
+		}
+
+		if (scSoundWavSeconds <= 0.0) {
+			std::wcout << "Expected positive seconds argument" << std::endl;
+
+			if (useDebugConsole)
+				system("PAUSE");
+
+			exit(0);
+		}
+
+		scSoundWavPath = std::filesystem::absolute(__wargv[argi + 1]);
+	}
+
 
 	// Create Windows & GL Context
 
@@ -4445,7 +8972,7 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 		}
 	}
 
-	for (int inputId = 0; inputId < 4; ++inputId) {
+	for (int inputId = 0; inputId < MaxChannels; ++inputId) {
 		if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, std::wstring(L"--main:") + std::to_wstring(inputId))) {
 			if (argi + 1 >= __argc) {
 				std::wcout << "Expected main shader input " << inputId << " argument" << std::endl;
@@ -4456,53 +8983,15 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 				exitApp(); exit(0);
 			}
 
-			std::wstring arg = __wargv[argi];
-			
-			if (arg.rfind(L"image:", 0) == 0) {
-				try {
-					std::wstring imagePath = std::filesystem::absolute(arg.substr(6)); // XXX: hardcoded constant
-
-					SCResource input;
-					input.type = IMAGE_TEXTURE;
-					input.path = imagePath;
-
-					loadMainShaderResource(input, inputId);
-				} catch (...) {
-					std::wcout << "Main shader input " << inputId << " image not found in " << __wargv[argi + 1] << std::endl;
-
-					if (useDebugConsole)
-						system("PAUSE");
-
-					exitApp(); exit(0);
-				}
-			} else if (arg == L"a") {
-				SCResource input;
-				input.type = FRAME_BUFFER;
-				input.buffer_id = 0;
-
-				loadMainShaderResource(input, inputId);
-			} else if (arg == L"b") {
-				SCResource input;
-				input.type = FRAME_BUFFER;
-				input.buffer_id = 1;
-
-				loadMainShaderResource(input, inputId);
-			} else if (arg == L"c") {
-				SCResource input;
-				input.type = FRAME_BUFFER;
-				input.buffer_id = 2;
-
-				loadMainShaderResource(input, inputId);
-			} else if (arg == L"d") {
-				SCResource input;
-				input.type = FRAME_BUFFER;
-				input.buffer_id = 3;
+			std::wstring arg = __wargv[argi + 1];
+			SCResource input;
 
-				loadMainShaderResource(input, inputId);
-			} else if (arg == L"none") {
+			if (arg == L"none") {
 				unloadMainShaderResource(inputId);
+			} else if (!parseCmdInput(arg, input)) {
+				loadMainShaderResource(input, inputId);
 			} else {
-				std::wcout << "Main shader input " << inputId << " has unsupported value " << arg << ", expected one of : (image:path, a, b, c, d, none)" << __wargv[argi + 1] << std::endl;
+				std::wcout << "Main shader input " << inputId << " has unsupported value " << arg << ", expected one of : (image:path, a, b, c, d, buffer name, none)" << std::endl;
 
 				if (useDebugConsole)
 					system("PAUSE");
@@ -4513,10 +9002,15 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 	}
 
 	// Buffer shaders & options
-	for (int bufferId = 0; bufferId < 4; ++bufferId) {
-		wchar_t buffer_label = L"abcd"[bufferId];
+	// Buffer A / B / C / D are labeled by letter, named buffers of the pack by their name
+	for (int bufferId = 0; bufferId < MaxBuffers; ++bufferId) {
+		std::wstring buffer_label = bufferId < 4 ? std::wstring(1, L"abcd"[bufferId]) : scBufferNames[bufferId];
+
+		// Named buffer is not declared by pack
+		if (buffer_label.empty())
+			continue;
 
-		if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, std::wstring(L"--") + buffer_label)) {
+		if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, L"--" + buffer_label)) {
 			if (argi + 1 >= __argc) {
 				std::wcout << "Expected buffer " << buffer_label << " shader path argument" << std::endl;
 
@@ -4540,8 +9034,8 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 			}
 		}
 
-		for (int inputId = 0; inputId < 4; ++inputId) {
-			if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, std::wstring(L"--") + buffer_label + L":" + std::to_wstring(inputId))) {
+		for (int inputId = 0; inputId < MaxChannels; ++inputId) {
+			if (argi = getCmdOptionIndex(__wargv, __wargv + __argc, L"--" + buffer_label + L":" + std::to_wstring(inputId))) {
 				if (argi + 1 >= __argc) {
 					std::wcout << "Expected buffer " << buffer_label << " shader input " << inputId << " argument" << std::endl;
 
@@ -4551,53 +9045,15 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 					exitApp(); exit(0);
 				}
 
-				std::wstring arg = __wargv[argi];
-
-				if (arg.rfind(L"image:", 0) == 0) {
-					try {
-						std::wstring imagePath = std::filesystem::absolute(arg.substr(6)); // XXX: hardcoded constant
-
-						SCResource input;
-						input.type = IMAGE_TEXTURE;
-						input.path = imagePath;
-
-						loadBufferShaderResource(input, bufferId, inputId);
-					} catch (...) {
-						std::wcout << "Buffer " << buffer_label << " shader input " << inputId << " image not found in " << __wargv[argi + 1] << std::endl;
-
-						if (useDebugConsole)
-							system("PAUSE");
+				std::wstring arg = __wargv[argi + 1];
+				SCResource input;
 
-						exitApp();
-					}
-				} else if (arg == L"a") {
-					SCResource input;
-					input.type = FRAME_BUFFER;
-					input.buffer_id = 0;
-
-					loadMainShaderResource(input, inputId);
-				} else if (arg == L"b") {
-					SCResource input;
-					input.type = FRAME_BUFFER;
-					input.buffer_id = 1;
-
-					loadMainShaderResource(input, inputId);
-				} else if (arg == L"c") {
-					SCResource input;
-					input.type = FRAME_BUFFER;
-					input.buffer_id = 2;
-
-					loadMainShaderResource(input, inputId);
-				} else if (arg == L"d") {
-					SCResource input;
-					input.type = FRAME_BUFFER;
-					input.buffer_id = 3;
-
-					loadMainShaderResource(input, inputId);
-				} else if (arg == L"none") {
+				if (arg == L"none") {
 					unloadBufferShaderResource(bufferId, inputId);
+				} else if (!parseCmdInput(arg, input)) {
+					loadBufferShaderResource(input, bufferId, inputId);
 				} else {
-					std::wcout << "Buffer " << buffer_label << " shader input " << inputId << " has unsupported value " << arg << ", expected one of : (image:path, a, b, c, d, none)" << __wargv[argi + 1] << std::endl;
+					std::wcout << "Buffer " << buffer_label << " shader input " << inputId << " has unsupported value " << arg << ", expected one of : (image:path, a, b, c, d, buffer name, none)" << std::endl;
 
 					if (useDebugConsole)
 						system("PAUSE");
@@ -4608,7 +9064,6 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 		}
 	}
 
-
 	// Finally, start rendering if everything was ok
 	// However..
 	
@@ -2,12 +2,31 @@
 
 #include "resource.h"
 #include "WorkerWEnumerator.h"
+#include "LockFree.h"
+#include "AudioTexture.h"
+#include "VideoTexture.h"
+#include "KeyboardTexture.h"
+#include "JpegDecoder.h"
+#include "CompressedTexture.h"
+#include "BlockEncoder.h"
+#include "TextureCache.h"
+#include "ImageTexture.h"
+#include "VolumeTexture.h"
+#include "SoundOutput.h"
 #include "Strings.h"
 
 // Link OpenGL
 #pragma comment(lib, "opengl32.lib")
 #pragma comment(lib, "glu32.lib")
 
+// Link Windows Multimedia (microphone input, sound output)
+#pragma comment(lib, "winmm.lib")
+
+// Link Media Foundation (video input)
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+
 // Disable deprecation of freopen
 #pragma warning(disable : 4996)
 
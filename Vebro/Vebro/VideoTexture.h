@@ -0,0 +1,428 @@
+#pragma once
+
+// Video file input
+// Decode thread reads frames with Media Foundation source reader (converted to 32 bit BGRX), in real time and in loop,
+//  and writes them into ring of frame slots. Render thread takes the newest due frame, uploads it and returns slot back.
+// Slot memory can be provided by render thread (persistently mapped pixel buffers), then decoded frame is written right
+//  into memory GL uploads from, without extra copies on render thread.
+// Does not touch OpenGL.
+namespace VideoTexture {
+
+	// Number of frame slots, decode thread can be up to this amount of frames ahead of playback
+	const int RingSize = 4;
+
+	// Maximal amount of late frames dropped in row by decode thread, then one late frame is shown anyway
+	//  (otherwise video that can not be decoded in real time would show nothing at all)
+	const int MaxDroppedInRow = 8;
+
+	// Decoded frame ready for upload
+	struct Frame {
+
+		// Index of slot holding pixels
+		int slot = 0;
+
+		// Presentation time on the stream clock (in seconds), grows across loops
+		double time = 0.0;
+	};
+
+	/*
+	 * Video file stream
+	 * Usage: open(), optionally setSlotMemory() for each slot, start(), then acquireFrame() / releaseSlot() on render thread.
+	 */
+	class FileStream {
+
+		// Format of the decoded frames
+		int width = 0;
+		int height = 0;
+		LONG stride = 0;
+		double duration = 0.0;
+		double frameDuration = 1.0 / 30.0;
+
+		// Pixels of each slot, width * height * 4 bytes, bottom row first
+		unsigned char* slotMemory[RingSize] = {};
+		std::vector<unsigned char> ownMemory;
+
+		// Decoded frames, decode thread -> render thread
+		LockFree::SPSCRing<Frame> decoded { RingSize };
+
+		// Free slots, render thread -> decode thread
+		LockFree::SPSCRing<int> released { RingSize };
+
+		std::wstring path;
+		std::thread* thread = nullptr;
+		std::atomic<bool> running { false };
+
+		// Signals decode thread to begin (true) or to exit without decoding (false)
+		std::promise<bool> startSignal;
+		BOOL startSignalled = FALSE;
+
+		// Stream clock
+		std::atomic<long long> origin { 0 };     // steady clock (ns) matching stream time 0
+		std::atomic<long long> pausedAt { -1 };  // stream time (ns) of the pause, -1 if playing
+
+		// Amount of frames dropped by both threads
+		std::atomic<unsigned> dropped { 0 };
+
+		static long long now() {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		// Creates source reader and reads format
+		// Returns empty string on success, error description else
+		std::string openReader(IMFSourceReader** reader) {
+			IMFAttributes* attributes = nullptr;
+			MFCreateAttributes(&attributes, 1);
+
+			// Let reader convert from YUV formats produced by decoders
+			attributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE);
+
+			HRESULT hr = MFCreateSourceReaderFromURL(path.c_str(), attributes, reader);
+			attributes->Release();
+
+			if (FAILED(hr))
+				return "Failed to open video file";
+
+			(*reader)->SetStreamSelection(MF_SOURCE_READER_ALL_STREAMS, FALSE);
+			(*reader)->SetStreamSelection(MF_SOURCE_READER_FIRST_VIDEO_STREAM, TRUE);
+
+			IMFMediaType* type = nullptr;
+			MFCreateMediaType(&type);
+			type->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+			type->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_RGB32);
+
+			hr = (*reader)->SetCurrentMediaType(MF_SOURCE_READER_FIRST_VIDEO_STREAM, NULL, type);
+			type->Release();
+
+			if (FAILED(hr))
+				return "Video format is not supported";
+
+			IMFMediaType* current = nullptr;
+			if (FAILED((*reader)->GetCurrentMediaType(MF_SOURCE_READER_FIRST_VIDEO_STREAM, &current)))
+				return "Video format is not supported";
+
+			UINT32 frameWidth = 0;
+			UINT32 frameHeight = 0;
+			MFGetAttributeSize(current, MF_MT_FRAME_SIZE, &frameWidth, &frameHeight);
+
+			width = frameWidth;
+			height = frameHeight;
+
+			UINT32 defaultStride = 0;
+			if (SUCCEEDED(current->GetUINT32(MF_MT_DEFAULT_STRIDE, &defaultStride)))
+				stride = (LONG) defaultStride;
+			else
+				stride = width * 4;
+
+			UINT32 rateNumerator = 0;
+			UINT32 rateDenominator = 0;
+			if (SUCCEEDED(MFGetAttributeRatio(current, MF_MT_FRAME_RATE, &rateNumerator, &rateDenominator)) && rateNumerator && rateDenominator)
+				frameDuration = (double) rateDenominator / rateNumerator;
+
+			current->Release();
+
+			PROPVARIANT value;
+			PropVariantInit(&value);
+			if (SUCCEEDED((*reader)->GetPresentationAttribute(MF_SOURCE_READER_MEDIASOURCE, MF_PD_DURATION, &value)))
+				duration = value.uhVal.QuadPart * 1e-7;
+			PropVariantClear(&value);
+
+			if (width <= 0 || height <= 0)
+				return "Video has no frames";
+
+			return "";
+		}
+
+		// Copies decoded sample into slot, flips rows to bottom-up order used by GL
+		void copySample(IMFSample* sample, unsigned char* pixels) {
+			IMFMediaBuffer* buffer = nullptr;
+			if (FAILED(sample->ConvertToContiguousBuffer(&buffer)))
+				return;
+
+			BYTE* data = nullptr;
+			DWORD length = 0;
+			if (SUCCEEDED(buffer->Lock(&data, NULL, &length))) {
+				size_t row = (size_t) width * 4;
+
+				// Negative stride means bottom-up frame
+				LONG step = stride;
+				BYTE* first = data;
+				if (step < 0) {
+					step = -step;
+					first = data + (size_t) step * (height - 1);
+				}
+
+				if ((size_t) step * (height - 1) + row <= length)
+					for (int y = 0; y < height; ++y) {
+						BYTE* source = stride < 0 ? first - (size_t) step * y : first + (size_t) step * y;
+						memcpy(pixels + row * (height - 1 - y), source, row);
+					}
+
+				buffer->Unlock();
+			}
+
+			buffer->Release();
+		}
+
+		void decode(IMFSourceReader* reader) {
+
+			// Stream time of the first frame of the current loop
+			double loopBase = 0.0;
+			double lastTime = 0.0;
+			int droppedInRow = 0;
+
+			while (running) {
+				int* slot = released.front();
+
+				// All slots are waiting for playback, decode thread is ahead
+				if (!slot) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					continue;
+				}
+
+				DWORD flags = 0;
+				LONGLONG timestamp = 0;
+				IMFSample* sample = nullptr;
+
+				HRESULT hr = reader->ReadSample(MF_SOURCE_READER_FIRST_VIDEO_STREAM, 0, NULL, &flags, &timestamp, &sample);
+
+				if (FAILED(hr) || (flags & MF_SOURCE_READERF_ERROR)) {
+					std::wcout << "Video decode error [" << path << ']' << std::endl;
+					if (sample)
+						sample->Release();
+					return;
+				}
+
+				if (flags & MF_SOURCE_READERF_ENDOFSTREAM) {
+					if (sample)
+						sample->Release();
+
+					// Loop from the beginning
+					PROPVARIANT position;
+					PropVariantInit(&position);
+					position.vt = VT_I8;
+					position.hVal.QuadPart = 0;
+					reader->SetCurrentPosition(GUID_NULL, position);
+					PropVariantClear(&position);
+
+					loopBase = duration > 0.0 ? loopBase + duration : lastTime + frameDuration;
+					continue;
+				}
+
+				// Stream gap or format change
+				if (!sample)
+					continue;
+
+				double time = loopBase + timestamp * 1e-7;
+				lastTime = time;
+
+				// Decoder is behind playback, do not waste upload on it
+				if (time + frameDuration < getTime() && droppedInRow < MaxDroppedInRow) {
+					sample->Release();
+					++droppedInRow;
+					++dropped;
+					continue;
+				}
+
+				droppedInRow = 0;
+
+				copySample(sample, slotMemory[*slot]);
+				sample->Release();
+
+				// Never full, amount of frames in flight is limited by slots
+				Frame* frame = decoded.writeSlot();
+				frame->slot = *slot;
+				frame->time = time;
+				decoded.push();
+
+				released.pop();
+			}
+		}
+
+		void run(std::promise<std::string> opened) {
+			CoInitializeEx(NULL, COINIT_MULTITHREADED);
+			MFStartup(MF_VERSION, MFSTARTUP_LITE);
+
+			IMFSourceReader* reader = nullptr;
+			std::string error = openReader(&reader);
+			std::future<bool> start = startSignal.get_future();
+
+			opened.set_value(error);
+
+			if (error.empty() && start.get())
+				decode(reader);
+
+			if (reader)
+				reader->Release();
+
+			MFShutdown();
+			CoUninitialize();
+		}
+
+	public:
+
+		~FileStream() {
+			stop();
+		}
+
+		// Opens the file on decode thread, stream is not started
+		// Returns 0 on success, 1 else
+		BOOL open(const std::wstring& filePath, std::string& error) {
+			stop();
+
+			path = filePath;
+			running = true;
+			startSignal = std::promise<bool>();
+			startSignalled = FALSE;
+
+			std::promise<std::string> opened;
+			std::future<std::string> result = opened.get_future();
+
+			thread = new std::thread(&FileStream::run, this, std::move(opened));
+			error = result.get();
+
+			if (!error.empty()) {
+				stop();
+				return 1;
+			}
+
+			// All slots are free
+			for (int i = 0; i < RingSize; ++i) {
+				slotMemory[i] = nullptr;
+
+				*released.writeSlot() = i;
+				released.push();
+			}
+
+			return 0;
+		}
+
+		int getWidth() const {
+			return width;
+		}
+
+		int getHeight() const {
+			return height;
+		}
+
+		double getDuration() const {
+			return duration;
+		}
+
+		unsigned getDropped() const {
+			return dropped;
+		}
+
+		// Replaces memory of the slot, must be called before start()
+		// Memory should have width * height * 4 bytes
+		void setSlotMemory(int slot, void* memory) {
+			slotMemory[slot] = (unsigned char*) memory;
+		}
+
+		// Pixels of the slot (bottom row first, BGRX)
+		const unsigned char* getSlotPixels(int slot) const {
+			return slotMemory[slot];
+		}
+
+		// Starts decoding and playback clock
+		void start() {
+			if (!thread || startSignalled)
+				return;
+
+			// Slots without memory provided by render thread
+			size_t frameSize = (size_t) width * height * 4;
+			ownMemory.assign(frameSize * RingSize, 0);
+
+			for (int i = 0; i < RingSize; ++i)
+				if (!slotMemory[i])
+					slotMemory[i] = &ownMemory[frameSize * i];
+
+			origin = now();
+			pausedAt = -1;
+
+			startSignalled = TRUE;
+			startSignal.set_value(true);
+		}
+
+		void stop() {
+			if (!thread)
+				return;
+
+			running = false;
+
+			if (!startSignalled) {
+				startSignalled = TRUE;
+				startSignal.set_value(false);
+			}
+
+			thread->join();
+			delete thread;
+			thread = nullptr;
+
+			// Drop frames of the previous run
+			while (decoded.front())
+				decoded.pop();
+			while (released.front())
+				released.pop();
+		}
+
+		// Freezes stream clock
+		void setPaused(bool value) {
+			long long paused = pausedAt;
+
+			if (value && paused < 0)
+				pausedAt = now() - origin;
+			else if (!value && paused >= 0) {
+				origin = now() - paused;
+				pausedAt = -1;
+			}
+		}
+
+		// Current stream time (in seconds)
+		double getTime() const {
+			long long paused = pausedAt;
+			if (paused >= 0)
+				return paused * 1e-9;
+
+			return (now() - origin) * 1e-9;
+		}
+
+		// Converts stream time into playback time of the file
+		double getPlaybackTime(double time) const {
+			return duration > 0.0 ? fmod(time, duration) : time;
+		}
+
+		// Takes the newest frame that is due for display, older due frames are dropped
+		// Slot of the taken frame must be returned by releaseSlot() once it is no longer used
+		// Returns false if no frame is due (playback keeps showing previous frame)
+		bool acquireFrame(Frame& frame) {
+			double time = getTime();
+
+			while (Frame* front = decoded.front()) {
+				if (front->time > time)
+					return false;
+
+				Frame* next = decoded.front(1);
+
+				// Newer frame is due too, skip this one
+				if (next && next->time <= time) {
+					releaseSlot(front->slot);
+					decoded.pop();
+					++dropped;
+					continue;
+				}
+
+				frame = *front;
+				decoded.pop();
+				return true;
+			}
+
+			return false;
+		}
+
+		// Returns slot to decode thread
+		void releaseSlot(int slot) {
+			*released.writeSlot() = slot;
+			released.push();
+		}
+	};
+}
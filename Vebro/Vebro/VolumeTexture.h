@@ -0,0 +1,157 @@
+#pragma once
+
+// Volume (3D texture) input
+// File is memory mapped and voxels are uploaded by render thread right from the mapping, there is no CPU copy.
+// Headered files use shadertoy BIN layout: "BIN\0", width, height, depth (32 bit each), channels (8 bit),
+//  layout (8 bit, always 0) and format (16 bit, 0 is 8 bit unsigned and 10 is 32 bit float), voxels follow header.
+// Raw files have no header, layout of voxels is declared by pack.
+// Voxels go x first, then y, then z, channels of voxel are interleaved.
+// Does not touch OpenGL.
+namespace VolumeTexture {
+
+	// Type of single channel
+	enum Format {
+		UNKNOWN_FORMAT,
+		UINT8,
+		UINT16,
+		FLOAT16,
+		FLOAT32
+	};
+
+	// Size of single channel (in bytes)
+	inline size_t getChannelSize(Format format) {
+		switch (format) {
+			case UINT8:   return 1;
+			case UINT16:  return 2;
+			case FLOAT16: return 2;
+			case FLOAT32: return 4;
+			default:      return 0;
+		}
+	}
+
+	// Format by name used in pack ("uint8", "uint16", "float16" or "float32", any case)
+	inline Format parseFormat(std::string name) {
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+		if (name == "uint8")
+			return UINT8;
+		if (name == "uint16")
+			return UINT16;
+		if (name == "float16")
+			return FLOAT16;
+		if (name == "float32")
+			return FLOAT32;
+
+		return UNKNOWN_FORMAT;
+	}
+
+	inline const char* formatName(Format format) {
+		switch (format) {
+			case UINT8:   return "uint8";
+			case UINT16:  return "uint16";
+			case FLOAT16: return "float16";
+			case FLOAT32: return "float32";
+			default:      return "";
+		}
+	}
+
+	// Dimensions and voxel type
+	// Empty layout (zero format) means the file has BIN header
+	struct Layout {
+		int width = 0;
+		int height = 0;
+		int depth = 0;
+		int channels = 0;
+		Format format = UNKNOWN_FORMAT;
+
+		bool empty() const {
+			return format == UNKNOWN_FORMAT;
+		}
+
+		size_t size() const {
+			return (size_t) width * height * depth * channels * getChannelSize(format);
+		}
+
+		bool operator==(const Layout& other) const {
+			return width == other.width && height == other.height && depth == other.depth && channels == other.channels && format == other.format;
+		}
+	};
+
+	// Parsed volume, voxels are valid while file stays mapped
+	struct Volume {
+		CompressedTexture::MappedFile file;
+		Layout layout;
+		const unsigned char* voxels = nullptr;
+
+		// Unmaps file once voxels are uploaded
+		void release() {
+			voxels = nullptr;
+			file.close();
+		}
+	};
+
+	const size_t HeaderSize = 20;
+
+	inline bool isBIN(const unsigned char* data, size_t size) {
+		return size >= HeaderSize && !memcmp(data, "BIN\0", 4);
+	}
+
+	inline std::string parseBIN(Volume& volume) {
+		const unsigned char* data = volume.file.data();
+
+		Layout layout;
+		layout.width = (int) CompressedTexture::readLE32(data + 4);
+		layout.height = (int) CompressedTexture::readLE32(data + 8);
+		layout.depth = (int) CompressedTexture::readLE32(data + 12);
+		layout.channels = data[16];
+
+		if (data[17] != 0)
+			return "Unsupported BIN voxel layout";
+
+		unsigned format = data[18] | (data[19] << 8);
+		if (format == 0)
+			layout.format = UINT8;
+		else if (format == 10)
+			layout.format = FLOAT32;
+		else
+			return "Unsupported BIN voxel format";
+
+		volume.layout = layout;
+		volume.voxels = data + HeaderSize;
+
+		return "";
+	}
+
+	// Maps file and locates voxels, raw layout is used if file has no BIN header
+	// Returns empty string on success, error description else
+	inline std::string load(const std::wstring& path, const Layout& raw, Volume& volume) {
+		if (volume.file.open(path))
+			return "Failed to open volume file";
+
+		std::string error;
+
+		if (raw.empty()) {
+			if (isBIN(volume.file.data(), volume.file.size()))
+				error = parseBIN(volume);
+			else
+				error = "Not a BIN file, raw volume requires size, channels and format";
+		} else {
+			volume.layout = raw;
+			volume.voxels = volume.file.data();
+		}
+
+		Layout& layout = volume.layout;
+
+		if (error.empty() && (layout.width <= 0 || layout.height <= 0 || layout.depth <= 0))
+			error = "Volume is empty";
+		else if (error.empty() && (layout.channels < 1 || layout.channels > 4))
+			error = "Volume should have 1 to 4 channels";
+		else if (error.empty() && (size_t) (volume.voxels - volume.file.data()) + layout.size() > volume.file.size())
+			error = "Volume file is truncated";
+
+		if (!error.empty())
+			volume.release();
+
+		return error;
+	}
+}
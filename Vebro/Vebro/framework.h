@@ -13,6 +13,11 @@
 #include <shellapi.h>
 #include <WinUser.h>
 #include <Shobjidl.h>
+#include <mmsystem.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#include <mferror.h>
 #include <tchar.h>
 #include <cmath>
 #include <ctime>
@@ -25,6 +30,9 @@
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
 #include <stdlib.h>
 #include <malloc.h>
 #include <memory.h>
@@ -32,6 +40,8 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <future>
 #include <filesystem>
 #include <sstream>
 #include <istream>
@@ -40,6 +50,7 @@
 #include <string>
 #include <codecvt>
 #include <functional>
+#include <emmintrin.h>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
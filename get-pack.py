@@ -59,6 +59,7 @@ If you agree with the terms of this agreement, run the program with:
 # This utility downloads shader from shadertoy and saves it as single pack in given folder
 
 import os
+import re
 import json
 import string
 import argparse
@@ -68,11 +69,13 @@ import traceback
 import urllib.parse
 import urllib.request
 
+# PNG, JPEG and GIF are loaded as is, PIL is only needed to convert other formats
 try:
 	from PIL import Image
 except:
-	print("Install PIL with 'pip install Pillow'")
-	exit(0)
+	Image = None
+
+NATIVE_IMAGE_FORMATS = ('.png', '.jpg', '.jpeg', '.gif')
 
 
 SHADER_HEADER = """#version 330 core
@@ -93,6 +96,16 @@ out vec4 out_FragColor;"""
 
 SHADER_MAIN = """void main(){vec4 color=vec4(0.0,0.,0.,1.);mainImage(color,gl_FragCoord.xy);color.rgb=clamp(color.rgb,0.,1.);color.w=1.0;out_FragColor=color;}"""
 
+# Sound pass renders block of samples, each texel is (left, right) of one sample
+SOUND_MAIN = """uniform int iSoundOffset;
+uniform int iSoundWidth;
+void main(){int s=iSoundOffset+int(gl_FragCoord.y)*iSoundWidth+int(gl_FragCoord.x);out_FragColor=vec4(mainSound(s,float(s)/iSampleRate),0.,1.);}"""
+
+# Old shaders declare vec2 mainSound(float time)
+SOUND_MAIN_LEGACY = """uniform int iSoundOffset;
+uniform int iSoundWidth;
+void main(){int s=iSoundOffset+int(gl_FragCoord.y)*iSoundWidth+int(gl_FragCoord.x);out_FragColor=vec4(mainSound(float(s)/iSampleRate),0.,1.);}"""
+
 DEBUG = True
 
 
@@ -285,6 +298,7 @@ buffera = get_obj_with_attr(shader['renderpass'], 'name', 'Buffer A') or get_obj
 bufferb = get_obj_with_attr(shader['renderpass'], 'name', 'Buffer B') or get_obj_with_attr(shader['renderpass'], 'name', 'Buf B')
 bufferc = get_obj_with_attr(shader['renderpass'], 'name', 'Buffer C') or get_obj_with_attr(shader['renderpass'], 'name', 'Buf C')
 bufferd = get_obj_with_attr(shader['renderpass'], 'name', 'Buffer D') or get_obj_with_attr(shader['renderpass'], 'name', 'Buf D')
+sound   = get_obj_with_attr(shader['renderpass'], 'type', 'sound')
 
 buffers = [ buffera, bufferb, bufferc, bufferd ]
 
@@ -354,8 +368,8 @@ if main:
 			
 			urllib.request.urlretrieve(f'https://www.shadertoy.com/{inputs[i]["path"]}', f'{output}/{inputs[i]["path"]}')
 			
-			# Convert to png
-			if not inputs[i]['path'].endswith('.png'):
+			# Convert to png if format is not supported natively
+			if not inputs[i]['path'].lower().endswith(NATIVE_IMAGE_FORMATS):
 				in_path = f'{output}/{inputs[i]["path"]}'
 				inputs[i]["path"] = inputs[i]["path"][:inputs[i]["path"].rfind('.')] + '.png'
 				out_path = f'{output}/{inputs[i]["path"]}'
@@ -363,6 +377,10 @@ if main:
 				if DEBUG:
 					print('Converting', in_path, 'to PNG')
 				
+				if Image is None:
+					print("Install PIL with 'pip install Pillow'")
+					exit(0)
+				
 				im1 = Image.open(in_path)
 				im1.save(out_path)
 				os.remove(in_path)
@@ -452,8 +470,8 @@ for buffer_name, buffer in zip([ 'BufferA', 'BufferB', 'BufferC', 'BufferD' ], b
 				
 				urllib.request.urlretrieve(f'https://www.shadertoy.com/{inputs[i]["path"]}', f'{output}/{inputs[i]["path"]}')
 			
-				# Convert to png
-				if not inputs[i]['path'].endswith('.png'):
+				# Convert to png if format is not supported natively
+				if not inputs[i]['path'].lower().endswith(NATIVE_IMAGE_FORMATS):
 					in_path = f'{output}/{inputs[i]["path"]}'
 					inputs[i]["path"] = inputs[i]["path"][:inputs[i]["path"].rfind('.')] + '.png'
 					out_path = f'{output}/{inputs[i]["path"]}'
@@ -461,6 +479,10 @@ for buffer_name, buffer in zip([ 'BufferA', 'BufferB', 'BufferC', 'BufferD' ], b
 					if DEBUG:
 						print('Converting', in_path, 'to PNG')
 					
+					if Image is None:
+						print("Install PIL with 'pip install Pillow'")
+						exit(0)
+					
 					im1 = Image.open(in_path)
 					im1.save(out_path)
 					os.remove(in_path)
@@ -486,6 +508,25 @@ for buffer_name, buffer in zip([ 'BufferA', 'BufferB', 'BufferC', 'BufferD' ], b
 		if DEBUG:
 			print(f'Missing {buffer_name} shader')
 
+# Write Sound shader, it has no inputs
+if sound:
+	sound_source = sound['code']
+	
+	with open(f'{output}/Sound.glsl', 'w') as f:
+		
+		if DEBUG:
+			print(f'Sound shader path: {output}/Sound.glsl')
+		
+		f.write(SHADER_HEADER)
+		f.write('\n')
+		f.write(common_source)
+		f.write('\n')
+		f.write(sound_source)
+		f.write('\n')
+		f.write(SOUND_MAIN if re.search(r'mainSound\s*\(\s*int\b', sound_source) else SOUND_MAIN_LEGACY)
+	
+	pack_json['Sound'] = f'{output}/Sound.glsl' if args.outside else 'Sound.glsl'
+
 # Write pack
 if args.outside:
 	with open(f'{output}.json', 'w') as f: